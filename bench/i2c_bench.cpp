@@ -0,0 +1,18 @@
+#include "utils/i2c/backend.h"
+#include "utils/i2c/transaction.h"
+#include <benchmark/benchmark.h>
+
+// Transaction building and the fake backend, without the wire time
+static void BM_I2CTransaction(benchmark::State& state)
+{
+    I2C::FakeBackend backend(0);
+    backend.add_device(0x48);
+    backend.set_register(0x48, 0, 0x1234);
+    for (auto _ : state) {
+        I2C::Transaction t;
+        t.write(0x48, { 0x00 }).read(0x48, 2);
+        backend.transfer(t);
+        benchmark::DoNotOptimize(t.read_u16(0));
+    }
+}
+BENCHMARK(BM_I2CTransaction);
@@ -0,0 +1,32 @@
+#include "control/algo/lawopti.h"
+#include <benchmark/benchmark.h>
+
+static const int init_cnt = 10;
+
+// Steady state of CompensationOptitrack::loop()
+static void BM_LawOptiTick(benchmark::State& state)
+{
+    Eigen::Vector3f posA(0.f, 300.f, 0.f), posEE(250.f, 0.f, 100.f), posHip(0.f, 0.f, 0.f), posFA(200.f, 20.f, 80.f);
+    Eigen::Quaternionf qHip(1.f, 0.f, 0.f, 0.f), qFA(0.92f, 0.38f, 0.f, 0.f);
+
+    LawOpti law;
+    law.initialization(posA, posEE, posHip, qHip, 100);
+    for (int cnt = 1; cnt <= init_cnt; ++cnt) {
+        law.initialPositions(posA, posHip, qHip, qFA, cnt, init_cnt);
+    }
+    law.rotationMatrices(qHip, qFA, init_cnt, init_cnt);
+    law.bufferingOldValues();
+
+    for (auto _ : state) {
+        law.filter_optitrackData(posA, posEE);
+        law.rotationMatrices(qHip, qFA, init_cnt + 1, init_cnt);
+        law.computeEEfromFA(posFA, 40, qFA);
+        law.controlLaw(posEE, 0.5, 300., 250., 40., 10, 0.1);
+        law.controlLawWrist(3, 0.1);
+        law.bufferingOldValues();
+        benchmark::DoNotOptimize(law.returnBetaDot_deg());
+        benchmark::DoNotOptimize(law.returnWristVel_deg());
+    }
+}
+BENCHMARK(BM_LawOptiTick);
+
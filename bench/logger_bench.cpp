@@ -0,0 +1,21 @@
+#include "utils/log/log.h"
+#include <benchmark/benchmark.h>
+
+static void BM_LoggerEnqueue(benchmark::State& state)
+{
+    Log::Logger& logger = Log::Logger::instance();
+    std::string message(static_cast<std::size_t>(state.range(0)), 'x');
+    for (auto _ : state) {
+        logger.enqueue(Log::Logger::DEBUG, message);
+    }
+}
+BENCHMARK(BM_LoggerEnqueue)->Arg(16)->Arg(128);
+
+static void BM_LoggerStream(benchmark::State& state)
+{
+    int i = 0;
+    for (auto _ : state) {
+        debug() << "tick " << i++ << " took " << 1.25 << " ms";
+    }
+}
+BENCHMARK(BM_LoggerStream);
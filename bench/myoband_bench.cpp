@@ -0,0 +1,16 @@
+#include "components/external/myoband/emg_rms.h"
+#include <benchmark/benchmark.h>
+
+static void BM_MyobandEmgRms(benchmark::State& state)
+{
+    EmgRms<8> rms;
+    std::array<int8_t, 8> sample;
+    int8_t v = 0;
+    for (auto _ : state) {
+        for (auto& s : sample) {
+            s = v++;
+        }
+        benchmark::DoNotOptimize(rms.update(sample).data());
+    }
+}
+BENCHMARK(BM_MyobandEmgRms);
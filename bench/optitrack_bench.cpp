@@ -0,0 +1,48 @@
+#include "components/external/optitrack/optitrack_listener.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+template <typename T>
+static void put(std::vector<char>& frame, T value)
+{
+    std::size_t pos = frame.size();
+    frame.resize(pos + sizeof(T));
+    memcpy(frame.data() + pos, &value, sizeof(T));
+}
+
+// NatNet 3 frame of mocap data with one marker set and n rigid bodies
+static std::vector<char> make_frame(int rigid_bodies)
+{
+    std::vector<char> frame;
+    put<int16_t>(frame, 7);
+    put<int16_t>(frame, 0);
+    put<int32_t>(frame, 1234);
+    put<int32_t>(frame, 1);
+    const char name[] = "arm";
+    frame.insert(frame.end(), name, name + sizeof(name));
+    put<int32_t>(frame, 4);
+    for (int i = 0; i < 3 * 4; ++i) {
+        put<float>(frame, 0.1f * i);
+    }
+    put<int32_t>(frame, 0);
+    put<int32_t>(frame, rigid_bodies);
+    for (int i = 0; i < rigid_bodies; ++i) {
+        put<int32_t>(frame, i);
+        for (int j = 0; j < 7; ++j) {
+            put<float>(frame, 0.5f * j);
+        }
+        put<float>(frame, 0.001f);
+        put<int16_t>(frame, 1);
+    }
+    return frame;
+}
+
+static void BM_OptiListenerUnpack(benchmark::State& state)
+{
+    std::vector<char> frame = make_frame(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        optitrack_data_t data = OptiListener::unpack(frame.data());
+        benchmark::DoNotOptimize(data.nRigidBodies);
+    }
+}
+BENCHMARK(BM_OptiListenerUnpack)->Arg(1)->Arg(4);
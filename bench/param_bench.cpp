@@ -0,0 +1,27 @@
+#include "utils/named_object.h"
+#include "utils/param.h"
+#include <benchmark/benchmark.h>
+
+namespace {
+class BenchObject : public NamedObject {
+public:
+    BenchObject()
+        : NamedObject("bench")
+    {
+    }
+    ~BenchObject() override {}
+};
+}
+
+template <typename T>
+static void BM_ParamTo(benchmark::State& state)
+{
+    BenchObject parent;
+    Param<T> param("param", BaseParam::ReadWrite, &parent, T(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(param.to());
+    }
+}
+BENCHMARK_TEMPLATE(BM_ParamTo, int);
+BENCHMARK_TEMPLATE(BM_ParamTo, double);
+BENCHMARK_TEMPLATE(BM_ParamTo, bool);
@@ -0,0 +1,49 @@
+#include "components/internal/actuators/roboclaw/message.h"
+#include <benchmark/benchmark.h>
+
+static std::vector<std::byte> payload(std::size_t size)
+{
+    std::vector<std::byte> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = std::byte { static_cast<uint8_t>(i * 37) };
+    }
+    return data;
+}
+
+static void BM_RoboClawCrc16(benchmark::State& state)
+{
+    std::vector<std::byte> packet = payload(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(RC::Message::crc16(packet));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RoboClawCrc16)->Arg(2)->Arg(10)->Arg(32);
+
+static void BM_RoboClawMessage(benchmark::State& state)
+{
+    auto answer = std::make_shared<RC::Answer::ExactMatch>(std::vector<std::byte>(1, std::byte { 0xff }));
+    std::vector<std::byte> data = payload(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        RC::Message msg(0x80, 35, answer, data);
+        benchmark::DoNotOptimize(msg.data());
+    }
+}
+BENCHMARK(BM_RoboClawMessage)->Arg(0)->Arg(4)->Arg(17);
+
+static void BM_RoboClawAnswerCrc(benchmark::State& state)
+{
+    std::vector<std::byte> command = { std::byte { 0x80 }, std::byte { 16 } };
+    std::vector<std::byte> reply = payload(5);
+    std::vector<std::byte> crc_input = command;
+    crc_input.insert(crc_input.end(), reply.begin(), reply.end());
+    uint16_t crc = RC::Message::crc16(crc_input);
+    reply.push_back(std::byte { static_cast<uint8_t>(crc >> 8) });
+    reply.push_back(std::byte { static_cast<uint8_t>(crc & 0xff) });
+
+    RC::Answer::EndsWithCRC answer(reply.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(answer.try_match(reply, command));
+    }
+}
+BENCHMARK(BM_RoboClawAnswerCrc);
@@ -0,0 +1,103 @@
+#include "components/external/ximu/ximu.h"
+#include "components/internal/actuators/state_poller.h"
+#include "components/internal/actuators/trajectory_generator.h"
+#include "components/internal/actuators/wrist_rotator.h"
+#include "utils/sim/executor.h"
+#include "utils/sim/imu.h"
+#include "utils/sim/roboclaw.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+namespace {
+// Streams the roll of the IMU to the wrist, on the 100Hz tick of the controllers
+class WristFollower : public ThreadedLoop {
+public:
+    WristFollower(XIMU& imu, Actuator& wrist)
+        : ThreadedLoop("sim follower", 0.01)
+        , _imu(imu)
+        , _wrist(wrist)
+        , _follow(true)
+    {
+    }
+
+    void park() { _follow = false; }
+    std::future<bool>& parked() { return _parked; }
+
+protected:
+    void loop(double, clock::time_point) override
+    {
+        if (!_follow) {
+            if (!_parked.valid()) {
+                _parked = _wrist.move_to_async(0., 60.);
+            }
+            return;
+        }
+
+        double q[4];
+        if (_imu.get_quat(q)) {
+            _wrist.move_to_async(2. * std::atan2(q[1], q[0]) * 180. / M_PI, 60.);
+        }
+    }
+
+private:
+    XIMU& _imu;
+    Actuator& _wrist;
+    bool _follow;
+    std::future<bool> _parked;
+};
+}
+
+// One simulated minute of the wrist following an IMU swing over the serial
+// drivers, then parking at 0°, in a single thread
+static void BM_SimulatedMinute(benchmark::State& state)
+{
+    std::size_t ticks = 0;
+    for (auto _ : state) {
+        Sim::RoboClaw roboclaw;
+        Sim::IMU sim_imu("sim imu", { 1., 0., 0. }, 30., .5);
+        XIMU imu(sim_imu.port_name());
+        WristRotator wrist;
+        wrist.set_encoder_position(0);
+        wrist.mark_calibrated();
+        WristFollower follower(imu, wrist);
+
+        // Taken off their own threads before the wrist attaches to them
+        Sim::Executor executor;
+        executor.add(roboclaw);
+        executor.add(sim_imu);
+        executor.add(imu);
+        executor.add(StatePoller::instance());
+        executor.add(follower);
+        executor.add(TrajectoryGenerator::instance());
+        wrist.attach();
+
+        ticks += executor.run_for(std::chrono::minutes(1));
+        follower.park();
+        ticks += executor.run_for(std::chrono::seconds(5));
+
+        executor.remove(TrajectoryGenerator::instance());
+        executor.remove(follower);
+        executor.remove(StatePoller::instance());
+        executor.remove(imu);
+        executor.remove(sim_imu);
+        executor.remove(roboclaw);
+        wrist.detach();
+
+        // The final position command is exact, whatever the path taken
+        std::future<bool>& parked = follower.parked();
+        if (!parked.valid() || parked.wait_for(std::chrono::seconds(0)) != std::future_status::ready || !parked.get()) {
+            state.SkipWithError("The wrist did not park");
+            break;
+        }
+        if (roboclaw.encoder(wrist.address(), wrist.chan()) != 0) {
+            state.SkipWithError("The wrist parked away from 0");
+            break;
+        }
+        if (roboclaw.bad_requests() > 0) {
+            state.SkipWithError("The RoboClaw received malformed requests");
+            break;
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(ticks));
+}
+BENCHMARK(BM_SimulatedMinute)->Unit(benchmark::kMillisecond);
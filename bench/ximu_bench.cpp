@@ -0,0 +1,22 @@
+#include "components/external/ximu/ximu.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+static void BM_XIMUDecodePacket(benchmark::State& state)
+{
+    // Encoded length of a quaternion packet
+    const int len = static_cast<int>(state.range(0));
+    unsigned char encoded[100];
+    for (int i = 0; i < len; ++i) {
+        encoded[i] = static_cast<unsigned char>((i * 53) & 0x7f);
+    }
+    encoded[len - 1] |= 0x80;
+
+    unsigned char packet[100];
+    for (auto _ : state) {
+        memcpy(packet, encoded, static_cast<std::size_t>(len));
+        benchmark::DoNotOptimize(XIMU::decode_packet(packet, len));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_XIMUDecodePacket)->Arg(11)->Arg(30);
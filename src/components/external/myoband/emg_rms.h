@@ -0,0 +1,43 @@
+#ifndef EMG_RMS_H
+#define EMG_RMS_H
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <eigen3/Eigen/Dense>
+
+/**
+ * \brief RMS of each EMG channel over the last Window samples.
+ */
+template <std::size_t Channels, std::size_t Window = 20>
+class EmgRms {
+public:
+    EmgRms()
+        : _index(0)
+    {
+        _history.setZero();
+        _rms.fill(0);
+    }
+
+    const std::array<int32_t, Channels>& update(const std::array<int8_t, Channels>& sample)
+    {
+        for (std::size_t i = 0; i < Channels; ++i) {
+            _history(static_cast<Eigen::Index>(_index), static_cast<Eigen::Index>(i)) = sample[i];
+        }
+        _index = (_index + 1) % Window;
+
+        for (std::size_t i = 0; i < Channels; ++i) {
+            _rms[i] = static_cast<int32_t>(std::round(std::sqrt(_history.col(static_cast<Eigen::Index>(i)).squaredNorm() / Window)));
+        }
+        return _rms;
+    }
+
+    const std::array<int32_t, Channels>& rms() const { return _rms; }
+
+private:
+    Eigen::Matrix<double, Window, Channels, Eigen::DontAlign> _history;
+    std::size_t _index;
+    std::array<int32_t, Channels> _rms;
+};
+
+#endif // EMG_RMS_H
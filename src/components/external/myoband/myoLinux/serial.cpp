@@ -6,8 +6,10 @@
 #include "serial.h"
 
 #include <fcntl.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <termios.h>
 #include <unistd.h>
@@ -72,17 +74,59 @@ Serial::Serial(const std::string &device, const int baudrate)
 
     iflags = TIOCM_DTR;
     ioctl(fd, TIOCMBIS, &iflags);
+
+    wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        error("Cannot create the wake-up event");
+    }
 }
 
-/// Write to serial port.
+/// Read from serial port, until size bytes are received or interrupt() is called.
 Buffer Serial::read(const std::size_t size)
 {
     Buffer buffer(size);
-    ::read(fd, buffer.data(), size);
+    std::size_t received = 0;
+    while (received < size) {
+        pollfd fds[2] = { { fd, POLLIN, 0 }, { wake_fd, POLLIN, 0 } };
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error("Poll failed");
+        }
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t count;
+            if (::read(wake_fd, &count, sizeof(count)) < 0) {
+                error("Cannot clear the wake-up event");
+            }
+            throw std::runtime_error("Read interrupted");
+        }
+
+        auto n = ::read(fd, buffer.data() + received, size - received);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            error("Read failed");
+        } else if (n == 0) {
+            throw std::runtime_error("Serial port closed");
+        }
+        received += static_cast<std::size_t>(n);
+    }
     return buffer;
 }
 
-/// Read from serial port.
+/// Makes a blocked read() throw, from any thread.
+void Serial::interrupt()
+{
+    uint64_t one = 1;
+    if (::write(wake_fd, &one, sizeof(one)) < 0) {
+        error("Cannot signal the wake-up event");
+    }
+}
+
+/// Write to serial port.
 std::size_t Serial::write(const Buffer &buffer)
 {
     auto size = ::write(fd, buffer.data(), buffer.size());
@@ -23,8 +23,11 @@ public:
     Buffer read(const std::size_t);
     std::size_t write(const Buffer &);
 
+    void interrupt();
+
 private:
     int fd;
+    int wake_fd;
 };
 
 }
@@ -7,9 +7,13 @@ Myoband::Myoband()
     , _client(nullptr)
     , _acc(Eigen::Vector3f::Zero())
     , _gyro(Eigen::Vector3f::Zero())
+    , _emg_rms_stream("emg_rms", this, Telemetry::Schema().add_array("emg", 8, Telemetry::Field::Int32), 5.)
+    , _emg_rms_f32_stream("emg_rms_f32", this, Telemetry::Schema().add_array("emg", 8, Telemetry::Field::Float32), 5., Telemetry::Normal, std::string(), Telemetry::Packed)
+    // The legacy acc payload ends with a separator
+    , _acc_stream("acc", this, Telemetry::Schema().add_array("acc", 2, Telemetry::Field::Int16).add("acc2", Telemetry::Field::Int16, { 6, false, " " }), 50., Telemetry::Low)
 {
-    _wd.set_timeout(std::chrono::seconds(10));
-    _wd.set_callback([this] { critical() << "Myoband thread timed out"; if(_thread.joinable()) _thread.detach(); });
+    // The loop thread is usually blocked reading the serial port
+    supervise(std::chrono::seconds(10), Supervisor::Restart, false, [this] { _serial.interrupt(); });
 
     _menu->set_description("Myoband");
     _menu->set_code("mb");
@@ -18,45 +22,30 @@ Myoband::Myoband()
 Myoband::~Myoband()
 {
     stop_and_join();
+    // The restart callback uses _serial
+    unsupervise();
 }
 
 bool Myoband::setup()
 {
-    info() << "Myoband publishes to " << full_name() << "/acc & " << full_name() << "/emg_rms";
-    auto emg_callback = [this](myolinux::myo::EmgSample sample) {
-        static const int window_size = 20;
-        static Eigen::MatrixXd emgs_history(window_size, sample.size());
-        static int history_idx = 0;
-        std::string payload;
+    info() << "Myoband publishes to " << full_name() << "/acc, " << full_name() << "/emg_rms & " << full_name() << "/emg_rms_f32";
+    return true;
+}
 
+void Myoband::connect()
+{
+    auto emg_callback = [this](myolinux::myo::EmgSample sample) {
         std::lock_guard lock(_mutex);
 
-        if (_emgs.size() < static_cast<int>(sample.size()))
-            _emgs.resize(sample.size());
-        if (_emgs_rms.size() < static_cast<int>(sample.size()))
-            _emgs_rms.resize(sample.size());
-
-        for (unsigned int i = 0; i < sample.size(); i++) {
-            _emgs[i] = sample[i];
-            emgs_history(history_idx++, static_cast<Eigen::Index>(i)) = sample[i];
-            _emgs_rms[i] = static_cast<int32_t>(std::round(sqrt(emgs_history.col(static_cast<Eigen::Index>(i)).squaredNorm() / window_size)));
-            if (history_idx >= window_size) {
-                history_idx = 0;
-            }
-
-            payload += std::to_string(_emgs_rms[i]) + " ";
-        }
-        payload.pop_back();
-
-        static int decimation = 0;
-        if ((++decimation % 40) == 0) {
-            _mqtt.publish(full_name() + "/emg_rms", payload);
-            decimation = 0;
-        }
+        const auto& rms = _emg_rms.update(sample);
+        _emgs.assign(sample.begin(), sample.end());
+        _emgs_rms.assign(rms.begin(), rms.end());
+        _emg_rms_stream.update(std::vector<double>(rms.begin(), rms.end()));
+        _emg_rms_f32_stream.update(std::vector<double>(rms.begin(), rms.end()));
     };
 
     auto imu_callback = [this](myolinux::myo::OrientationSample ori, myolinux::myo::AccelerometerSample acc, myolinux::myo::GyroscopeSample gyr) {
-        std::string payload;
+        std::vector<double> values(3);
         std::lock_guard lock(_mutex);
 
         _imu = Eigen::Quaternionf(ori[0] / myolinux::myo::OrientationScale,
@@ -67,14 +56,11 @@ bool Myoband::setup()
         for (unsigned int i = 0; i < 3; i++) {
             _acc[static_cast<Eigen::Index>(i)] = acc[i] / myolinux::myo::AccelerometerScale;
             _gyro[static_cast<Eigen::Index>(i)] = gyr[i] / myolinux::myo::GyroscopeScale;
-            payload += std::to_string(acc[i]) + " ";
+            values[i] = acc[i];
         }
-        _mqtt.publish(full_name() + "/acc", payload);
+        _acc_stream.update(values);
     };
 
-    _wd.ping();
-
-    _client = nullptr;
     info("MYOBAND : Trying to connect... Try to plug in/unplug the USB port");
     _client = new myolinux::myo::Client(_serial);
     _client->connect();
@@ -82,39 +68,39 @@ bool Myoband::setup()
     _client->setMode(myolinux::myo::EmgMode::SendEmg, myolinux::myo::ImuMode::SendData, myolinux::myo::ClassifierMode::Disabled);
     _client->onEmg(emg_callback);
     _client->onImu(imu_callback);
-
-    return true;
+    info("MYOBAND : Connected");
 }
 
 void Myoband::loop(double, clock::time_point)
 {
-    static bool connected = false;
-
-    if (!connected && _client->connected()) {
-        info("MYOBAND : Connected");
-        connected = true;
-    }
-
     try {
-        _wd.ping();
+        if (!_client) {
+            connect();
+        }
         _client->listen();
-    } catch (myolinux::myo::DisconnectedException& e) {
-        critical() << e.what();
-        connected = false;
+    } catch (myolinux::myo::DisconnectedException&) {
+        critical() << "Myoband disconnected, reconnecting";
         delete _client;
-        setup();
+        _client = nullptr;
+    } catch (std::exception& e) {
+        critical() << "Myoband: " << e.what() << ", reconnecting";
+        delete _client;
+        _client = nullptr;
     }
 }
 
 void Myoband::cleanup()
 {
-    if (connected()) {
-        _client->disconnect();
+    try {
+        if (connected()) {
+            _client->disconnect();
+        }
+    } catch (std::exception& e) {
+        warning() << "Myoband: " << e.what();
     }
 
-    _wd.stop_and_join();
-
     delete _client;
+    _client = nullptr;
 }
 
 bool Myoband::connected()
@@ -1,15 +1,16 @@
 #ifndef MYOBAND_H
 #define MYOBAND_H
 
+#include "emg_rms.h"
 #include "myoLinux/myoclient.h"
 #include "myoLinux/serial.h"
-#include "utils/interfaces/mqtt_user.h"
-#include "utils/watchdog.h"
+#include "utils/telemetry/telemetry_stream.h"
 #include <utils/threaded_loop.h>
+#include <atomic>
 #include <eigen3/Eigen/Dense>
 #include <vector>
 
-class Myoband : public ThreadedLoop, public MqttUser {
+class Myoband : public ThreadedLoop {
 public:
     Myoband();
     ~Myoband() override;
@@ -26,17 +27,21 @@ private:
     bool setup() override;
     void loop(double dt, clock::time_point time) override;
     void cleanup() override;
+    void connect();
 
     myolinux::Serial _serial;
     myolinux::myo::Client* _client;
 
-    Watchdog _wd;
-
     std::vector<int8_t> _emgs;
     std::vector<int32_t> _emgs_rms;
+    EmgRms<std::tuple_size<myolinux::myo::EmgSample>::value> _emg_rms;
     Eigen::Matrix<float, 3, 1, Eigen::DontAlign> _acc;
     Eigen::Matrix<float, 3, 1, Eigen::DontAlign> _gyro;
     Eigen::Quaternion<float, Eigen::DontAlign> _imu;
+
+    Telemetry::Stream _emg_rms_stream; // Rounded, as published before the telemetry streams
+    Telemetry::Stream _emg_rms_f32_stream;
+    Telemetry::Stream _acc_stream;
 };
 
 #endif // MYOBAND_H
@@ -1,5 +1,6 @@
 #include "optitrack_listener.h"
 #include "utils/log/log.h"
+#include "utils/trace/trace.h"
 #include <inttypes.h>
 #include <iostream>
 #include <stdio.h>
@@ -28,6 +29,7 @@ void OptiListener::update()
 
 optitrack_data_t OptiListener::unpack(char* pData)
 {
+    TRACE_SCOPE("OptiListener::unpack");
     // Checks for NatNet Version number. Used later in function. Packets may be different depending on NatNet version.
     int major = 3;
     int minor = 0;
@@ -119,8 +119,10 @@ public:
     void update();
     optitrack_data_t get_last_data() { return _last_data; }
 
+    // Parses a NatNet frame
+    static optitrack_data_t unpack(char* pData);
+
 private:
-    optitrack_data_t unpack(char* pData);
     optitrack_data_t _last_data;
 
     Socket _socket;
@@ -27,6 +27,7 @@
 
 #include "ximu.h"
 #include "utils/log/log.h"
+#include "utils/trace/trace.h"
 #include <fcntl.h>
 #include <math.h>
 #include <string.h>
@@ -123,6 +124,7 @@ int XIMU::set_loglevel(int i)
 
 void XIMU::loop(double, clock::time_point)
 {
+    TRACE_SCOPE("XIMU::loop");
     std::vector<std::byte> buf = _sp.read_all();
     _rx_packet_buffer.insert(_rx_packet_buffer.end(), buf.begin(), buf.end());
 
@@ -414,35 +416,40 @@ void XIMU::send_register_read_request(unsigned int register_address)
 
 void XIMU::send_packet(unsigned char* buf, unsigned int len)
 {
-    //encode packet data before sending
+    unsigned char encoded_buf[100];
+    int encoded_len = encode_packet(buf, static_cast<int>(len), encoded_buf);
+    _sp.write(reinterpret_cast<const char*>(encoded_buf), static_cast<std::size_t>(encoded_len));
+    //printf("wrote %d bytes [%d->%d]\n",res,len,encoded_len);
+}
+
+//encode packet data
+//->spreads the packet over 7-bit bytes with consecutive right shifts, the msb of the last byte frames the packet.
+int XIMU::encode_packet(const unsigned char* packet, int len, unsigned char* encoded)
+{
     int encoded_len = (int)(ceil(((float)len * 1.125f) + 0.125f));
     // CHANGED unsigned char shift_reg[encoded_len];
-    // CHANGED unsigned char encoded_buf[encoded_len];
     unsigned char shift_reg[100];
-    char encoded_buf[100];
 
     //copy data to shift_reg
     for (int i = 0; i < encoded_len; i++) {
-        if (i < (int)len) {
-            shift_reg[i] = buf[i];
+        if (i < len) {
+            shift_reg[i] = packet[i];
         } else {
             shift_reg[i] = 0;
         }
-        encoded_buf[i] = 0;
+        encoded[i] = 0;
     }
 
     //encode
     for (int i = 0; i < encoded_len; i++) {
         right_shift(shift_reg, encoded_len); //shift
-        encoded_buf[i] = shift_reg[i]; //copy byte i
+        encoded[i] = shift_reg[i]; //copy byte i
         shift_reg[i] = 0; //clear byte i
     }
 
     //set msb of framing byte
-    encoded_buf[encoded_len - 1] |= 0x80;
-
-    _sp.write(encoded_buf, encoded_len);
-    //printf("wrote %d bytes [%d->%d]\n",res,len,encoded_len);
+    encoded[encoded_len - 1] |= 0x80;
+    return encoded_len;
 }
 
 //decode packet data
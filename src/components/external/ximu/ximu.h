@@ -58,6 +58,11 @@ public:
 
     bool get_device_detected();
 
+    // Unpacks the 7-bit encoding of a received packet in place, returns the decoded length
+    static int decode_packet(unsigned char* packet, int len);
+    // Packs a packet for the wire into encoded (up to 100 bytes), returns the encoded length
+    static int encode_packet(const unsigned char* packet, int len, unsigned char* encoded);
+
     int get_register(unsigned int register_address, unsigned int* val);
     bool get_euler(double* e);
     bool get_quat(double* e);
@@ -266,7 +271,6 @@ private:
 
     void send_packet(unsigned char* buf, unsigned int len);
     void process_packet(unsigned char* packet_ptr, int len);
-    int decode_packet(unsigned char* packet, int len);
     void process_packet_error_data(unsigned char* ptr, int len);
     void process_packet_command_data(unsigned char* ptr, int len);
     void process_packet_write_register(unsigned char* ptr, int len);
@@ -283,8 +287,8 @@ private:
     void process_raw_adxl_bus_data(unsigned char* ptr, int len);
     void process_cal_adxl_bus_data(unsigned char* packet_ptr, int len);
 
-    void left_shift(unsigned char* packet, int len);
-    void right_shift(unsigned char* packet, int len);
+    static void left_shift(unsigned char* packet, int len);
+    static void right_shift(unsigned char* packet, int len);
 
     float to_float(unsigned char hi, unsigned char lo, unsigned int q)
     {
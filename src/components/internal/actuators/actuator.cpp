@@ -1,5 +1,8 @@
 #include "actuator.h"
+#include "state_poller.h"
+#include "trajectory_generator.h"
 #include "utils/log/log.h"
+#include <algorithm>
 #include <cmath>
 
 Actuator::Actuator(std::string name)
@@ -10,6 +13,12 @@ Actuator::Actuator(std::string name)
     , _calibrated(false)
     , _incs_per_deg(0)
     , _acc(0)
+    , _min_angle(0.)
+    , _max_angle(0.)
+    , _trajectory(*this)
+    , _state(JointState {})
+    , _state_epoch(0)
+    , _last_status({ 0., 0 })
 {
     _menu->add_item("f", "Forward (0-127)", [this](std::string args) { if(args.length() == 0) args = "20"; forward(static_cast<uint8_t>(std::stoi(args))); });
     _menu->add_item("b", "Backward (0-127)", [this](std::string args) { if (args.length() == 0) args = "20"; backward(static_cast<uint8_t>(std::stoi(args))); });
@@ -17,58 +26,177 @@ Actuator::Actuator(std::string name)
     _menu->add_item("fw", "Print firmware version", [this](std::string) { info() << read_firmware_version(); });
     _menu->add_item("es", "Print encoder speed", [this](std::string) { info() << "Speed:" << read_encoder_speed() << "steps/s"; });
     _menu->add_item("s", "Stop", [this](std::string) { forward(0); });
-    _menu->add_item("calib", "Calibrate", [this](std::string) { calibrate(); });
+    _menu->add_item("calib", "Calibrate", [this](std::string) {
+        try {
+            calibrate();
+        } catch (std::exception& e) {
+            critical() << "Calibration of" << _name << "failed:" << e.what();
+        }
+    });
     _menu->add_item("e", "Read encoder", [this](std::string) { info() << "Position:" << read_encoder_position() << "steps"; });
     _menu->add_item("g", "Go to", [this](std::string args) {if (args.length() > 0) move_to(std::stod(args), 10); });
     _menu->add_item("v", "Set velocity (deg/s)", [this](std::string args) { if (args.length() > 0) args = "0"; set_velocity_safe(std::stod(args)); });
     _menu->add_item("z", "Set encoder zero", [this](std::string) { set_encoder_position(0); });
+    _menu->add_item("st", "Print cached state", [this](std::string) {
+        JointState s = state();
+        info() << "Position:" << s.encoder_position << "steps, speed:" << s.encoder_speed << "steps/s, current:" << s.current << "A, battery:" << s.main_battery << "V, error:" << s.error << (is_fresh(s) ? "" : "(stale)");
+    });
+}
+
+Actuator::~Actuator()
+{
+    detach();
+}
+
+void Actuator::attach()
+{
+    StatePoller::instance().add(this);
+    TrajectoryGenerator::instance().add(&_trajectory);
+}
+
+void Actuator::detach()
+{
+    TrajectoryGenerator::instance().remove(&_trajectory);
+    StatePoller::instance().remove(this);
+}
+
+int32_t Actuator::encoder_position()
+{
+    JointState s = state();
+    return is_fresh(s) ? s.encoder_position : read_encoder_position();
+}
+
+int32_t Actuator::encoder_speed()
+{
+    JointState s = state();
+    return is_fresh(s) ? s.encoder_speed : read_encoder_speed();
 }
 
 double Actuator::pos()
 {
-    return static_cast<double>(read_encoder_position()) / _incs_per_deg;
+    return static_cast<double>(encoder_position()) / _incs_per_deg;
 }
 
-void Actuator::move_to(double deg, double speed, bool block)
+double Actuator::speed()
 {
-    if (!_calibrated) {
-        warning() << "Not calibrated...";
-        return;
+    return static_cast<double>(encoder_speed()) / _incs_per_deg;
+}
+
+void Actuator::set_encoder_position(int32_t value)
+{
+    ++_state_epoch;
+    RoboClaw::set_encoder_position(value);
+    ++_state_epoch;
+}
+
+void Actuator::update_state(const RC::channels_state_t& channels, const std::optional<RC::controller_status_t>& status, std::chrono::steady_clock::time_point stamp, unsigned int epoch)
+{
+    if (status) {
+        _last_status = *status;
     }
 
-    int32_t target = static_cast<int32_t>(deg * _incs_per_deg);
-    uint32_t velocity = static_cast<uint32_t>(speed * _incs_per_deg);
+    int i = chan() == M1 ? 0 : 1;
+    JointState s;
+    s.stamp = stamp;
+    s.epoch = epoch;
+    s.valid = true;
+    s.encoder_position = channels.encoder[i];
+    s.encoder_speed = channels.speed[i];
+    s.current = channels.current[i];
+    s.buffer = channels.buffer[i];
+    s.main_battery = _last_status.main_battery;
+    s.error = _last_status.error;
+    _state.store(s);
+}
+
+bool Actuator::is_fresh(const JointState& s)
+{
+    return s.valid && s.epoch == _state_epoch && std::chrono::steady_clock::now() - s.stamp < _max_state_age;
+}
+
+void Actuator::forward(uint8_t value)
+{
+    _trajectory.cancel();
+    RoboClaw::forward(value);
+}
+
+void Actuator::backward(uint8_t value)
+{
+    _trajectory.cancel();
+    RoboClaw::backward(value);
+}
 
-    if (velocity == 0)
-        velocity = 1;
+void Actuator::move_to(uint32_t accel, uint32_t speed, uint32_t decel, int32_t pos)
+{
+    _trajectory.cancel();
+    RoboClaw::move_to(accel, speed, decel, pos);
+}
 
-    RoboClaw::move_to(_acc, velocity, _acc, target);
+void Actuator::set_velocity(double deg_s)
+{
+    _trajectory.cancel();
+    RoboClaw::set_velocity(static_cast<int32_t>(std::round(deg_s * _incs_per_deg)));
+}
 
+void Actuator::move_to(double deg, double speed, bool block)
+{
+    std::future<bool> done = move_to_async(deg, speed);
     if (block) {
-        int threshold = 10000;
-        do {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        } while ((std::abs(target - read_encoder_position()) > threshold));
+        done.wait();
     }
 }
 
-void Actuator::set_velocity(double deg_s)
+std::future<bool> Actuator::move_to_async(double deg, double speed)
 {
-    RoboClaw::RoboClaw::set_velocity(static_cast<int32_t>(std::round(deg_s * _incs_per_deg)));
+    if (!_calibrated) {
+        warning() << "Not calibrated...";
+        std::promise<bool> p;
+        p.set_value(false);
+        return p.get_future();
+    }
+
+    return _trajectory.move_to(deg, std::max(std::fabs(speed), .1));
 }
 
 void Actuator::set_velocity_safe(double deg_s)
 {
-    if (!_calibrated) {
+    if (has_position_limits() && !_calibrated) {
         warning() << "Not calibrated...";
         return;
     }
 
-    move_to(deg_s > 0 ? _max_angle : _min_angle, std::fabs(deg_s));
+    _trajectory.set_velocity(deg_s);
+}
+
+Actuator::VelocityCommand Actuator::velocity_command(double deg_s) const
+{
+    VelocityCommand c = {};
+    c.speed = static_cast<int32_t>(std::round(deg_s * _incs_per_deg));
+    c.to_limit = has_position_limits() && c.speed != 0;
+    if (c.to_limit) {
+        c.move = { _acc, static_cast<uint32_t>(std::abs(c.speed)), _acc, static_cast<int32_t>((deg_s > 0 ? _max_angle : _min_angle) * _incs_per_deg) };
+    }
+    return c;
+}
+
+void Actuator::command_velocity(double deg_s)
+{
+    VelocityCommand c = velocity_command(deg_s);
+    if (c.to_limit) {
+        RoboClaw::move_to(c.move.accel, c.move.speed, c.move.decel, c.move.pos);
+    } else {
+        RoboClaw::set_velocity(c.speed);
+    }
 }
 
 void Actuator::calibrate(double velocity_deg_s, double final_pos, double velocity_threshold_deg_s, bool use_velocity_control)
 {
+    using namespace std::chrono_literals;
+    const auto spin_up = 500ms;
+    const auto timeout = 20s;
+    const int stall_samples = 3;
+
+    _calibrated = false;
     double calib_velocity_threshold = velocity_threshold_deg_s * _incs_per_deg;
 
     if (use_velocity_control) {
@@ -81,22 +209,53 @@ void Actuator::calibrate(double velocity_deg_s, double final_pos, double velocit
         }
     }
 
+    // Stalled when the speed drops, or when the current jumps well above its running average
     auto start = std::chrono::steady_clock::now();
-    while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() < 500)
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    while (std::abs(read_encoder_speed()) > calib_velocity_threshold) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::this_thread::sleep_for(spin_up);
+
+    std::chrono::steady_clock::time_point last_stamp;
+    double running_current = 0.;
+    int stalled = 0;
+    while (stalled < stall_samples) {
+        if (std::chrono::steady_clock::now() - start > timeout) {
+            forward(0);
+            throw std::runtime_error(_name + ": end stop not found");
+        }
+        std::this_thread::sleep_for(10ms);
+
+        JointState s = state();
+        if (!is_fresh(s)) {
+            s.encoder_speed = read_encoder_speed();
+            s.current = read_current();
+            s.stamp = std::chrono::steady_clock::now();
+        } else if (s.stamp == last_stamp) {
+            continue;
+        }
+        last_stamp = s.stamp;
+
+        double current = std::fabs(s.current);
+        bool current_spike = running_current > .05 && current > 2.5 * running_current;
+        if (std::abs(s.encoder_speed) <= calib_velocity_threshold || current_spike) {
+            ++stalled;
+        } else {
+            stalled = 0;
+            running_current = running_current > 0. ? .9 * running_current + .1 * current : current;
+        }
     }
 
     set_encoder_position(static_cast<int32_t>(std::round(final_pos * _incs_per_deg)));
     forward(0);
-    _calibrated = true;
+    mark_calibrated();
+}
 
+void Actuator::mark_calibrated()
+{
     RC::position_pid_params_t p_params = read_position_pid();
     p_params.min_pos = static_cast<int32_t>(_min_angle * _incs_per_deg);
     p_params.max_pos = static_cast<int32_t>(_max_angle * _incs_per_deg);
 
     set_position_pid(p_params);
+    _calibrated = true;
 }
 
 void Actuator::set_params_limits(double lower_limit_deg, double upper_limit_deg)
@@ -1,26 +1,62 @@
 #ifndef ACTUATOR_H
 #define ACTUATOR_H
 
+#include "joint_state.h"
 #include "roboclaw/roboclaw.h"
+#include "trajectory.h"
 #include "utils/interfaces/menu_user.h"
+#include "utils/seqlock.h"
+#include <atomic>
+#include <optional>
 #include <string>
 
 class Actuator : public RC::RoboClaw, public MenuUser {
+    friend class JointTrajectory;
+    friend class StatePoller;
+    friend class SynchronizedAxes;
+
 public:
     Actuator(std::string name);
-    virtual ~Actuator() {}
+    virtual ~Actuator();
+
+    std::string name() { return _name; }
 
     virtual void calibrate() {}
+    bool calibrated() { return _calibrated; }
+    // Applies the position limits, for joints whose encoder is known to be valid
+    void mark_calibrated();
 
+    // Cached by the StatePoller, the bus is only used when the cache is stale
+    JointState state() { return _state.load(); }
+    int32_t encoder_position();
+    int32_t encoder_speed();
     double pos();
-    using RC::RoboClaw::move_to;
-    void move_to(double deg, double speed, bool block = false);
+    double speed();
+
+    void set_encoder_position(int32_t value);
+
+    // Registers with the StatePoller and the TrajectoryGenerator. They call into
+    // the derived class, so this is done once the object is fully constructed
+    // and undone before it is destroyed.
+    void attach();
+    void detach();
+
+    // Direct commands, they cancel the current trajectory
+    void forward(uint8_t value);
+    void backward(uint8_t value);
+    void move_to(uint32_t accel, uint32_t speed, uint32_t decel, int32_t pos);
     void set_velocity(double deg_s);
-    virtual void set_velocity_safe(double deg_s);
+
+    // Jerk-limited commands streamed by the TrajectoryGenerator
+    void move_to(double deg, double speed, bool block = false);
+    std::future<bool> move_to_async(double deg, double speed);
+    void set_velocity_safe(double deg_s);
 
 protected:
     virtual void on_exit();
 
+    virtual bool has_position_limits() const { return true; }
+
     void calibrate(double velocity_deg_s, double final_pos, double velocity_threshold_deg_s, bool use_velocity_control = true);
     void set_params_limits(double lower_limit_deg, double upper_limit_deg);
     void set_params_technical(unsigned int incs_per_deg, unsigned int deg_s2);
@@ -31,13 +67,32 @@ private:
     std::string _name;
 
     bool _connected;
-    bool _calibrated;
+    std::atomic<bool> _calibrated;
 
     uint32_t _incs_per_deg;
     uint32_t _acc;
 
     double _min_angle;
     double _max_angle;
+
+    JointTrajectory _trajectory;
+
+    // Velocity as sent to the RoboClaw: a plain speed, or a move toward the limit it heads to
+    struct VelocityCommand {
+        bool to_limit;
+        int32_t speed;
+        RC::position_command_t move;
+    };
+    VelocityCommand velocity_command(double deg_s) const;
+    void command_velocity(double deg_s);
+
+    void update_state(const RC::channels_state_t& channels, const std::optional<RC::controller_status_t>& status, std::chrono::steady_clock::time_point stamp, unsigned int epoch);
+    bool is_fresh(const JointState& s);
+
+    SeqLock<JointState> _state;
+    std::atomic<unsigned int> _state_epoch;
+    RC::controller_status_t _last_status;
+    static constexpr std::chrono::milliseconds _max_state_age { 200 };
 };
 
 #endif // ACTUATOR_H
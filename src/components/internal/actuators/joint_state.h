@@ -0,0 +1,25 @@
+#ifndef JOINT_STATE_H
+#define JOINT_STATE_H
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * \brief Last state of an actuator read by the StatePoller.
+ */
+struct JointState {
+    std::chrono::steady_clock::time_point stamp;
+    unsigned int epoch; // Actuator encoder epoch when the sample was read
+    bool valid;
+
+    int32_t encoder_position; // steps
+    int32_t encoder_speed; // steps/s
+    double current; // A
+    uint8_t buffer; // RoboClaw command buffer length, 0x80 when idle
+
+    // Controller wide, refreshed at a lower rate
+    double main_battery; // V
+    uint32_t error;
+};
+
+#endif // JOINT_STATE_H
@@ -13,8 +13,3 @@ PronoSupination::PronoSupination()
     set_params_velocity(4.2f, 0.56f, 0, 6000);
     set_params_position(51., 1.4f, 428., 60., 0., -180., 180.);
 }
-
-void PronoSupination::set_velocity_safe(double deg_s)
-{
-    set_velocity(deg_s);
-}
@@ -7,7 +7,8 @@ class PronoSupination : public Actuator {
 public:
     PronoSupination();
 
-    void set_velocity_safe(double deg_s);
+protected:
+    bool has_position_limits() const override { return false; }
 };
 
 #endif // PRONOSUPINATION_H
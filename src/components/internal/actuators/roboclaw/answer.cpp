@@ -22,6 +22,11 @@ namespace Answer {
         return v == _pattern;
     }
 
+    EndsWithCRC::EndsWithCRC(std::size_t size)
+        : _size(size)
+    {
+    }
+
     bool EndsWithCRC::try_match(std::vector<std::byte> v, std::vector<std::byte> command)
     {
         if (v.size() > 2 && command.size() >= 2) {
@@ -12,6 +12,9 @@ namespace Answer {
 
         virtual bool try_match(std::vector<std::byte> v, std::vector<std::byte> command = std::vector<std::byte>()) = 0;
         virtual std::vector<std::byte> format(std::vector<std::byte> v);
+
+        // Length of a complete answer, 0 if unknown
+        virtual std::size_t expected_size() const { return 0; }
     };
 
     class ExactMatch : public BaseAnswer {
@@ -19,6 +22,7 @@ namespace Answer {
         ExactMatch(std::vector<std::byte> pattern);
 
         bool try_match(std::vector<std::byte> v, std::vector<std::byte> = std::vector<std::byte>());
+        std::size_t expected_size() const { return _pattern.size(); }
 
     private:
         std::vector<std::byte> _pattern;
@@ -31,8 +35,15 @@ namespace Answer {
 
     class EndsWithCRC : public BaseAnswer {
     public:
+        // Size of the answer including the CRC, 0 for variable length answers
+        EndsWithCRC(std::size_t size = 0);
+
         bool try_match(std::vector<std::byte> v, std::vector<std::byte> command);
         std::vector<std::byte> format(std::vector<std::byte> v);
+        std::size_t expected_size() const { return _size; }
+
+    private:
+        std::size_t _size;
     };
 }
 }
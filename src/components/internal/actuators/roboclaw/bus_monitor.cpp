@@ -0,0 +1,249 @@
+#include "bus_monitor.h"
+#include "utils/log/log.h"
+#include "utils/telemetry/scheduler.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace RC {
+
+namespace {
+    Telemetry::Schema counters_schema()
+    {
+        return Telemetry::Schema()
+            .add("requests", Telemetry::Field::UInt32)
+            .add("timeouts", Telemetry::Field::UInt32)
+            .add("bad_answers", Telemetry::Field::UInt32)
+            .add("retries", Telemetry::Field::UInt32)
+            .add("p50_us", Telemetry::Field::UInt32)
+            .add("p99_us", Telemetry::Field::UInt32)
+            .add("max_us", Telemetry::Field::UInt32);
+    }
+}
+
+void BusMonitor::Histogram::add(uint32_t us)
+{
+    std::size_t i = 0;
+    while (i < bucket_count - 1 && us >= (bucket_base_us << i)) {
+        ++i;
+    }
+    ++buckets[i];
+    ++count;
+    if (us > max_us) {
+        max_us = us;
+    }
+}
+
+uint32_t BusMonitor::Histogram::quantile(double q) const
+{
+    // Upper bound of the bucket holding the quantile
+    uint32_t target = static_cast<uint32_t>(q * count);
+    uint32_t cumulated = 0;
+    for (std::size_t i = 0; i < bucket_count - 1; ++i) {
+        cumulated += buckets[i];
+        if (cumulated > target) {
+            return std::min(bucket_base_us << i, max_us);
+        }
+    }
+    return max_us;
+}
+
+BusMonitor::BusMonitor()
+    : ThreadedLoop("roboclaw_bus", 1.)
+    , _timeout_margin_ms("timeout_margin_ms", BaseParam::ReadWrite, this, 5.)
+    , _max_retries("max_retries", BaseParam::ReadWrite, this, 2)
+    , _window_start(clock::now())
+{
+    _menu->set_description("RoboClaw bus statistics");
+    _menu->set_code("bus");
+    _menu->add_item("stats", "Show bus statistics", [this](std::string) { show_stats(); });
+    _menu->add_item("hist", "Show latency histograms", [this](std::string) { show_histograms(); });
+    _menu->add_item("reset", "Reset statistics", [this](std::string) { reset(); });
+
+    // The streams are created later, but must be destroyed before the scheduler
+    Telemetry::Scheduler::instance();
+
+    start();
+}
+
+BusMonitor::~BusMonitor()
+{
+    stop_and_join();
+}
+
+BusMonitor& BusMonitor::instance()
+{
+    static BusMonitor m;
+    return m;
+}
+
+void BusMonitor::record(const std::string& port, unsigned int bits_per_second, uint8_t address, uint8_t command, Error error, bool retry,
+    std::chrono::steady_clock::duration latency, std::chrono::steady_clock::duration busy, std::size_t bytes_out, std::size_t bytes_in)
+{
+    uint32_t us = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+    PortStats& p = _ports[port];
+    p.bits_per_second = bits_per_second;
+    p.bytes_out += bytes_out;
+    p.bytes_in += bytes_in;
+    p.window_bytes += bytes_out + bytes_in;
+    p.window_busy += busy;
+
+    ControllerStats& c = p.controllers[address];
+    for (Counters* counters : { &c.counters, &c.commands[command].counters }) {
+        if (retry) {
+            ++counters->retries;
+        }
+        if (error == Error::None) {
+            counters->latency.add(us);
+        } else if (error == Error::Timeout) {
+            ++counters->timeouts;
+        } else {
+            ++counters->bad_answers;
+        }
+    }
+}
+
+std::chrono::microseconds BusMonitor::timeout_margin()
+{
+    double ms = _timeout_margin_ms;
+    return std::chrono::microseconds(static_cast<int64_t>(std::max(0., ms) * 1000.));
+}
+
+int BusMonitor::max_retries()
+{
+    return std::max(0, static_cast<int>(_max_retries));
+}
+
+void BusMonitor::loop(double, clock::time_point time)
+{
+    std::map<std::string, PortStats> ports;
+    {
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+
+        double window_s = std::chrono::duration<double>(time - _window_start).count();
+        _window_start = time;
+        if (window_s <= 0.) {
+            return;
+        }
+
+        for (auto& p : _ports) {
+            PortStats& port = p.second;
+            port.busy_pct = 100. * std::chrono::duration<double>(port.window_busy).count() / window_s;
+            // 8N1: 10 bits per byte
+            port.wire_pct = port.bits_per_second > 0 ? 100. * 10. * port.window_bytes / (port.bits_per_second * window_s) : 0.;
+            port.window_bytes = 0;
+            port.window_busy = clock::duration::zero();
+        }
+        ports = _ports;
+    }
+
+    publish(ports);
+}
+
+void BusMonitor::publish(const std::map<std::string, PortStats>& ports)
+{
+    for (auto& p : ports) {
+        const PortStats& port = p.second;
+        std::unique_ptr<Telemetry::Stream>& port_stream = _port_streams[p.first];
+        if (!port_stream) {
+            port_stream = std::make_unique<Telemetry::Stream>(port_label(p.first), this,
+                Telemetry::Schema()
+                    .add("busy_pct", Telemetry::Field::Float32)
+                    .add("wire_pct", Telemetry::Field::Float32)
+                    .add("bytes_out", Telemetry::Field::UInt32)
+                    .add("bytes_in", Telemetry::Field::UInt32),
+                1., Telemetry::Low, std::string(), Telemetry::Packed);
+        }
+        port_stream->update({ port.busy_pct, port.wire_pct, static_cast<double>(port.bytes_out), static_cast<double>(port.bytes_in) });
+
+        for (auto& c : port.controllers) {
+            const ControllerStats& controller = c.second;
+            std::unique_ptr<Telemetry::Stream>& controller_stream = _controller_streams[std::make_pair(p.first, c.first)];
+            if (!controller_stream) {
+                controller_stream = std::make_unique<Telemetry::Stream>(address_name(c.first), port_stream.get(), counters_schema(), 1., Telemetry::Low, std::string(), Telemetry::Packed);
+            }
+            controller_stream->update(counters_values(controller.counters));
+
+            for (auto& cmd : controller.commands) {
+                std::unique_ptr<Telemetry::Stream>& command_stream = _command_streams[std::make_tuple(p.first, c.first, cmd.first)];
+                if (!command_stream) {
+                    command_stream = std::make_unique<Telemetry::Stream>(std::to_string(cmd.first), controller_stream.get(),
+                        counters_schema().add_array("bucket", bucket_count, Telemetry::Field::UInt32), .2, Telemetry::Low, std::string(), Telemetry::Packed);
+                }
+                std::vector<double> values = counters_values(cmd.second.counters);
+                for (uint32_t n : cmd.second.counters.latency.buckets) {
+                    values.push_back(n);
+                }
+                command_stream->update(values);
+            }
+        }
+    }
+}
+
+void BusMonitor::show_stats()
+{
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+    for (auto& p : _ports) {
+        info() << p.first << "@" << p.second.bits_per_second << "bauds: busy" << p.second.busy_pct << "%, wire" << p.second.wire_pct << "%,"
+               << p.second.bytes_out << "bytes out," << p.second.bytes_in << "bytes in";
+        for (auto& c : p.second.controllers) {
+            const Counters& counters = c.second.counters;
+            info() << "  " << address_name(c.first) << ":" << counters.latency.count << "ok," << counters.timeouts << "timeouts,"
+                   << counters.bad_answers << "bad answers," << counters.retries << "retries, p50" << counters.latency.quantile(.5) << "us, p99"
+                   << counters.latency.quantile(.99) << "us, max" << counters.latency.max_us << "us";
+        }
+    }
+}
+
+void BusMonitor::show_histograms()
+{
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+    for (auto& p : _ports) {
+        for (auto& c : p.second.controllers) {
+            for (auto& cmd : c.second.commands) {
+                std::stringstream ss;
+                for (std::size_t i = 0; i < bucket_count; ++i) {
+                    ss << (i < bucket_count - 1 ? "<" : ">=") << (bucket_base_us << (i < bucket_count - 1 ? i : i - 1)) << "us:" << cmd.second.counters.latency.buckets[i] << " ";
+                }
+                info() << p.first << address_name(c.first) << "cmd" << static_cast<int>(cmd.first) << ":" << ss.str();
+            }
+        }
+    }
+}
+
+void BusMonitor::reset()
+{
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+    for (auto& p : _ports) {
+        p.second.bytes_out = 0;
+        p.second.bytes_in = 0;
+        for (auto& c : p.second.controllers) {
+            c.second.counters = Counters();
+            for (auto& cmd : c.second.commands) {
+                cmd.second.counters = Counters();
+            }
+        }
+    }
+}
+
+std::vector<double> BusMonitor::counters_values(const Counters& c)
+{
+    return { static_cast<double>(c.latency.count + c.timeouts + c.bad_answers), static_cast<double>(c.timeouts), static_cast<double>(c.bad_answers),
+        static_cast<double>(c.retries), static_cast<double>(c.latency.quantile(.5)), static_cast<double>(c.latency.quantile(.99)), static_cast<double>(c.latency.max_us) };
+}
+
+std::string BusMonitor::address_name(uint8_t address)
+{
+    std::stringstream ss;
+    ss << "0x" << std::hex << static_cast<int>(address);
+    return ss.str();
+}
+
+std::string BusMonitor::port_label(const std::string& port)
+{
+    return port.substr(port.find_last_of('/') + 1);
+}
+
+}
@@ -0,0 +1,111 @@
+#ifndef BUS_MONITOR_H
+#define BUS_MONITOR_H
+
+#include "result.h"
+#include "utils/telemetry/telemetry_stream.h"
+#include "utils/threaded_loop.h"
+#include <array>
+#include <map>
+#include <memory>
+#include <tuple>
+
+namespace RC {
+
+/**
+ * \brief Health and latency statistics of the RoboClaw serial buses.
+ *
+ * RoboClaw::send records every transaction. Counters are kept per port,
+ * per controller address and per command code, with a log2 histogram of the
+ * round-trip latency. Utilization is reported both as the time the bus is
+ * held by transactions and as the share of the baud rate used by the bytes.
+ *
+ * Statistics are published every period on <port>, <port>/<address> and
+ * <port>/<address>/<command> telemetry streams, and shown by the menu.
+ *
+ * The monitor also holds the transaction policy parameters: the margin added
+ * to the wire time of a request and its answer to get its timeout, and the
+ * number of retries of idempotent requests.
+ */
+class BusMonitor : public ThreadedLoop {
+public:
+    static BusMonitor& instance();
+
+    void record(const std::string& port, unsigned int bits_per_second, uint8_t address, uint8_t command, Error error, bool retry,
+        std::chrono::steady_clock::duration latency, std::chrono::steady_clock::duration busy, std::size_t bytes_out, std::size_t bytes_in);
+
+    std::chrono::microseconds timeout_margin();
+    int max_retries();
+
+    void show_stats();
+    void show_histograms();
+    void reset();
+
+    // Bucket i counts latencies under (bucket_base_us << i), the last one the rest
+    static const std::size_t bucket_count = 12;
+    static const uint32_t bucket_base_us = 125;
+
+private:
+    struct Histogram {
+        std::array<uint32_t, bucket_count> buckets {};
+        uint32_t count = 0;
+        uint32_t max_us = 0;
+
+        void add(uint32_t us);
+        uint32_t quantile(double q) const;
+    };
+
+    struct Counters {
+        Histogram latency;
+        uint32_t timeouts = 0;
+        uint32_t bad_answers = 0;
+        uint32_t retries = 0;
+    };
+
+    struct CommandStats {
+        Counters counters;
+    };
+
+    struct ControllerStats {
+        Counters counters;
+        std::map<uint8_t, CommandStats> commands;
+    };
+
+    struct PortStats {
+        unsigned int bits_per_second = 0;
+        std::map<uint8_t, ControllerStats> controllers;
+        uint64_t bytes_out = 0;
+        uint64_t bytes_in = 0;
+
+        // Since the last publication
+        uint64_t window_bytes = 0;
+        std::chrono::steady_clock::duration window_busy {};
+        double busy_pct = 0.;
+        double wire_pct = 0.;
+    };
+
+    BusMonitor();
+    ~BusMonitor() override;
+
+    void loop(double dt, clock::time_point time) override;
+    void publish(const std::map<std::string, PortStats>& ports);
+
+    static std::vector<double> counters_values(const Counters& c);
+    static std::string address_name(uint8_t address);
+    static std::string port_label(const std::string& port);
+
+    Param<double> _timeout_margin_ms;
+    Param<int> _max_retries;
+
+    std::map<std::string, PortStats> _ports;
+    std::mutex _stats_mutex;
+    clock::time_point _window_start;
+
+    // Only used by the loop thread, outside of the stats lock
+    std::map<std::string, std::unique_ptr<Telemetry::Stream>> _port_streams;
+    std::map<std::pair<std::string, uint8_t>, std::unique_ptr<Telemetry::Stream>> _controller_streams;
+    std::map<std::tuple<std::string, uint8_t, uint8_t>, std::unique_ptr<Telemetry::Stream>> _command_streams;
+};
+
+}
+
+#endif // BUS_MONITOR_H
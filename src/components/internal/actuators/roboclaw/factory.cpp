@@ -18,3 +18,13 @@ std::shared_ptr<SerialPort> RC::Factory::get(std::string port_name, unsigned int
     }
     return _map.at(port_name);
 }
+
+void RC::Factory::add(std::string port_name, std::shared_ptr<SerialPort> port)
+{
+    _map[port_name] = port;
+}
+
+void RC::Factory::remove(std::string port_name)
+{
+    _map.erase(port_name);
+}
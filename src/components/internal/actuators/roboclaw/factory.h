@@ -10,6 +10,9 @@ namespace RC {
 class Factory {
 public:
     static std::shared_ptr<SerialPort> get(std::string port_name, unsigned int baudrate);
+    // Hands port out for port_name from now on, e.g. the line of a simulated controller
+    static void add(std::string port_name, std::shared_ptr<SerialPort> port);
+    static void remove(std::string port_name);
 
 private:
     Factory();
@@ -0,0 +1,84 @@
+#ifndef RC_RESULT_H
+#define RC_RESULT_H
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace RC {
+
+enum class Error {
+    None,
+    Timeout, // no answer at all
+    BadAnswer // answer received but never matched: corrupted or truncated
+};
+
+inline std::string error_string(Error error)
+{
+    switch (error) {
+    case Error::None:
+        return "no error";
+    case Error::Timeout:
+        return "request timed out";
+    case Error::BadAnswer:
+        return "bad answer";
+    }
+    return "";
+}
+
+/**
+ * \brief Outcome of a RoboClaw request, for callers that degrade gracefully
+ * instead of unwinding.
+ */
+template <typename T>
+class Result {
+public:
+    Result(T value)
+        : _value(std::move(value))
+        , _error(Error::None)
+    {
+    }
+
+    Result(Error error)
+        : _error(error)
+    {
+    }
+
+    bool ok() const { return _error == Error::None; }
+    explicit operator bool() const { return ok(); }
+    Error error() const { return _error; }
+
+    const T& value() const
+    {
+        if (!ok()) {
+            throw std::runtime_error(error_string(_error));
+        }
+        return *_value;
+    }
+
+    T value_or(T fallback) const { return ok() ? *_value : fallback; }
+
+private:
+    std::optional<T> _value;
+    Error _error;
+};
+
+template <>
+class Result<void> {
+public:
+    Result(Error error = Error::None)
+        : _error(error)
+    {
+    }
+
+    bool ok() const { return _error == Error::None; }
+    explicit operator bool() const { return ok(); }
+    Error error() const { return _error; }
+
+private:
+    Error _error;
+};
+
+}
+
+#endif // RC_RESULT_H
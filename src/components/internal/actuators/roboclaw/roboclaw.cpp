@@ -1,10 +1,13 @@
 #include "roboclaw.h"
+#include "bus_monitor.h"
 #include "cast_helper.h"
 #include "factory.h"
+#include "utils/trace/trace.h"
+#include <algorithm>
 #include <cmath>
 
 #define ff_answer std::make_shared<Answer::ExactMatch>(std::vector<std::byte>(1, std::byte { 0xff }))
-#define crc_answer std::make_shared<Answer::EndsWithCRC>()
+#define crc_answer(size) std::make_shared<Answer::EndsWithCRC>(size)
 
 RC::RoboClaw::RoboClaw()
     : _address(0x80)
@@ -36,12 +39,12 @@ void RC::RoboClaw::backward(uint8_t value)
 
 int32_t RC::RoboClaw::read_encoder_position()
 {
-    return CastHelper::to<int32_t>(send(Message(_address, get_fn_code(16, 17), crc_answer, std::vector<std::byte>(), false)));
+    return CastHelper::to<int32_t>(send(Message(_address, get_fn_code(16, 17), crc_answer(7), std::vector<std::byte>(), false)));
 }
 
 int32_t RC::RoboClaw::read_encoder_speed()
 {
-    return CastHelper::to<int32_t>(send(Message(_address, get_fn_code(30, 31), crc_answer, std::vector<std::byte>(), false)));
+    return CastHelper::to<int32_t>(send(Message(_address, get_fn_code(30, 31), crc_answer(7), std::vector<std::byte>(), false)));
 }
 
 void RC::RoboClaw::set_velocity(int32_t value)
@@ -49,9 +52,14 @@ void RC::RoboClaw::set_velocity(int32_t value)
     send(Message(_address, get_fn_code(35, 36), ff_answer, CastHelper::from(value)));
 }
 
+RC::Result<void> RC::RoboClaw::try_set_velocity(int32_t value)
+{
+    return try_send(Message(_address, get_fn_code(35, 36), ff_answer, CastHelper::from(value))).error();
+}
+
 std::string RC::RoboClaw::read_firmware_version()
 {
-    std::vector<std::byte> ans = send(Message(_address, 21, crc_answer, std::vector<std::byte>(), false));
+    std::vector<std::byte> ans = send(Message(_address, 21, crc_answer(0), std::vector<std::byte>(), false));
     std::string ret;
     for (auto b : ans) {
         ret.push_back(static_cast<char>(b));
@@ -66,12 +74,12 @@ void RC::RoboClaw::set_encoder_position(int32_t value)
 
 double RC::RoboClaw::read_main_battery_voltage()
 {
-    return .1 * CastHelper::to<uint16_t>(send(Message(_address, 24, crc_answer, std::vector<std::byte>())));
+    return .1 * CastHelper::to<uint16_t>(send(Message(_address, 24, crc_answer(4), std::vector<std::byte>(), false)));
 }
 
 double RC::RoboClaw::read_current()
 {
-    std::vector<std::byte> buf = send(Message(_address, 49, crc_answer, std::vector<std::byte>(), false));
+    std::vector<std::byte> buf = send(Message(_address, 49, crc_answer(6), std::vector<std::byte>(), false));
     if (_channel == M1)
         return CastHelper::to<int16_t>(buf) / 100.;
     else {
@@ -96,7 +104,7 @@ void RC::RoboClaw::set_velocity_pid(velocity_pid_params_t params)
 RC::velocity_pid_params_t RC::RoboClaw::read_velocity_pid()
 {
     velocity_pid_params_t ret;
-    std::vector<std::byte> buf = send(Message(_address, get_fn_code(55, 56), crc_answer, std::vector<std::byte>(), false));
+    std::vector<std::byte> buf = send(Message(_address, get_fn_code(55, 56), crc_answer(18), std::vector<std::byte>(), false));
     ret.p = static_cast<float>(CastHelper::to<uint32_t>(buf) / 65536.);
     buf.erase(buf.begin(), buf.begin() + 4);
     ret.i = static_cast<float>(CastHelper::to<uint32_t>(buf) / 65536.);
@@ -130,7 +138,7 @@ void RC::RoboClaw::set_position_pid(position_pid_params_t params)
 RC::position_pid_params_t RC::RoboClaw::read_position_pid()
 {
     position_pid_params_t ret;
-    std::vector<std::byte> buf = send(Message(_address, get_fn_code(63, 64), crc_answer, std::vector<std::byte>(), false));
+    std::vector<std::byte> buf = send(Message(_address, get_fn_code(63, 64), crc_answer(30), std::vector<std::byte>(), false));
     ret.p = static_cast<float>(CastHelper::to<uint32_t>(buf) / 1024.);
     buf.erase(buf.begin(), buf.begin() + 4);
     ret.i = static_cast<float>(CastHelper::to<uint32_t>(buf) / 1024.);
@@ -147,7 +155,7 @@ RC::position_pid_params_t RC::RoboClaw::read_position_pid()
     return ret;
 }
 
-void RC::RoboClaw::move_to(uint32_t accel, uint32_t speed, uint32_t decel, int32_t pos)
+void RC::RoboClaw::move_to(uint32_t accel, uint32_t speed, uint32_t decel, int32_t pos, bool buffered)
 {
     std::vector<std::byte> tmp, payload;
     tmp = CastHelper::from(accel);
@@ -158,39 +166,231 @@ void RC::RoboClaw::move_to(uint32_t accel, uint32_t speed, uint32_t decel, int32
     payload.insert(payload.end(), tmp.begin(), tmp.end());
     tmp = CastHelper::from(pos);
     payload.insert(payload.end(), tmp.begin(), tmp.end());
-    tmp = CastHelper::from<uint8_t>(1);
+    tmp = CastHelper::from<uint8_t>(buffered ? 0 : 1);
+    payload.insert(payload.end(), tmp.begin(), tmp.end());
+    send(Message(_address, get_fn_code(65, 66), ff_answer, payload), !buffered);
+}
+
+void RC::RoboClaw::move_distance(uint32_t accel, int32_t speed, uint32_t distance, bool buffered)
+{
+    std::vector<std::byte> tmp, payload;
+    tmp = CastHelper::from(accel);
+    payload.insert(payload.end(), tmp.begin(), tmp.end());
+    tmp = CastHelper::from(speed);
+    payload.insert(payload.end(), tmp.begin(), tmp.end());
+    tmp = CastHelper::from(distance);
+    payload.insert(payload.end(), tmp.begin(), tmp.end());
+    tmp = CastHelper::from<uint8_t>(buffered ? 0 : 1);
     payload.insert(payload.end(), tmp.begin(), tmp.end());
-    send(Message(_address, get_fn_code(65, 66), ff_answer, payload));
+    // Relative: a retry after a lost acknowledgement would move twice as far
+    send(Message(_address, get_fn_code(44, 45), ff_answer, payload), false);
+}
+
+uint8_t RC::RoboClaw::read_buffer_length()
+{
+    return try_read_buffer_length().value();
 }
 
-std::vector<std::byte> RC::RoboClaw::send(const Message& msg)
+RC::Result<uint8_t> RC::RoboClaw::try_read_buffer_length()
 {
-    static const int to = 100;
-    std::vector<std::byte> ret;
+    Result<std::vector<std::byte>> buf = try_send(Message(_address, 47, crc_answer(4), std::vector<std::byte>(), false));
+    if (!buf) {
+        return buf.error();
+    }
+    if (buf.value().size() < 2) {
+        return static_cast<uint8_t>(0);
+    }
+    return static_cast<uint8_t>(_channel == M1 ? buf.value()[0] : buf.value()[1]);
+}
 
-    _serial_port->take_ownership();
-    _serial_port->read_all();
+RC::channels_state_t RC::RoboClaw::read_channels_state()
+{
+    return try_read_channels_state().value();
+}
+
+RC::Result<RC::channels_state_t> RC::RoboClaw::try_read_channels_state()
+{
+    channels_state_t ret;
+
+    Result<std::vector<std::byte>> res = try_send(Message(_address, 78, crc_answer(10), std::vector<std::byte>(), false));
+    if (!res) {
+        return res.error();
+    }
+    std::vector<std::byte> buf = res.value();
+    ret.encoder[0] = CastHelper::to<int32_t>(buf);
+    ret.encoder[1] = CastHelper::to<int32_t>(std::vector<std::byte>(buf.begin() + std::min<std::size_t>(4, buf.size()), buf.end()));
+
+    res = try_send(Message(_address, 79, crc_answer(10), std::vector<std::byte>(), false));
+    if (!res) {
+        return res.error();
+    }
+    buf = res.value();
+    ret.speed[0] = CastHelper::to<int32_t>(buf);
+    ret.speed[1] = CastHelper::to<int32_t>(std::vector<std::byte>(buf.begin() + std::min<std::size_t>(4, buf.size()), buf.end()));
+
+    res = try_send(Message(_address, 49, crc_answer(6), std::vector<std::byte>(), false));
+    if (!res) {
+        return res.error();
+    }
+    buf = res.value();
+    ret.current[0] = CastHelper::to<int16_t>(buf) / 100.;
+    ret.current[1] = CastHelper::to<int16_t>(std::vector<std::byte>(buf.begin() + std::min<std::size_t>(2, buf.size()), buf.end())) / 100.;
+
+    res = try_send(Message(_address, 47, crc_answer(4), std::vector<std::byte>(), false));
+    if (!res) {
+        return res.error();
+    }
+    buf = res.value();
+    ret.buffer[0] = buf.size() > 0 ? static_cast<uint8_t>(buf[0]) : 0;
+    ret.buffer[1] = buf.size() > 1 ? static_cast<uint8_t>(buf[1]) : 0;
+
+    return ret;
+}
+
+void RC::RoboClaw::set_velocities(int32_t m1, int32_t m2)
+{
+    std::vector<std::byte> tmp, payload;
+    tmp = CastHelper::from(m1);
+    payload.insert(payload.end(), tmp.begin(), tmp.end());
+    tmp = CastHelper::from(m2);
+    payload.insert(payload.end(), tmp.begin(), tmp.end());
+    send(Message(_address, 37, ff_answer, payload));
+}
+
+RC::Result<void> RC::RoboClaw::try_set_velocities(int32_t m1, int32_t m2)
+{
+    std::vector<std::byte> tmp, payload;
+    tmp = CastHelper::from(m1);
+    payload.insert(payload.end(), tmp.begin(), tmp.end());
+    tmp = CastHelper::from(m2);
+    payload.insert(payload.end(), tmp.begin(), tmp.end());
+    return try_send(Message(_address, 37, ff_answer, payload)).error();
+}
+
+void RC::RoboClaw::move_both_to(position_command_t m1, position_command_t m2, bool buffered)
+{
+    std::vector<std::byte> tmp, payload;
+    for (const position_command_t& c : { m1, m2 }) {
+        tmp = CastHelper::from(c.accel);
+        payload.insert(payload.end(), tmp.begin(), tmp.end());
+        tmp = CastHelper::from(c.speed);
+        payload.insert(payload.end(), tmp.begin(), tmp.end());
+        tmp = CastHelper::from(c.decel);
+        payload.insert(payload.end(), tmp.begin(), tmp.end());
+        tmp = CastHelper::from(c.pos);
+        payload.insert(payload.end(), tmp.begin(), tmp.end());
+    }
+    tmp = CastHelper::from<uint8_t>(buffered ? 0 : 1);
+    payload.insert(payload.end(), tmp.begin(), tmp.end());
+    send(Message(_address, 67, ff_answer, payload), !buffered);
+}
+
+RC::controller_status_t RC::RoboClaw::read_status()
+{
+    controller_status_t ret;
+    ret.main_battery = read_main_battery_voltage();
+    ret.error = CastHelper::to<uint32_t>(send(Message(_address, 90, crc_answer(0), std::vector<std::byte>(), false)));
+    return ret;
+}
+
+void RC::RoboClaw::set_timeout(uint8_t command, std::chrono::microseconds timeout)
+{
+    _timeouts[command] = timeout;
+}
+
+std::chrono::microseconds RC::RoboClaw::timeout(const Message& msg)
+{
+    static const std::size_t unknown_answer_size = 64;
+    static const std::chrono::microseconds max_timeout(100000);
+
+    std::vector<std::byte> data = msg.data();
+    auto it = _timeouts.find(static_cast<uint8_t>(data[1]));
+    if (it != _timeouts.end()) {
+        return it->second;
+    }
+
+    unsigned int bps = _serial_port->bits_per_second();
+    if (bps == 0) {
+        return max_timeout;
+    }
+
+    // 8N1: 10 bits per byte on the wire
+    std::size_t answer = msg.answer()->expected_size() > 0 ? msg.answer()->expected_size() : unknown_answer_size;
+    std::chrono::microseconds wire(10ull * 1000000ull * (data.size() + answer) / bps);
+    return std::min(max_timeout, wire + BusMonitor::instance().timeout_margin());
+}
+
+std::vector<std::byte> RC::RoboClaw::send(const Message& msg, bool retry)
+{
+    Result<std::vector<std::byte>> ret = try_send(msg, retry);
+    if (!ret) {
+        throw std::runtime_error(error_string(ret.error()) + ": " + msg.to_string());
+    }
+    return ret.value();
+}
+
+RC::Result<std::vector<std::byte>> RC::RoboClaw::try_send(const Message& msg, bool retry)
+{
+    TRACE_SCOPE("RoboClaw::send");
+    using clock = std::chrono::steady_clock;
+
+    BusMonitor& monitor = BusMonitor::instance();
+    std::vector<std::byte> data = msg.data();
+    std::size_t expected = msg.answer()->expected_size();
+    unsigned int bps = _serial_port->bits_per_second();
+    std::chrono::microseconds to = timeout(msg);
+    std::chrono::microseconds quiet = std::max(std::chrono::microseconds(1000), std::chrono::microseconds(bps > 0 ? 4 * 10 * 1000000 / bps : 0));
+    int attempts = 1 + (retry ? monitor.max_retries() : 0);
+
+    std::lock_guard<std::mutex> lock(_serial_port->transaction_mutex());
+    SerialPort::OwnershipGuard ownership(*_serial_port);
+
+    Error error = Error::Timeout;
+    for (int attempt = 0; attempt < attempts; ++attempt) {
+        auto locked = clock::now();
+        if (attempt == 0) {
+            _serial_port->read_all();
+        } else {
+            // Resync: let a late answer end, then start again from a clean line
+            _serial_port->drain(quiet);
+        }
 
-    auto start = std::chrono::steady_clock::now();
+        std::vector<std::byte> ret;
+        auto start = clock::now();
+        auto deadline = start + to;
+        _serial_port->write(data);
 
-    _serial_port->write(msg.data());
+        while (true) {
+            auto now = clock::now();
+            if (now >= deadline) {
+                error = ret.empty() ? Error::Timeout : Error::BadAnswer;
+                break;
+            }
+            if (!_serial_port->wait_available(std::chrono::duration_cast<std::chrono::microseconds>(deadline - now))) {
+                continue;
+            }
 
-    while (true) {
-        std::vector<std::byte> tmp = _serial_port->read_all();
-        ret.insert(ret.end(), tmp.begin(), tmp.end());
+            std::vector<std::byte> tmp = _serial_port->read_all();
+            ret.insert(ret.end(), tmp.begin(), tmp.end());
 
-        if (msg.answer()->try_match(ret, msg.data())) {
-            break;
+            if (msg.answer()->try_match(ret, data)) {
+                error = Error::None;
+                break;
+            }
+            // Complete but wrong, no need to wait for the timeout
+            if (expected > 0 && ret.size() >= expected) {
+                error = Error::BadAnswer;
+                break;
+            }
         }
 
-        auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        auto end = clock::now();
+        monitor.record(_serial_port->port_name(), bps, _address, static_cast<uint8_t>(data[1]), error, attempt > 0, end - start, end - locked, data.size(), ret.size());
 
-        if (elapsed_ms >= to) {
-            _serial_port->release_ownership();
-            throw std::runtime_error("Request timed out: " + msg.to_string());
+        if (error == Error::None) {
+            return msg.answer()->format(ret);
         }
     }
 
-    _serial_port->release_ownership();
-    return msg.answer()->format(ret);
+    return error;
 }
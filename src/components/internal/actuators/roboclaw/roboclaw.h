@@ -2,9 +2,12 @@
 #define ROBOCLAW_H
 
 #include "message.h"
+#include "result.h"
 #include "types.h"
 #include "utils/serial_port.h"
+#include <chrono>
 #include <cstddef>
+#include <map>
 #include <vector>
 
 namespace RC {
@@ -22,6 +25,7 @@ public:
 
     inline uint8_t address() { return _address; }
     inline Channel chan() { return _channel; }
+    std::string port_name() { return _serial_port ? _serial_port->port_name() : std::string(); }
 
     void forward(uint8_t value);
     void backward(uint8_t value);
@@ -36,10 +40,34 @@ public:
     velocity_pid_params_t read_velocity_pid();
     void set_position_pid(position_pid_params_t params);
     position_pid_params_t read_position_pid();
-    void move_to(uint32_t accel, uint32_t speed, uint32_t decel, int32_t pos);
+    void move_to(uint32_t accel, uint32_t speed, uint32_t decel, int32_t pos, bool buffered = false);
+    void move_distance(uint32_t accel, int32_t speed, uint32_t distance, bool buffered = false);
+    uint8_t read_buffer_length();
+
+    // Both channels of the controller at once
+    channels_state_t read_channels_state();
+    controller_status_t read_status();
+    void set_velocities(int32_t m1, int32_t m2);
+    void move_both_to(position_command_t m1, position_command_t m2, bool buffered = false);
+
+    // Non-throwing variants for the control loops
+    Result<channels_state_t> try_read_channels_state();
+    Result<uint8_t> try_read_buffer_length();
+    Result<void> try_set_velocity(int32_t value);
+    Result<void> try_set_velocities(int32_t m1, int32_t m2);
+
+    // Overrides the timeout derived from the baud rate and the answer size
+    void set_timeout(uint8_t command, std::chrono::microseconds timeout);
+
+    static const uint8_t buffer_idle = 0x80;
 
 private:
-    std::vector<std::byte> send(const Message& msg);
+    // Buffered and relative commands must not be retried: the first one may
+    // have been queued or executed
+    std::vector<std::byte> send(const Message& msg, bool retry = true);
+    Result<std::vector<std::byte>> try_send(const Message& msg, bool retry = true);
+    std::chrono::microseconds timeout(const Message& msg);
+
     inline uint8_t get_fn_code(uint8_t if_m1, uint8_t if_m2)
     {
         return (_channel == Channel::M1 ? if_m1 : if_m2);
@@ -48,6 +76,7 @@ private:
     std::shared_ptr<SerialPort> _serial_port;
     uint8_t _address;
     Channel _channel;
+    std::map<uint8_t, std::chrono::microseconds> _timeouts;
 };
 }
 
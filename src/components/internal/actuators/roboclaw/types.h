@@ -20,6 +20,27 @@ typedef struct {
     float d;
     uint32_t qpps;
 } velocity_pid_params_t;
+
+// Indexed by channel - 1
+typedef struct {
+    int32_t encoder[2];
+    int32_t speed[2];
+    double current[2];
+    uint8_t buffer[2];
+} channels_state_t;
+
+// Arguments of the per-channel part of the mixed commands
+typedef struct {
+    uint32_t accel;
+    uint32_t speed;
+    uint32_t decel;
+    int32_t pos;
+} position_command_t;
+
+typedef struct {
+    double main_battery;
+    uint32_t error;
+} controller_status_t;
 }
 
 #endif // TYPES_H
@@ -13,8 +13,3 @@ ShoulderRotator::ShoulderRotator()
     set_params_velocity(0.075, 0.006, 0, 667500);
     set_params_position(20., 0., 0., 0., 0., -180., 180.);
 }
-
-void ShoulderRotator::set_velocity_safe(double deg_s)
-{
-    set_velocity(deg_s);
-}
@@ -8,7 +8,8 @@ class ShoulderRotator : public Actuator {
 public:
     ShoulderRotator();
 
-    void set_velocity_safe(double deg_s);
+protected:
+    bool has_position_limits() const override { return false; }
 };
 
 #endif // SHOULDERROTATOR_H
@@ -0,0 +1,105 @@
+#include "state_poller.h"
+#include "actuator.h"
+#include "utils/log/log.h"
+#include <algorithm>
+
+StatePoller::StatePoller()
+    : ThreadedLoop("actuator_state_poller", 0.02)
+    , _cycle(0)
+    , _status_divider("status_divider", BaseParam::ReadWrite, this, 10)
+{
+    supervise(std::chrono::milliseconds(200));
+
+    _menu->set_description("Actuator state poller");
+    _menu->set_code("poller");
+
+    start();
+}
+
+StatePoller::~StatePoller()
+{
+    stop_and_join();
+}
+
+StatePoller& StatePoller::instance()
+{
+    static StatePoller p;
+    return p;
+}
+
+void StatePoller::add(Actuator* actuator)
+{
+    std::lock_guard<std::mutex> lock(_actuators_mutex);
+    if (std::find(_actuators.begin(), _actuators.end(), actuator) == _actuators.end()) {
+        _actuators.push_back(actuator);
+    }
+}
+
+void StatePoller::remove(Actuator* actuator)
+{
+    {
+        std::lock_guard<std::mutex> lock(_actuators_mutex);
+        _actuators.erase(std::remove(_actuators.begin(), _actuators.end(), actuator), _actuators.end());
+    }
+
+    // The cycle in progress may still hold it
+    std::lock_guard<std::mutex> lock(_poll_mutex);
+}
+
+void StatePoller::loop(double, clock::time_point time)
+{
+    std::lock_guard<std::mutex> poll_lock(_poll_mutex);
+
+    std::vector<Actuator*> actuators;
+    {
+        std::lock_guard<std::mutex> lock(_actuators_mutex);
+        actuators = _actuators;
+    }
+
+    std::map<std::pair<std::string, uint8_t>, std::vector<Actuator*>> controllers;
+    for (Actuator* a : actuators) {
+        std::string port = a->port_name();
+        if (!port.empty()) {
+            controllers[std::make_pair(port, a->address())].push_back(a);
+        }
+    }
+
+    int divider = std::max(1, static_cast<int>(_status_divider));
+    bool read_status = _cycle++ % static_cast<unsigned int>(divider) == 0;
+
+    for (auto& c : controllers) {
+        auto retry = _retry_after.find(c.first);
+        if (retry != _retry_after.end() && time < retry->second) {
+            continue;
+        }
+
+        // Samples read while the encoder is being reset are discarded by the epoch check
+        std::vector<unsigned int> epochs;
+        for (Actuator* a : c.second) {
+            epochs.push_back(a->_state_epoch);
+        }
+
+        try {
+            Actuator* lead = c.second.front();
+            RC::Result<RC::channels_state_t> channels = lead->try_read_channels_state();
+            if (!channels) {
+                warning() << "Failed to poll RoboClaw" << c.first.second << "on" << c.first.first << ":" << RC::error_string(channels.error());
+                _retry_after[c.first] = time + std::chrono::seconds(1);
+                continue;
+            }
+            std::optional<RC::controller_status_t> status;
+            if (read_status) {
+                status = lead->read_status();
+            }
+
+            auto now = clock::now();
+            for (std::size_t i = 0; i < c.second.size(); ++i) {
+                c.second[i]->update_state(channels.value(), status, now, epochs[i]);
+            }
+            _retry_after.erase(c.first);
+        } catch (std::exception& e) {
+            warning() << "Failed to poll RoboClaw" << c.first.second << "on" << c.first.first << ":" << e.what();
+            _retry_after[c.first] = time + std::chrono::seconds(1);
+        }
+    }
+}
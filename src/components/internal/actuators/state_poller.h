@@ -0,0 +1,45 @@
+#ifndef STATE_POLLER_H
+#define STATE_POLLER_H
+
+#include "utils/threaded_loop.h"
+#include <map>
+#include <vector>
+
+class Actuator;
+
+/**
+ * \brief Refreshes the cached state of every actuator from a single thread.
+ *
+ * Both channels of a RoboClaw are read together, so each controller costs
+ * one poll cycle whatever the number of actuators it drives. Battery voltage
+ * and error flags are read every "status_divider" cycles. The poll rate is
+ * the loop period.
+ *
+ * The serial links are polled without holding the actuator list; remove()
+ * waits for the cycle in progress, so an actuator is never polled once it
+ * has been removed.
+ */
+class StatePoller : public ThreadedLoop {
+public:
+    static StatePoller& instance();
+
+    void add(Actuator* actuator);
+    void remove(Actuator* actuator);
+
+private:
+    StatePoller();
+    ~StatePoller() override;
+
+    void loop(double dt, clock::time_point time) override;
+
+    std::vector<Actuator*> _actuators;
+    std::mutex _actuators_mutex;
+    std::mutex _poll_mutex;
+
+    std::map<std::pair<std::string, uint8_t>, clock::time_point> _retry_after;
+    unsigned int _cycle;
+
+    Param<int> _status_divider;
+};
+
+#endif // STATE_POLLER_H
@@ -0,0 +1,25 @@
+#include "synchronized_axes.h"
+
+bool SynchronizedAxes::share_controller(Actuator& a, Actuator& b)
+{
+    return &a != &b && !a.port_name().empty() && a.port_name() == b.port_name() && a.address() == b.address() && a.chan() != b.chan();
+}
+
+void SynchronizedAxes::command_velocities(Actuator& a, double a_deg_s, Actuator& b, double b_deg_s)
+{
+    Actuator::VelocityCommand a_cmd = a.velocity_command(a_deg_s);
+    Actuator::VelocityCommand b_cmd = b.velocity_command(b_deg_s);
+    bool a_first = a.chan() == RC::RoboClaw::M1;
+    const Actuator::VelocityCommand& m1 = a_first ? a_cmd : b_cmd;
+    const Actuator::VelocityCommand& m2 = a_first ? b_cmd : a_cmd;
+
+    if (!m1.to_limit && !m2.to_limit) {
+        a.set_velocities(m1.speed, m2.speed);
+    } else if (m1.to_limit && m2.to_limit) {
+        a.move_both_to(m1.move, m2.move);
+    } else {
+        // No mixed frame combines a plain speed with a position move
+        a.command_velocity(a_deg_s);
+        b.command_velocity(b_deg_s);
+    }
+}
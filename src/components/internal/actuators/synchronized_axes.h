@@ -0,0 +1,19 @@
+#ifndef SYNCHRONIZED_AXES_H
+#define SYNCHRONIZED_AXES_H
+
+#include "actuator.h"
+
+/**
+ * \brief Two joints on the two channels of one RoboClaw, commanded together.
+ *
+ * Both motors are updated by a single mixed frame, so they start with the
+ * same timing and the bus carries half the frames of two channel commands.
+ * The TrajectoryGenerator uses it to flush the velocities of such joints.
+ */
+class SynchronizedAxes {
+public:
+    static bool share_controller(Actuator& a, Actuator& b);
+    static void command_velocities(Actuator& a, double a_deg_s, Actuator& b, double b_deg_s);
+};
+
+#endif // SYNCHRONIZED_AXES_H
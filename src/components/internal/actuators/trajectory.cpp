@@ -0,0 +1,441 @@
+#include "trajectory.h"
+#include "actuator.h"
+#include "synchronized_axes.h"
+#include "trajectory_generator.h"
+#include "utils/log/log.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Trajectory {
+
+Profile::Profile()
+    : _v_max(0.)
+    , _a_max(0.)
+    , _j_max(0.)
+    , _pos(0.)
+    , _vel(0.)
+    , _acc(0.)
+{
+}
+
+void Profile::set_limits(double v_max, double a_max, double j_max)
+{
+    _v_max = v_max;
+    _a_max = a_max;
+    _j_max = j_max;
+}
+
+void Profile::reset(double pos, double vel)
+{
+    set_state(pos, vel, 0.);
+}
+
+void Profile::set_state(double pos, double vel, double acc)
+{
+    _pos = pos;
+    _vel = vel;
+    _acc = acc;
+}
+
+void Profile::track_velocity(double v_target, double dt)
+{
+    v_target = std::clamp(v_target, -_v_max, _v_max);
+    double dv = v_target - _vel;
+    double da_max = _j_max * dt;
+
+    if (std::fabs(dv) <= da_max * dt && std::fabs(_acc) <= da_max) {
+        _pos += .5 * (_vel + v_target) * dt;
+        _vel = v_target;
+        _acc = 0.;
+        return;
+    }
+
+    // Velocity still gained while ramping the acceleration down to zero
+    double dv_ramp = _acc * std::fabs(_acc) / (2. * _j_max);
+    double a_des = dv - dv_ramp > 0. ? _a_max : -_a_max;
+    _acc += std::clamp(a_des - _acc, -da_max, da_max);
+
+    double v_prev = _vel;
+    _vel += _acc * dt;
+    if ((v_target - v_prev) * (v_target - _vel) < 0.) {
+        _vel = v_target;
+        _acc = 0.;
+    }
+    _pos += .5 * (v_prev + _vel) * dt;
+}
+
+bool Profile::settled(double v_target) const
+{
+    return _vel == v_target && _acc == 0.;
+}
+
+namespace {
+    const double plan_dt = .002;
+    const double max_plan_s = 60.;
+
+    double travel(Profile p, double v_target)
+    {
+        double p0 = p.pos();
+        for (double t = 0.; t < max_plan_s && !p.settled(v_target); t += plan_dt) {
+            p.track_velocity(v_target, plan_dt);
+        }
+        return p.pos() - p0;
+    }
+}
+
+std::vector<Segment> plan_move(Profile profile, double target, double v_max, double segment_s, std::size_t max_segments, double& duration_s)
+{
+    const int steps_per_segment = std::max(1, static_cast<int>(std::round(segment_s / plan_dt)));
+    const double dir = target >= profile.pos() ? 1. : -1.;
+    const double distance_to_go = std::fabs(target - profile.pos());
+
+    // Distance needed to reach a cruise speed from the current state, then to stop from it
+    auto stop_distance = [&](double v) {
+        Profile cruise = profile;
+        cruise.set_state(0., dir * v, 0.);
+        return dir * travel(cruise, 0.);
+    };
+    auto needed = [&](double v) { return dir * travel(profile, dir * v) + stop_distance(v); };
+
+    double v_cruise = v_max;
+    if (needed(v_max) > distance_to_go) {
+        double lo = 0., hi = v_max;
+        for (int i = 0; i < 20; ++i) {
+            double mid = .5 * (lo + hi);
+            (needed(mid) <= distance_to_go ? lo : hi) = mid;
+        }
+        v_cruise = lo;
+    }
+    double d_stop = stop_distance(v_cruise);
+
+    std::vector<Segment> segments;
+    bool braking = false;
+    duration_s = 0.;
+
+    while (duration_s < max_plan_s && !(braking && profile.settled(0.))) {
+        double v0 = profile.vel(), p0 = profile.pos();
+        for (int i = 0; i < steps_per_segment; ++i) {
+            braking = braking || dir * (target - profile.pos()) <= d_stop;
+            profile.track_velocity(braking ? 0. : dir * v_cruise, plan_dt);
+        }
+        duration_s += steps_per_segment * plan_dt;
+
+        double distance = profile.pos() - p0;
+        double speed = profile.vel();
+        // A segment ending at rest would never complete, the final position command covers it
+        if (std::fabs(distance) < 1e-3 || std::fabs(speed) < .1 || distance * speed < 0.) {
+            continue;
+        }
+
+        // Coalesce constant velocity segments
+        if (!segments.empty() && std::fabs(segments.back().speed - speed) < .5 && std::fabs(v0 - speed) < .5) {
+            segments.back().distance += std::fabs(distance);
+            continue;
+        }
+        segments.push_back({ std::fabs(speed - v0) / (steps_per_segment * plan_dt), speed, std::fabs(distance) });
+    }
+
+    // Merge pairs until the plan fits in the RoboClaw buffer
+    while (segments.size() > max_segments) {
+        std::vector<Segment> merged;
+        for (std::size_t i = 0; i < segments.size(); i += 2) {
+            Segment s = segments[i];
+            if (i + 1 < segments.size()) {
+                s.accel = std::max(s.accel, segments[i + 1].accel);
+                s.speed = segments[i + 1].speed;
+                s.distance += segments[i + 1].distance;
+            }
+            merged.push_back(s);
+        }
+        segments.swap(merged);
+    }
+
+    return segments;
+}
+
+}
+
+JointTrajectory::JointTrajectory(Actuator& actuator)
+    : _actuator(actuator)
+    , _mode(Idle)
+    , _velocity_target(0.)
+    , _last_sent_velocity(0.)
+    , _move_target(0.)
+    , _move_speed(0.)
+{
+}
+
+JointTrajectory::~JointTrajectory()
+{
+    TrajectoryGenerator::instance().remove(this);
+    cancel();
+}
+
+void JointTrajectory::set_velocity(double deg_s)
+{
+    std::lock_guard<std::mutex> lock(_request_mutex);
+    if (_request && _request->done) {
+        _request->done->set_value(false);
+    }
+    _request = Request { Velocity, deg_s, 0., std::nullopt };
+}
+
+std::future<bool> JointTrajectory::move_to(double deg, double speed)
+{
+    std::promise<bool> done;
+    std::future<bool> f = done.get_future();
+
+    std::lock_guard<std::mutex> lock(_request_mutex);
+    if (_request && _request->done) {
+        _request->done->set_value(false);
+    }
+    _request = Request { Position, deg, speed, std::move(done) };
+    return f;
+}
+
+void JointTrajectory::cancel()
+{
+    std::lock_guard<std::mutex> io_lock(_io_mutex);
+    {
+        std::lock_guard<std::mutex> lock(_request_mutex);
+        if (_request && _request->done) {
+            _request->done->set_value(false);
+        }
+        _request.reset();
+    }
+    finish(false);
+    _mode = Idle;
+    _pending_velocity.reset();
+}
+
+void JointTrajectory::tick(double dt, clock::time_point now)
+{
+    std::lock_guard<std::mutex> io_lock(_io_mutex);
+
+    std::optional<Request> request;
+    {
+        std::lock_guard<std::mutex> lock(_request_mutex);
+        request.swap(_request);
+    }
+
+    try {
+        if (request) {
+            apply(*request, now);
+        }
+
+        if (_mode == Velocity) {
+            stream_velocity(dt);
+        } else if (_mode == Position) {
+            check_move_done(now);
+        }
+    } catch (std::exception& e) {
+        abort(e);
+    }
+}
+
+void JointTrajectory::flush(JointTrajectory& trajectory)
+{
+    std::lock_guard<std::mutex> io_lock(trajectory._io_mutex);
+    if (!trajectory._pending_velocity) {
+        return;
+    }
+
+    double v = *trajectory._pending_velocity;
+    trajectory._pending_velocity.reset();
+    try {
+        trajectory._actuator.command_velocity(v);
+    } catch (std::exception& e) {
+        trajectory.abort(e);
+    }
+}
+
+void JointTrajectory::flush(JointTrajectory& a, JointTrajectory& b)
+{
+    {
+        std::scoped_lock io_lock(a._io_mutex, b._io_mutex);
+        if (a._pending_velocity && b._pending_velocity) {
+            double va = *a._pending_velocity, vb = *b._pending_velocity;
+            a._pending_velocity.reset();
+            b._pending_velocity.reset();
+            try {
+                SynchronizedAxes::command_velocities(a._actuator, va, b._actuator, vb);
+            } catch (std::exception& e) {
+                a.abort(e);
+                b.abort(e);
+            }
+            return;
+        }
+    }
+
+    flush(a);
+    flush(b);
+}
+
+void JointTrajectory::apply(Request& request, clock::time_point now)
+{
+    double a_max = _actuator._incs_per_deg > 0 ? static_cast<double>(_actuator._acc) / _actuator._incs_per_deg : 0.;
+    if (a_max <= 0.) {
+        warning() << "Trajectory ignored, actuator acceleration is not configured";
+        if (request.done) {
+            request.done->set_value(false);
+        }
+        return;
+    }
+
+    // The profile is only continuous within a mode, a new mode starts from where the joint is
+    bool mode_change = request.mode != _mode;
+
+    if (request.mode == Velocity) {
+        if (mode_change) {
+            sync_state();
+            _last_sent_velocity = _profile.vel();
+        }
+        if (_mode == Position) {
+            finish(false);
+            // Replaces the position commands still queued on the RoboClaw
+            _pending_velocity = _profile.vel();
+        }
+        _profile.set_limits(std::fabs(request.value), a_max, jerk_ratio * a_max);
+        _velocity_target = request.value;
+        _mode = Velocity;
+        return;
+    }
+
+    double target = request.value;
+    if (_actuator.has_position_limits()) {
+        target = std::clamp(target, _actuator._min_angle, _actuator._max_angle);
+    }
+
+    // A repeated request for the move in progress only adds a waiter
+    if (_mode == Position && std::fabs(target - _move_target) < .05 && std::fabs(request.speed - _move_speed) <= .05 * _move_speed) {
+        _move_promises.push_back(std::move(*request.done));
+        return;
+    }
+
+    finish(false);
+    _move_promises.push_back(std::move(*request.done));
+
+    // Streaming callers change the target of the move in progress every tick
+    if (_mode == Position) {
+        retarget(target, std::fabs(request.speed), a_max, now);
+        return;
+    }
+
+    if (mode_change) {
+        sync_state();
+    }
+    _profile.set_limits(std::max(std::fabs(request.speed), std::fabs(_profile.vel())), a_max, jerk_ratio * a_max);
+    start_move(target, std::fabs(request.speed), now);
+}
+
+void JointTrajectory::start_move(double target, double speed, clock::time_point now)
+{
+    double incs = _actuator._incs_per_deg;
+    double duration_s;
+    std::vector<Trajectory::Segment> segments = Trajectory::plan_move(_profile, target, speed, segment_s, max_segments, duration_s);
+
+    bool buffered = false;
+    for (const Trajectory::Segment& s : segments) {
+        _actuator.RC::RoboClaw::move_distance(std::max(1u, static_cast<uint32_t>(std::round(s.accel * incs))),
+            static_cast<int32_t>(std::round(s.speed * incs)),
+            static_cast<uint32_t>(std::round(s.distance * incs)), buffered);
+        buffered = true;
+    }
+
+    // Final position command removes the accumulated rounding of the segments
+    uint32_t settle_speed = std::max(1u, static_cast<uint32_t>(std::round(.25 * speed * incs)));
+    _actuator.RC::RoboClaw::move_to(_actuator._acc, settle_speed, _actuator._acc, static_cast<int32_t>(std::round(target * incs)), buffered);
+
+    _profile.reset(target);
+    _mode = Position;
+    _move_target = target;
+    _move_speed = speed;
+    _move_end = now + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(duration_s));
+    _move_deadline = _move_end + std::chrono::seconds(2) + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(.5 * duration_s));
+}
+
+void JointTrajectory::retarget(double target, double speed, double a_max, clock::time_point now)
+{
+    // A single unbuffered position command replaces the queued segments
+    double incs = _actuator._incs_per_deg;
+    _actuator.RC::RoboClaw::move_to(_actuator._acc, std::max(1u, static_cast<uint32_t>(std::round(speed * incs))), _actuator._acc, static_cast<int32_t>(std::round(target * incs)));
+
+    double duration_s = std::fabs(target - _move_target) / speed + speed / a_max;
+    _profile.reset(target);
+    _move_target = target;
+    _move_speed = speed;
+    _move_end = std::max(_move_end, now + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(duration_s)));
+    _move_deadline = _move_end + std::chrono::seconds(2) + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(.5 * duration_s));
+}
+
+void JointTrajectory::stream_velocity(double dt)
+{
+    _profile.track_velocity(_velocity_target, dt);
+    double v = _profile.vel();
+
+    double deadband = std::max(.5, .05 * std::fabs(_velocity_target));
+    bool settled = v == _velocity_target;
+    if (std::fabs(v - _last_sent_velocity) >= deadband || (settled && v != _last_sent_velocity)) {
+        _pending_velocity = v;
+        _last_sent_velocity = v;
+    }
+
+    if (settled && v == 0.) {
+        _mode = Idle;
+    }
+}
+
+void JointTrajectory::check_move_done(clock::time_point now)
+{
+    if (now < _move_end) {
+        return;
+    }
+
+    // The cached buffer length is only meaningful once sampled after the planned end
+    JointState s = _actuator.state();
+    uint8_t buffer;
+    if (_actuator.is_fresh(s) && s.stamp > _move_end) {
+        buffer = s.buffer;
+    } else if (now > _move_end + std::chrono::milliseconds(200)) {
+        // A failed read is retried on the next tick, until the deadline
+        RC::Result<uint8_t> length = _actuator.try_read_buffer_length();
+        buffer = length.value_or(0);
+    } else {
+        return;
+    }
+
+    if (buffer == RC::RoboClaw::buffer_idle) {
+        finish(true);
+        _mode = Idle;
+    } else if (now > _move_deadline) {
+        warning() << "Move to" << _move_target << "deg did not complete in time";
+        finish(false);
+        _mode = Idle;
+    }
+}
+
+void JointTrajectory::sync_state()
+{
+    JointState s = _actuator.state();
+    if (_actuator.is_fresh(s)) {
+        _profile.reset(static_cast<double>(s.encoder_position) / _actuator._incs_per_deg, static_cast<double>(s.encoder_speed) / _actuator._incs_per_deg);
+    } else {
+        _profile.reset(_actuator.pos(), _actuator.speed());
+    }
+}
+
+void JointTrajectory::abort(const std::exception& e)
+{
+    warning() << "Trajectory aborted:" << e.what();
+    finish(false);
+    _mode = Idle;
+    _pending_velocity.reset();
+}
+
+void JointTrajectory::finish(bool success)
+{
+    for (auto& p : _move_promises) {
+        p.set_value(success);
+    }
+    _move_promises.clear();
+}
@@ -0,0 +1,131 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+class Actuator;
+
+namespace Trajectory {
+
+/**
+ * \brief Online jerk-limited motion profile, in degrees.
+ *
+ * Acceleration changes at most by the jerk limit and is ramped down ahead of
+ * the target velocity, so velocity and position are smooth.
+ */
+class Profile {
+public:
+    Profile();
+
+    void set_limits(double v_max, double a_max, double j_max);
+    void reset(double pos, double vel = 0.);
+    void set_state(double pos, double vel, double acc);
+
+    void track_velocity(double v_target, double dt);
+    bool settled(double v_target) const;
+
+    double pos() const { return _pos; }
+    double vel() const { return _vel; }
+    double acc() const { return _acc; }
+
+private:
+    double _v_max;
+    double _a_max;
+    double _j_max;
+
+    double _pos;
+    double _vel;
+    double _acc;
+};
+
+struct Segment {
+    double accel; // deg/s^2, reached speed at the end of the segment
+    double speed; // deg/s, signed
+    double distance; // deg, unsigned
+};
+
+std::vector<Segment> plan_move(Profile profile, double target, double v_max, double segment_s, std::size_t max_segments, double& duration_s);
+
+}
+
+/**
+ * \brief Streams the trajectory of one actuator.
+ *
+ * Velocity targets are followed with a jerk-limited profile and only sent to
+ * the RoboClaw when the command changes by more than a deadband. Position
+ * moves are planned once and queued as buffered speed/accel/distance segments
+ * followed by a buffered position command; their completion is reported
+ * through a future instead of polling the encoder. A new target received while
+ * a move runs is sent as a single position command, without replanning.
+ *
+ * Requests never touch the serial bus, TrajectoryGenerator applies them.
+ * Velocity commands are staged by tick() and sent by flush(), in one mixed
+ * frame when both channels of a RoboClaw stream a velocity.
+ */
+class JointTrajectory {
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit JointTrajectory(Actuator& actuator);
+    ~JointTrajectory();
+
+    void set_velocity(double deg_s);
+    std::future<bool> move_to(double deg, double speed);
+    void cancel();
+
+    void tick(double dt, clock::time_point now);
+    static void flush(JointTrajectory& trajectory);
+    static void flush(JointTrajectory& a, JointTrajectory& b);
+
+    Actuator& actuator() { return _actuator; }
+
+    static constexpr double jerk_ratio = 10.; // j_max = jerk_ratio * a_max
+    static constexpr double segment_s = 0.05;
+    static const std::size_t max_segments = 24;
+
+private:
+    enum Mode {
+        Idle,
+        Velocity,
+        Position
+    };
+
+    struct Request {
+        Mode mode;
+        double value;
+        double speed;
+        std::optional<std::promise<bool>> done;
+    };
+
+    void apply(Request& request, clock::time_point now);
+    void start_move(double target, double speed, clock::time_point now);
+    void retarget(double target, double speed, double a_max, clock::time_point now);
+    void stream_velocity(double dt);
+    void check_move_done(clock::time_point now);
+    void sync_state();
+    void finish(bool success);
+    void abort(const std::exception& e);
+
+    Actuator& _actuator;
+    Trajectory::Profile _profile;
+
+    std::mutex _request_mutex;
+    std::optional<Request> _request;
+
+    std::mutex _io_mutex;
+    Mode _mode;
+    double _velocity_target;
+    double _last_sent_velocity;
+    std::optional<double> _pending_velocity;
+    double _move_target;
+    double _move_speed;
+    clock::time_point _move_end;
+    clock::time_point _move_deadline;
+    std::vector<std::promise<bool>> _move_promises;
+};
+
+#endif // TRAJECTORY_H
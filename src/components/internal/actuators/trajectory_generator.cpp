@@ -0,0 +1,79 @@
+#include "trajectory_generator.h"
+#include "synchronized_axes.h"
+#include "trajectory.h"
+#include <algorithm>
+#include <map>
+
+TrajectoryGenerator::TrajectoryGenerator()
+    : ThreadedLoop("trajectory_generator", 0.01)
+{
+    supervise(std::chrono::milliseconds(100), Supervisor::SafeStop, true);
+
+    _menu->set_description("Trajectory generator");
+    _menu->set_code("trajectory");
+
+    start();
+}
+
+TrajectoryGenerator::~TrajectoryGenerator()
+{
+    stop_and_join();
+}
+
+TrajectoryGenerator& TrajectoryGenerator::instance()
+{
+    static TrajectoryGenerator g;
+    return g;
+}
+
+void TrajectoryGenerator::add(JointTrajectory* trajectory)
+{
+    std::lock_guard<std::mutex> lock(_trajectories_mutex);
+    if (std::find(_trajectories.begin(), _trajectories.end(), trajectory) == _trajectories.end()) {
+        _trajectories.push_back(trajectory);
+        regroup();
+    }
+}
+
+void TrajectoryGenerator::remove(JointTrajectory* trajectory)
+{
+    std::lock_guard<std::mutex> lock(_trajectories_mutex);
+    _trajectories.erase(std::remove(_trajectories.begin(), _trajectories.end(), trajectory), _trajectories.end());
+    regroup();
+}
+
+void TrajectoryGenerator::regroup()
+{
+    std::map<std::pair<std::string, uint8_t>, std::vector<JointTrajectory*>> controllers;
+    for (JointTrajectory* t : _trajectories) {
+        controllers[std::make_pair(t->actuator().port_name(), t->actuator().address())].push_back(t);
+    }
+
+    _groups.clear();
+    for (auto& c : controllers) {
+        std::vector<JointTrajectory*>& group = c.second;
+        if (group.size() == 2 && SynchronizedAxes::share_controller(group[0]->actuator(), group[1]->actuator())) {
+            _groups.push_back(group);
+            continue;
+        }
+        for (JointTrajectory* t : group) {
+            _groups.push_back({ t });
+        }
+    }
+}
+
+void TrajectoryGenerator::loop(double dt, clock::time_point time)
+{
+    std::lock_guard<std::mutex> lock(_trajectories_mutex);
+    for (JointTrajectory* t : _trajectories) {
+        t->tick(dt, time);
+    }
+
+    for (std::vector<JointTrajectory*>& group : _groups) {
+        if (group.size() == 2) {
+            JointTrajectory::flush(*group[0], *group[1]);
+        } else {
+            JointTrajectory::flush(*group[0]);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef TRAJECTORY_GENERATOR_H
+#define TRAJECTORY_GENERATOR_H
+
+#include "utils/threaded_loop.h"
+#include <vector>
+
+class JointTrajectory;
+
+/**
+ * \brief Steps the trajectory of every actuator from a single thread.
+ *
+ * Controllers only post targets; all the RoboClaw traffic produced by the
+ * trajectories happens here, at the loop rate. Actuators are added once they
+ * are connected, so their controllers are known.
+ */
+class TrajectoryGenerator : public ThreadedLoop {
+public:
+    static TrajectoryGenerator& instance();
+
+    void add(JointTrajectory* trajectory);
+    void remove(JointTrajectory* trajectory);
+
+private:
+    TrajectoryGenerator();
+    ~TrajectoryGenerator() override;
+
+    void loop(double dt, clock::time_point time) override;
+    void regroup();
+
+    std::vector<JointTrajectory*> _trajectories;
+    // Trajectories flushed together, the two channels of a RoboClaw share a frame
+    std::vector<std::vector<JointTrajectory*>> _groups;
+    std::mutex _trajectories_mutex;
+};
+
+#endif // TRAJECTORY_GENERATOR_H
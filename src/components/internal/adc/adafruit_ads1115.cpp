@@ -1,28 +1,11 @@
-extern "C" {
-#include <i2c/smbus.h>
-}
-
 #include "adafruit_ads1115.h"
 #include "utils/log/log.h"
-#include <cstring>
-#include <fcntl.h>
-#include <linux/i2c-dev.h>
-#include <sys/errno.h>
-#include <sys/ioctl.h>
 #include <time.h>
 #include <unistd.h>
 
 Adafruit_ADS1015::Adafruit_ADS1015(const char* deviceName, uint8_t i2cAddress)
+    : _bus(I2C::Bus::open(deviceName))
 {
-    fd = open(deviceName, O_RDWR);
-    if (fd == -1) {
-        critical() << "ADS1115 ERROR : Failed to open I2C device " << deviceName << ". Error " << errno << ": " << strerror(errno);
-    } else {
-        info() << "### ADS1115 : Open device " << deviceName;
-    }
-    if (ioctl(fd, I2C_SLAVE, i2cAddress) == -1) {
-        critical() << "ADS1115 ERROR : Failed to set address " << i2cAddress << ". Error " << errno << ": " << strerror(errno);
-    }
     m_i2cAddress = i2cAddress;
     m_conversionDelay = ADS1015_CONVERSIONDELAY;
     m_bitShift = 4;
@@ -41,21 +24,54 @@ Adafruit_ADS1115::Adafruit_ADS1115(const char* deviceName, uint8_t i2cAddress)
 
 void Adafruit_ADS1015::writeRegister(uint8_t reg, uint16_t value)
 {
-    buf[0] = (uint8_t)reg;
-    buf[1] = (uint8_t)(value >> 8);
-    buf[2] = (uint8_t)(value & 0xFF);
-    write(fd, buf, 3);
+    I2C::Transaction t;
+    t.write(m_i2cAddress, { reg, (uint8_t)(value >> 8), (uint8_t)(value & 0xFF) });
+    _bus.transfer(t);
 }
 
 uint16_t Adafruit_ADS1015::readRegister(uint8_t reg)
 {
-    uint8_t b1, b2;
-    write(fd, ADS1015_REG_POINTER_CONVERT, 1);
-    i2c_smbus_read_word_data(fd, reg);
-    uint16_t value = i2c_smbus_read_word_data(fd, reg);
-    b1 = (uint8_t)(value & 0xFF);
-    b2 = (uint8_t)(value >> 8);
-    return (((b1 << 8) | b2) + 1);
+    // Pointer write and read in one transfer
+    I2C::Transaction t;
+    t.write(m_i2cAddress, { reg }).read(m_i2cAddress, 2);
+    if (!_bus.transfer(t)) {
+        return 0;
+    }
+    return t.read_u16(0) + 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads the conversion register in a single transfer, without
+            touching the configuration.
+*/
+/**************************************************************************/
+int16_t Adafruit_ADS1015::readConversion()
+{
+    I2C::Transaction t;
+    t.write(m_i2cAddress, { ADS1015_REG_POINTER_CONVERT }).read(m_i2cAddress, 2);
+    if (!_bus.transfer(t)) {
+        return 0;
+    }
+    return static_cast<int16_t>(t.read_u16(0)) >> m_bitShift;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Reads the conversion register, then writes the config register
+            to start the next conversion of a scan. The Pi I2C controller
+            only accepts a read as the last message of a transfer, so this
+            takes two transfers.
+*/
+/**************************************************************************/
+int16_t Adafruit_ADS1015::readConversionAndConfigure(uint16_t config)
+{
+    int16_t value = readConversion();
+
+    I2C::Transaction t;
+    t.write(m_i2cAddress, { ADS1015_REG_POINTER_CONFIG, (uint8_t)(config >> 8), (uint8_t)(config & 0xFF) });
+    _bus.transfer(t);
+    return value;
 }
 
 void Adafruit_ADS1015::setGain(adsGain_t gain)
@@ -1,3 +1,7 @@
+#ifndef ADAFRUIT_ADS1115_H
+#define ADAFRUIT_ADS1115_H
+
+#include "utils/i2c/i2c_bus.h"
 #include <stdint.h>
 
 /*=========================================================================
@@ -104,6 +108,8 @@ public:
     Adafruit_ADS1015(const char* deviceName, uint8_t i2cAddress);
     void writeRegister(uint8_t reg, uint16_t value);
     uint16_t readRegister(uint8_t reg);
+    int16_t readConversion();
+    int16_t readConversionAndConfigure(uint16_t config);
     uint16_t readADC_SingleEnded(uint8_t channel);
     int16_t readADC_Differential_0_1(void);
     int16_t readADC_Differential_2_3(void);
@@ -113,8 +119,7 @@ public:
     adsGain_t getGain(void);
 
 private:
-    int fd;
-    uint8_t buf[10];
+    I2C::Bus& _bus;
 };
 
 // Derive from ADS1105 & override construction to set properties
@@ -124,3 +129,5 @@ public:
 
 private:
 };
+
+#endif // ADAFRUIT_ADS1115_H
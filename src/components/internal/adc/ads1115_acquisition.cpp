@@ -0,0 +1,262 @@
+#include "ads1115_acquisition.h"
+#include "utils/log/log.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+// Conversions per second of the ADS1115 for each value of the DR field
+const std::array<int, 8> ads1115_rates = { 8, 16, 32, 64, 128, 250, 475, 860 };
+
+// The internal oscillator is only accurate to 10%
+const double oscillator_margin = 1.1;
+}
+
+ADS1115Acquisition::ADS1115Acquisition(Adafruit_ADS1115& adc, std::string name)
+    : Worker("ads1115_acq", Worker::Continuous)
+    , NamedObject(name)
+    , MenuUser("adc", "ADS1115 acquisition")
+    , _adc(adc)
+    , _channels("channels", BaseParam::ReadWrite, this, 0x3)
+    , _data_rate("data_rate", BaseParam::ReadWrite, this, 860)
+    , _ready_pin("ready_pin", BaseParam::ReadWrite, this, -1)
+    , _users(0)
+    , _buffering(false)
+    , _configured(false)
+    , _config(0)
+    , _lsb_volts(0.)
+    , _period(0)
+    , _conversion_time(0)
+    , _sample_rate(0.)
+    , _ready_timeouts(0)
+{
+    for (auto& o : _overruns) {
+        o = 0;
+    }
+
+    _menu->add_item("s", "Show acquisition status", [this](std::string) { show_status(); });
+    _menu->add_item("start", "Start acquisition", [this](std::string) { start(); });
+    _menu->add_item("pause", "Pause acquisition", [this](std::string) { pause(); });
+
+    do_work();
+}
+
+ADS1115Acquisition::~ADS1115Acquisition()
+{
+    _users = 0;
+    stop();
+    if (_configured) {
+        _adc.writeRegister(ADS1015_REG_POINTER_CONFIG, _config | ADS1015_REG_CONFIG_MODE_SINGLE);
+    }
+}
+
+void ADS1115Acquisition::start()
+{
+    ++_users;
+}
+
+void ADS1115Acquisition::pause()
+{
+    int users = _users;
+    while (users > 0 && !_users.compare_exchange_weak(users, users - 1)) {
+    }
+}
+
+void ADS1115Acquisition::set_buffering(bool enabled)
+{
+    if (enabled && !_buffering) {
+        for (auto& b : _buffers) {
+            b.clear();
+        }
+    }
+    _buffering = enabled;
+}
+
+ADS1115Acquisition::Sample ADS1115Acquisition::latest(int channel) const
+{
+    return _latest[channel].load();
+}
+
+std::size_t ADS1115Acquisition::read(int channel, Sample* samples, std::size_t max)
+{
+    return _buffers[channel].pop(samples, max);
+}
+
+uint32_t ADS1115Acquisition::overruns(int channel) const
+{
+    return _overruns[channel];
+}
+
+void ADS1115Acquisition::show_status()
+{
+    info() << "ADS1115 acquisition " << (running() ? "running" : "paused") << ", " << _sample_rate << " Hz per channel, "
+           << (_ready ? "ALERT/RDY on GPIO " + std::to_string(_ready->pin()) : std::string("timed conversions"));
+    for (int ch = 0; ch < channel_count; ++ch) {
+        Sample s = latest(ch);
+        if (s.stamp == clock::time_point()) {
+            continue;
+        }
+        info() << "AIN" << ch << ": " << s.volts << " V (" << s.raw << "), " << _buffers[ch].size() << " buffered, " << overruns(ch) << " overruns";
+    }
+    if (_ready_timeouts) {
+        info() << _ready_timeouts << " conversions without ALERT/RDY edge";
+    }
+}
+
+void ADS1115Acquisition::work()
+{
+    if (!running()) {
+        if (_configured) {
+            _adc.writeRegister(ADS1015_REG_POINTER_CONFIG, _config | ADS1015_REG_CONFIG_MODE_SINGLE);
+            _configured = false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return;
+    }
+
+    if (!_configured || _channels.changed() || _data_rate.changed() || _ready_pin.changed()) {
+        configure();
+    }
+
+    if (_scan.empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    } else if (_scan.size() == 1) {
+        convert_continuous();
+    } else {
+        scan();
+    }
+}
+
+void ADS1115Acquisition::configure()
+{
+    _configured = true;
+
+    int mask = _channels;
+    _scan.clear();
+    for (int ch = 0; ch < channel_count; ++ch) {
+        if (mask & (1 << ch)) {
+            _scan.push_back(ch);
+        }
+    }
+
+    int sps = 0;
+    uint16_t dr = data_rate_bits(_data_rate, sps);
+    _period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1. / sps));
+    _conversion_time = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(oscillator_margin / sps));
+
+    adsGain_t gain = _adc.getGain();
+    _lsb_volts = full_scale(gain) / 32768.;
+
+    // ALERT/RDY pulses at the end of every conversion when the MSB of the
+    // high threshold is set and the one of the low threshold is cleared
+    _config = ADS1015_REG_CONFIG_CQUE_1CONV | ADS1015_REG_CONFIG_CLAT_NONLAT | ADS1015_REG_CONFIG_CPOL_ACTVLOW | ADS1015_REG_CONFIG_CMODE_TRAD | dr | gain;
+    _adc.writeRegister(ADS1015_REG_POINTER_HITHRESH, 0x8000);
+    _adc.writeRegister(ADS1015_REG_POINTER_LOWTHRESH, 0x0000);
+
+    _ready.reset();
+    int pin = _ready_pin;
+    if (pin >= 0) {
+        try {
+            _ready = std::make_unique<GPIOEdge>(pin, GPIOEdge::Falling, "ads1115_rdy");
+        } catch (std::exception& e) {
+            warning() << "ADS1115 acquisition: " << e.what() << ", falling back to timed conversions";
+        }
+    }
+
+    if (_scan.size() == 1) {
+        _adc.writeRegister(ADS1015_REG_POINTER_CONFIG, _config | ADS1015_REG_CONFIG_MODE_CONTIN | mux(_scan[0]));
+        _next = clock::now() + _conversion_time;
+    } else if (!_scan.empty()) {
+        _adc.writeRegister(ADS1015_REG_POINTER_CONFIG, _config | ADS1015_REG_CONFIG_OS_SINGLE | ADS1015_REG_CONFIG_MODE_SINGLE | mux(_scan[0]));
+        _next = clock::now() + _conversion_time;
+    }
+    while (_ready && _ready->wait(std::chrono::microseconds(0))) {
+    }
+
+    _sample_rate = _scan.empty() ? 0. : static_cast<double>(sps) / _scan.size();
+    info() << "ADS1115 acquisition: " << _scan.size() << " channels at " << sps << " SPS";
+}
+
+void ADS1115Acquisition::convert_continuous()
+{
+    clock::time_point stamp = wait_conversion(_next);
+    store(_scan[0], _adc.readConversion(), stamp);
+
+    // Follow the ADC clock when its edges are seen
+    _next = (_ready ? stamp : _next) + _period;
+    clock::time_point now = clock::now();
+    if (_next < now) {
+        _next = now + _period;
+    }
+}
+
+void ADS1115Acquisition::scan()
+{
+    // Read each conversion and start the one of the next channel right after
+    for (std::size_t i = 0; i < _scan.size(); ++i) {
+        clock::time_point stamp = wait_conversion(_next);
+        int next_channel = _scan[(i + 1) % _scan.size()];
+        int16_t raw = _adc.readConversionAndConfigure(_config | ADS1015_REG_CONFIG_OS_SINGLE | ADS1015_REG_CONFIG_MODE_SINGLE | mux(next_channel));
+        _next = clock::now() + _conversion_time;
+        store(_scan[i], raw, stamp);
+    }
+}
+
+ADS1115Acquisition::clock::time_point ADS1115Acquisition::wait_conversion(clock::time_point deadline)
+{
+    if (!_ready) {
+        std::this_thread::sleep_until(deadline);
+        return clock::now();
+    }
+
+    // Give the edge one more period before reading anyway
+    auto timeout = std::chrono::duration_cast<std::chrono::microseconds>(deadline + _period - clock::now());
+    std::optional<GPIOEdge::Event> edge = _ready->wait(std::max(timeout, std::chrono::microseconds(0)));
+    if (!edge) {
+        ++_ready_timeouts;
+        return clock::now();
+    }
+    return edge->stamp;
+}
+
+void ADS1115Acquisition::store(int channel, int16_t raw, clock::time_point stamp)
+{
+    Sample s { stamp, raw, static_cast<float>(raw * _lsb_volts) };
+    _latest[channel].store(s);
+    if (_buffering && !_buffers[channel].push(s)) {
+        ++_overruns[channel];
+    }
+}
+
+uint16_t ADS1115Acquisition::mux(int channel)
+{
+    return static_cast<uint16_t>(ADS1015_REG_CONFIG_MUX_SINGLE_0 + (channel << 12));
+}
+
+uint16_t ADS1115Acquisition::data_rate_bits(int sps, int& actual_sps)
+{
+    std::size_t i = 0;
+    while (i < ads1115_rates.size() - 1 && ads1115_rates[i] < sps) {
+        ++i;
+    }
+    actual_sps = ads1115_rates[i];
+    return static_cast<uint16_t>(i << 5);
+}
+
+double ADS1115Acquisition::full_scale(adsGain_t gain)
+{
+    switch (gain) {
+    case GAIN_TWOTHIRDS:
+        return 6.144;
+    case GAIN_ONE:
+        return 4.096;
+    case GAIN_TWO:
+        return 2.048;
+    case GAIN_FOUR:
+        return 1.024;
+    case GAIN_EIGHT:
+        return 0.512;
+    case GAIN_SIXTEEN:
+        return 0.256;
+    }
+    return 6.144;
+}
@@ -0,0 +1,103 @@
+#ifndef ADS1115_ACQUISITION_H
+#define ADS1115_ACQUISITION_H
+
+#include "adafruit_ads1115.h"
+#include "components/internal/gpio/gpio_edge.h"
+#include "utils/interfaces/menu_user.h"
+#include "utils/named_object.h"
+#include "utils/param.h"
+#include "utils/ring_buffer.h"
+#include "utils/seqlock.h"
+#include "utils/worker.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * \brief Background acquisition of the ADS1115 single-ended channels.
+ *
+ * A single channel is converted continuously. Several channels are scanned
+ * with one single-shot conversion each, the multiplexer being switched
+ * between them. The end of a conversion is given by the ALERT/RDY pin when
+ * ready_pin is wired, otherwise the engine sleeps for the conversion time.
+ *
+ * Conversions only run between start() and pause(), which are counted so
+ * that each consumer starts and pauses the acquisition for itself.
+ *
+ * Samples are timestamped at the end of their conversion. The latest sample
+ * of each channel can be read from any thread. A consumer that needs every
+ * sample enables buffering, then samples are also pushed into a ring buffer
+ * per channel that it must drain with read(). While it runs, the engine owns
+ * the ADC: the blocking readADC_* calls must not be used.
+ */
+class ADS1115Acquisition : public Worker, public NamedObject, public MenuUser {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Sample {
+        clock::time_point stamp;
+        int16_t raw;
+        float volts;
+    };
+
+    static const int channel_count = 4;
+    static const std::size_t buffer_size = 1024;
+
+    ADS1115Acquisition(Adafruit_ADS1115& adc, std::string name = "adc_acquisition");
+    ~ADS1115Acquisition() override;
+
+    void start();
+    void pause();
+    bool running() const { return _users > 0; }
+
+    // Any thread, a null stamp when the channel has not been sampled yet
+    Sample latest(int channel) const;
+    // Only one consumer per channel, which drains the buffer continuously
+    void set_buffering(bool enabled);
+    std::size_t read(int channel, Sample* samples, std::size_t max);
+    uint32_t overruns(int channel) const;
+
+    // Per channel, in Hz
+    double sample_rate() const { return _sample_rate; }
+
+    void show_status();
+
+private:
+    void work() override;
+
+    void configure();
+    void convert_continuous();
+    void scan();
+    clock::time_point wait_conversion(clock::time_point deadline);
+    void store(int channel, int16_t raw, clock::time_point stamp);
+
+    static uint16_t mux(int channel);
+    static uint16_t data_rate_bits(int sps, int& actual_sps);
+    static double full_scale(adsGain_t gain);
+
+    Adafruit_ADS1115& _adc;
+
+    Param<int> _channels; // bit mask of AIN0..AIN3
+    Param<int> _data_rate; // conversions per second, rounded up to the ADS1115 rates
+    Param<int> _ready_pin; // GPIO wired to ALERT/RDY, -1 if none
+
+    std::atomic<int> _users;
+    std::atomic<bool> _buffering;
+    bool _configured;
+    std::vector<int> _scan;
+    uint16_t _config;
+    double _lsb_volts;
+    clock::duration _period;
+    clock::duration _conversion_time;
+    clock::time_point _next;
+    std::unique_ptr<GPIOEdge> _ready;
+    std::atomic<double> _sample_rate;
+
+    std::array<RingBuffer<Sample, buffer_size>, channel_count> _buffers;
+    std::array<SeqLock<Sample>, channel_count> _latest;
+    std::array<std::atomic<uint32_t>, channel_count> _overruns;
+    std::atomic<uint32_t> _ready_timeouts;
+};
+
+#endif // ADS1115_ACQUISITION_H
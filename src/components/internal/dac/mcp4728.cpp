@@ -1,18 +1,7 @@
 #include "mcp4728.h"
 #include "utils/log/log.h"
-#include <cstring>
-#include <fcntl.h>
-#include <linux/i2c-dev.h>
+#include <bitset>
 #include <string>
-#include <sys/errno.h>
-#include <sys/ioctl.h>
-#include <sys/types.h>
-#include <termios.h>
-#include <unistd.h>
-
-extern "C" {
-#include <i2c/smbus.h>
-}
 
 #define BYTE_TO_BINARY_PATTERN "%c%c%c%c%c%c%c%c"
 #define BYTE_TO_BINARY(byte)       \
@@ -59,16 +48,10 @@ Constructor.
 Creates class object. Initialize buffers
 */
 MCP4728::MCP4728(const char* deviceName, uint8_t i2cAddress)
+    : _bus(I2C::Bus::open(deviceName))
+    , _dev_address(i2cAddress)
 {
-    _i2cPort = open(deviceName, O_RDWR);
-    if (_i2cPort == -1) {
-        critical() << "MCP4728 ERROR : Failed to open I2C device " << deviceName << ". Error " << errno << ": " << strerror(errno);
-    } else {
-        debug() << "### MCP4728 : Open device " << deviceName;
-    }
-    if (ioctl(_i2cPort, I2C_SLAVE, i2cAddress) == -1) {
-        critical() << "MCP4728 ERROR : Failed to set address " << i2cAddress << ". Error " << errno << ": " << strerror(errno);
-    }
+    debug() << "### MCP4728 : Open device " << deviceName;
 
     _vdd = defaultVDD;
     getStatus();
@@ -76,9 +59,6 @@ MCP4728::MCP4728(const char* deviceName, uint8_t i2cAddress)
 
 MCP4728::~MCP4728()
 {
-    if (_i2cPort != -1) {
-        close(_i2cPort);
-    }
 }
 
 /*
@@ -86,24 +66,24 @@ Specific Call Reset of MCP4728 - EEPROM value will loaded to input register. ref
 */
 void MCP4728::reset()
 {
-    i2c_smbus_write_byte(_i2cPort, RESET);
+    command(RESET);
 }
 /*
 Specific Call Wake-Up of MCP4728 - Reset Power-Down bits (PD0,PD1 = 0,0). refer to DATASHEET 5.4.2
 */
 void MCP4728::wake()
 {
-    i2c_smbus_write_byte(_i2cPort, WAKE);
+    command(WAKE);
 }
 /*
 Specific Call Software update of MCP4728 - All DAC ouput update. refer to DATASHEET 5.4.3
 */
 void MCP4728::update()
 {
-    i2c_smbus_write_byte(_i2cPort, UPDATE);
+    command(UPDATE);
 }
 /*
-Write input register values to each channel using fastwrite method.
+Write input register values to each channel, without waiting for the bus.
 Values : 0-4095
 */
 void MCP4728::analogWrite(uint16_t value1, uint16_t value2, uint16_t value3, uint16_t value4)
@@ -116,12 +96,11 @@ void MCP4728::analogWrite(uint16_t value1, uint16_t value2, uint16_t value3, uin
         _values[2] = value3;
         _values[3] = value4;
         debug() << "### MCP4728 Analog write:" << _values[0] << " " << _values[1] << " " << _values[2] << " " << _values[3];
-        fastWrite();
     }
-    update();
+    writeInputs(0B1111, true);
 }
 /*
-Write input resister value to specified channel using fastwrite method.
+Write input resister value to specified channel, without waiting for the bus.
 Channel : 0-3, Values : 0-4095
 */
 void MCP4728::analogWrite(uint8_t channel, uint16_t value)
@@ -131,7 +110,7 @@ void MCP4728::analogWrite(uint8_t channel, uint16_t value)
         value = 4095;
     }
     _values[channel] = value;
-    fastWrite();
+    writeInputs(1 << channel, false);
 }
 /*
 Write a value to specified channel using singlewrite method.
@@ -373,10 +352,10 @@ void MCP4728::getStatus()
 {
     errno = 0;
     debug("### MCP4728 : reading all registers...");
-    tcflush(_i2cPort, TCIFLUSH);
-
-    int readBytes = read(_i2cPort, _buf, 24);
-    if (readBytes == 24) {
+    I2C::Transaction t;
+    t.read(_dev_address, 24);
+    if (_bus.transfer(t)) {
+        std::copy_n(t.read_data(0), 24, _buf);
         debug() << "### MCP4728 : status : " << _buf;
         for (uint8_t seq = 0; seq < 8; seq++) {
             uint8_t deviceID = _buf[seq * 3];
@@ -398,31 +377,69 @@ void MCP4728::getStatus()
             }
         }
     } else {
-        critical() << "MCP4728 ERROR reading registers: " << readBytes << " byte(s) read | error " << errno << " - " << strerror(errno);
+        critical() << "MCP4728 ERROR reading registers";
     }
 }
 /*
+Specific Call command, sent as a single byte
+*/
+void MCP4728::command(uint8_t cmd)
+{
+    I2C::Transaction t;
+    t.write(_dev_address, { cmd });
+    _bus.transfer(t);
+}
+/*
+Queue the input register values of the given channels (bit mask), followed by a
+software update if requested, in one transfer.
+FastWrite sends all channels in 8 bytes, MultiWrite 3 bytes per channel: the
+shortest one is used.
+*/
+void MCP4728::writeInputs(uint8_t channels, bool update)
+{
+    I2C::Transaction t;
+    if (std::bitset<4>(channels).count() * 3 < 8) {
+        multiWrite(t, channels);
+    } else {
+        fastWrite(t);
+    }
+    if (update) {
+        t.write(_dev_address, { UPDATE });
+    }
+    _bus.submit(std::move(t));
+}
+/*
 FastWrite input register values - All DAC ouput update. refer to DATASHEET 5.6.1 figure 5-7
 DAC Input and PowerDown bits update.
 No EEPROM update
 */
-void MCP4728::fastWrite()
+void MCP4728::fastWrite(I2C::Transaction& t)
 {
+    uint8_t buf[8];
     for (uint8_t channel = 0; channel <= 3; channel++) {
-        _buf[2 * channel] = highByte(_values[channel]) | ((_powerDown[channel] << 4));
-        _buf[2 * channel + 1] = lowByte(_values[channel]);
+        buf[2 * channel] = highByte(_values[channel]) | ((_powerDown[channel] << 4));
+        buf[2 * channel + 1] = lowByte(_values[channel]);
     }
-    uint8_t cmd = 0B0000000 | _buf[0]; // fastwrite cm
-    i2c_smbus_write_i2c_block_data(_i2cPort, cmd, 7, &_buf[1]);
+    t.write(_dev_address, buf, 8);
 }
 /*
-MultiWrite input register values - All DAC ouput update. refer to DATASHEET 5.6.2
+MultiWrite input register values - Selected DAC ouput update. refer to DATASHEET 5.6.2
 DAC Input, Gain, Vref and PowerDown bits update
 No EEPROM update
 */
-void MCP4728::multiWrite()
+void MCP4728::multiWrite(I2C::Transaction& t, uint8_t channels)
 {
-    // TO DO IF NEEDED...
+    uint8_t buf[12];
+    std::size_t size = 0;
+    for (uint8_t channel = 0; channel <= 3; channel++) {
+        if (!(channels & (1 << channel))) {
+            continue;
+        }
+        buf[size++] = MULTIWRITE | (channel << 1); // UDAC = 0, output updated on acknowledge
+        buf[size++] = _intVref[channel] << 7 | _powerDown[channel] << 5 | _gain[channel] << 4 | highByte(_values[channel]);
+        buf[size++] = lowByte(_values[channel]);
+    }
+    t.write(_dev_address, buf, size);
 }
 /*
 SingleWrite input register and EEPROM - a DAC ouput update. refer to DATASHEET 5.6.4
@@ -435,7 +452,9 @@ void MCP4728::singleWrite(uint8_t channel)
     uint8_t cmd = SINGLEWRITE | (channel << 1);
     _buf[0] = _intVref[channel] << 7 | _powerDown[channel] << 5 | _gain[channel] << 4 | highByte(_values[channel]);
     _buf[1] = lowByte(_values[channel]);
-    i2c_smbus_write_i2c_block_data(_i2cPort, cmd, 2, &_buf[0]);
+    I2C::Transaction t;
+    t.write(_dev_address, { cmd, _buf[0], _buf[1] });
+    _bus.transfer(t);
 }
 /*
 SequencialWrite input registers and EEPROM - ALL DAC ouput update. refer to DATASHEET 5.6.3
@@ -449,9 +468,11 @@ void MCP4728::seqWrite()
         _buf[2 * channel] = _intVref[channel] << 7 | _powerDown[channel] << 5 | _gain[channel] << 4 | highByte(_values[channel]);
         _buf[2 * channel + 1] = lowByte(_values[channel]);
     }
-    uint8_t cmd = SEQWRITE;
-    ;
-    i2c_smbus_write_i2c_block_data(_i2cPort, cmd, 8, &_buf[0]);
+    uint8_t buf[9] = { SEQWRITE };
+    std::copy_n(_buf, 8, buf + 1);
+    I2C::Transaction t;
+    t.write(_dev_address, buf, 9);
+    _bus.transfer(t);
 }
 /*
 Write Voltage reference setting to input registers. refer to DATASHEET 5.6.5
@@ -459,8 +480,7 @@ No EEPROM update
 */
 void MCP4728::writeVref()
 {
-    uint8_t cmd = VREFWRITE | (_intVref[0] << 3) | (_intVref[1] << 2) | (_intVref[2] << 1) | _intVref[3];
-    i2c_smbus_write_byte(_i2cPort, cmd);
+    command(VREFWRITE | (_intVref[0] << 3) | (_intVref[1] << 2) | (_intVref[2] << 1) | _intVref[3]);
 }
 /*
 Write Gain setting to input registers. refer to DATASHEET 5.6.7
@@ -468,8 +488,7 @@ No EEPROM update
 */
 void MCP4728::writeGain()
 {
-    uint8_t cmd = GAINWRITE | (_gain[0] << 3) | (_gain[1] << 2) | (_gain[2] << 1) | _gain[3];
-    i2c_smbus_write_byte(_i2cPort, cmd);
+    command(GAINWRITE | (_gain[0] << 3) | (_gain[1] << 2) | (_gain[2] << 1) | _gain[3]);
 }
 /*
 Write PowerDown setting to input registers. refer to DATASHEET 5.6.6
@@ -479,7 +498,9 @@ void MCP4728::writePowerDown()
 {
     _buf[0] = POWERDOWNWRITE | (_powerDown[0] << 2) | _powerDown[1];
     _buf[1] = (_powerDown[2] << 6) | (_powerDown[3] << 4);
-    i2c_smbus_write_byte_data(_i2cPort, _buf[0], _buf[1]);
+    I2C::Transaction t;
+    t.write(_dev_address, { _buf[0], _buf[1] });
+    _bus.transfer(t);
 }
 /*
 Calculate Voltage out based on current setting of Vref and gain
@@ -494,5 +515,5 @@ void MCP4728::writeVout()
             _values[channel] = (long(_vOut[channel]) * 4096) / _vdd;
         }
     }
-    fastWrite();
+    writeInputs(0B1111, false);
 }
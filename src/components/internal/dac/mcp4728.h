@@ -1,6 +1,7 @@
 #ifndef MCP4728_H
 #define MCP4728_H
 
+#include "utils/i2c/i2c_bus.h"
 #include <stdint.h>
 
 class MCP4728 {
@@ -40,9 +41,11 @@ public:
     void getStatus();
 
 private:
-    int _i2cPort;
-    void fastWrite();
-    void multiWrite();
+    I2C::Bus& _bus;
+    void command(uint8_t);
+    void writeInputs(uint8_t channels, bool update);
+    void fastWrite(I2C::Transaction&);
+    void multiWrite(I2C::Transaction&, uint8_t channels);
     void singleWrite(uint8_t);
     void seqWrite();
     void writeVref();
@@ -0,0 +1,281 @@
+#include "button.h"
+#include "utils/log/log.h"
+#include <algorithm>
+#include <poll.h>
+
+namespace {
+Button::clock::duration from_ms(double ms)
+{
+    return std::chrono::duration_cast<Button::clock::duration>(std::chrono::duration<double, std::milli>(ms));
+}
+
+const Button::clock::time_point never = Button::clock::time_point::max();
+}
+
+Button::Button(int pin, std::string name, GPIO::Pull pull)
+    : _pin(pin)
+    , _name(name)
+    , _active_low(pull == GPIO::PULL_UP)
+    , _gpio(pin, GPIO::DIR_INPUT, pull)
+    , _presses(0)
+    , _resync(false)
+    , _long_fired(false)
+    , _in_double(false)
+    , _pending_press(false)
+    , _lockout_until(clock::time_point::min())
+    , _down_at(clock::now())
+    , _press_deadline(never)
+{
+    try {
+        _edge = std::make_unique<GPIOEdge>(pin, GPIOEdge::Both, "sam_" + name);
+    } catch (std::exception& e) {
+        warning() << "Button " << name << ": " << e.what() << ", polling it instead";
+    }
+
+    _raw_level = _edge ? _edge->level() : static_cast<bool>(_gpio);
+    _level = _raw_level;
+    _down = _raw_level != _active_low;
+    // No long press for a button already held at startup
+    _long_fired = _down;
+
+    ButtonService::instance().add(this);
+}
+
+Button::~Button()
+{
+    ButtonService::instance().remove(this);
+}
+
+Button::operator int()
+{
+    return _level ? 1 : 0;
+}
+
+Button::operator bool()
+{
+    return _level;
+}
+
+bool Button::pressed() const
+{
+    return _level != _active_low;
+}
+
+void Button::subscribe(const void* owner, Callback cb)
+{
+    std::lock_guard lock(_subscribers_mutex);
+    _subscribers.emplace_back(owner, cb);
+}
+
+void Button::unsubscribe(const void* owner)
+{
+    std::lock_guard lock(_subscribers_mutex);
+    _subscribers.erase(std::remove_if(_subscribers.begin(), _subscribers.end(), [owner](const auto& s) { return s.first == owner; }), _subscribers.end());
+}
+
+void Button::dispatch(Event event, clock::time_point stamp)
+{
+    std::lock_guard lock(_subscribers_mutex);
+    for (auto& s : _subscribers) {
+        s.second(event, stamp);
+    }
+}
+
+const char* Button::event_name(Event event)
+{
+    switch (event) {
+    case Down:
+        return "down";
+    case Up:
+        return "up";
+    case Press:
+        return "press";
+    case LongPress:
+        return "long press";
+    case DoublePress:
+        return "double press";
+    }
+    return "";
+}
+
+ButtonService::ButtonService()
+    : Worker("buttons", Worker::Continuous)
+    , NamedObject("buttons")
+    , MenuUser("buttons", "Buttons")
+    , _debounce_ms("debounce_ms", BaseParam::ReadWrite, this, 10.)
+    , _long_press_ms("long_press_ms", BaseParam::ReadWrite, this, 800.)
+    , _double_press_ms("double_press_ms", BaseParam::ReadWrite, this, 300.)
+    , _poll_ms("poll_ms", BaseParam::ReadWrite, this, 2.)
+    , _debounce(from_ms(_debounce_ms))
+    , _long_press(from_ms(_long_press_ms))
+    , _double_press(from_ms(_double_press_ms))
+    , _poll(from_ms(_poll_ms))
+{
+    _menu->add_item("s", "Show buttons", [this](std::string) { show_status(); });
+
+    do_work();
+}
+
+ButtonService::~ButtonService()
+{
+    stop();
+}
+
+ButtonService& ButtonService::instance()
+{
+    static ButtonService s;
+    return s;
+}
+
+void ButtonService::add(Button* button)
+{
+    std::lock_guard lock(_buttons_mutex);
+    _buttons.push_back(button);
+}
+
+void ButtonService::remove(Button* button)
+{
+    std::lock_guard lock(_buttons_mutex);
+    _buttons.erase(std::remove(_buttons.begin(), _buttons.end(), button), _buttons.end());
+}
+
+void ButtonService::show_status()
+{
+    std::lock_guard lock(_buttons_mutex);
+    for (Button* b : _buttons) {
+        info() << b->name() << " (GPIO " << b->pin() << (b->_edge ? ", edges" : ", polled") << "): " << (b->pressed() ? "pressed" : "released") << ", "
+               << b->_presses << " presses";
+    }
+}
+
+void ButtonService::work()
+{
+    if (_debounce_ms.changed() || _long_press_ms.changed() || _double_press_ms.changed() || _poll_ms.changed()) {
+        _debounce = from_ms(_debounce_ms);
+        _long_press = from_ms(_long_press_ms);
+        _double_press = from_ms(_double_press_ms);
+        _poll = from_ms(_poll_ms);
+    }
+
+    // Buttons are only added and removed when components are created, the
+    // lock is held while waiting
+    std::lock_guard lock(_buttons_mutex);
+
+    clock::time_point now = clock::now();
+    clock::time_point deadline = now + std::chrono::milliseconds(100);
+    std::vector<pollfd> fds;
+    std::vector<Button*> owners;
+    bool polling = false;
+    for (Button* b : _buttons) {
+        if (b->_edge) {
+            fds.push_back({ b->_edge->fd(), POLLIN, 0 });
+            owners.push_back(b);
+        } else {
+            polling = true;
+        }
+        deadline = std::min(deadline, next_deadline(*b));
+    }
+    if (polling) {
+        deadline = std::min(deadline, now + _poll);
+    }
+
+    auto timeout = std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now), std::chrono::nanoseconds(0));
+    timespec ts;
+    ts.tv_sec = timeout.count() / 1000000000;
+    ts.tv_nsec = timeout.count() % 1000000000;
+    ppoll(fds.data(), fds.size(), &ts, nullptr);
+
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+        if (fds[i].revents & POLLIN) {
+            while (std::optional<GPIOEdge::Event> e = owners[i]->_edge->read()) {
+                handle_level(*owners[i], e->rising, e->stamp);
+            }
+        }
+    }
+
+    now = clock::now();
+    for (Button* b : _buttons) {
+        if (!b->_edge) {
+            bool level = b->_gpio;
+            if (level != b->_raw_level) {
+                handle_level(*b, level, now);
+            }
+        }
+        check_timers(*b, now);
+    }
+}
+
+void ButtonService::handle_level(Button& b, bool level, clock::time_point stamp)
+{
+    b._raw_level = level;
+    if (stamp < b._lockout_until) {
+        b._resync = true;
+        return;
+    }
+    bool down = level != b._active_low;
+    if (down != b._down) {
+        transition(b, down, stamp);
+    }
+}
+
+void ButtonService::transition(Button& b, bool down, clock::time_point stamp)
+{
+    b._down = down;
+    b._level = down != b._active_low;
+    b._lockout_until = stamp + _debounce;
+
+    if (down) {
+        ++b._presses;
+        b._down_at = stamp;
+        b._long_fired = false;
+        b._in_double = false;
+        b.dispatch(Button::Down, stamp);
+        if (b._pending_press && stamp <= b._press_deadline) {
+            b._pending_press = false;
+            b._in_double = true;
+            b.dispatch(Button::DoublePress, stamp);
+        }
+    } else {
+        b.dispatch(Button::Up, stamp);
+        if (!b._long_fired && !b._in_double) {
+            b._pending_press = true;
+            b._press_deadline = stamp + _double_press;
+        }
+    }
+}
+
+void ButtonService::check_timers(Button& b, clock::time_point now)
+{
+    if (b._resync && now >= b._lockout_until) {
+        b._resync = false;
+        bool level = b._edge ? b._edge->level() : static_cast<bool>(b._gpio);
+        b._raw_level = level;
+        bool down = level != b._active_low;
+        if (down != b._down) {
+            transition(b, down, now);
+        }
+    }
+    if (b._down && !b._long_fired && !b._in_double && now >= b._down_at + _long_press) {
+        b._long_fired = true;
+        b.dispatch(Button::LongPress, now);
+    }
+    if (b._pending_press && now >= b._press_deadline) {
+        b._pending_press = false;
+        b.dispatch(Button::Press, b._press_deadline - _double_press);
+    }
+}
+
+ButtonService::clock::time_point ButtonService::next_deadline(const Button& b) const
+{
+    clock::time_point deadline = never;
+    if (b._resync) {
+        deadline = std::min(deadline, b._lockout_until);
+    }
+    if (b._down && !b._long_fired && !b._in_double) {
+        deadline = std::min(deadline, b._down_at + _long_press);
+    }
+    if (b._pending_press) {
+        deadline = std::min(deadline, b._press_deadline);
+    }
+    return deadline;
+}
@@ -0,0 +1,130 @@
+#ifndef BUTTON_H
+#define BUTTON_H
+
+#include "gpio.h"
+#include "gpio_edge.h"
+#include "utils/interfaces/menu_user.h"
+#include "utils/named_object.h"
+#include "utils/param.h"
+#include "utils/worker.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * \brief Push button watched by the button service.
+ *
+ * Reading the button returns its debounced level, like GPIO, without
+ * touching the GPIO registers. Events are recognized by ButtonService and
+ * given to the subscribers on the service thread: callbacks must only stage
+ * work for the subscriber's own loop, and must not unsubscribe.
+ */
+class Button {
+public:
+    using clock = std::chrono::steady_clock;
+
+    enum Event {
+        Down,
+        Up,
+        Press, // short press, not followed by a second one
+        LongPress, // still held after long_press_ms
+        DoublePress // second press shortly after a short one
+    };
+
+    using Callback = std::function<void(Event event, clock::time_point stamp)>;
+
+    Button(int pin, std::string name, GPIO::Pull pull = GPIO::PULL_UP);
+    ~Button();
+
+    Button(const Button&) = delete;
+    Button& operator=(const Button&) = delete;
+
+    operator int();
+    operator bool();
+    bool pressed() const;
+
+    void subscribe(const void* owner, Callback cb);
+    void unsubscribe(const void* owner);
+
+    int pin() const { return _pin; }
+    const std::string& name() const { return _name; }
+
+    static const char* event_name(Event event);
+
+private:
+    friend class ButtonService;
+
+    void dispatch(Event event, clock::time_point stamp);
+
+    int _pin;
+    std::string _name;
+    bool _active_low;
+    GPIO _gpio;
+
+    std::atomic<bool> _level;
+    std::atomic<uint32_t> _presses;
+
+    std::vector<std::pair<const void*, Callback>> _subscribers;
+    std::mutex _subscribers_mutex;
+
+    // Recognition state, owned by the service thread
+    std::unique_ptr<GPIOEdge> _edge;
+    bool _raw_level;
+    bool _down;
+    bool _resync;
+    bool _long_fired;
+    bool _in_double;
+    bool _pending_press;
+    clock::time_point _lockout_until;
+    clock::time_point _down_at;
+    clock::time_point _press_deadline;
+};
+
+/**
+ * \brief Recognizes the button events on a dedicated thread.
+ *
+ * Edges come from the GPIO character device with the time they occurred;
+ * lines it can't provide are polled every poll_ms. The first edge of a
+ * stable button is taken immediately and the following ones are ignored for
+ * debounce_ms, after which the level is read again in case it bounced back.
+ */
+class ButtonService : public Worker, public NamedObject, public MenuUser {
+public:
+    static ButtonService& instance();
+
+    void show_status();
+
+private:
+    friend class Button;
+    using clock = Button::clock;
+
+    ButtonService();
+    ~ButtonService() override;
+
+    void add(Button* button);
+    void remove(Button* button);
+
+    void work() override;
+
+    void handle_level(Button& b, bool level, clock::time_point stamp);
+    void transition(Button& b, bool down, clock::time_point stamp);
+    void check_timers(Button& b, clock::time_point now);
+    clock::time_point next_deadline(const Button& b) const;
+
+    Param<double> _debounce_ms;
+    Param<double> _long_press_ms;
+    Param<double> _double_press_ms;
+    Param<double> _poll_ms;
+
+    clock::duration _debounce;
+    clock::duration _long_press;
+    clock::duration _double_press;
+    clock::duration _poll;
+
+    std::vector<Button*> _buttons;
+    std::mutex _buttons_mutex;
+};
+
+#endif // BUTTON_H
@@ -1,37 +1,29 @@
 #include "gpio.h"
-#include <bcm2835.h>
+#include "hal/platform.h"
 
 GPIO::GPIO(int pin, Direction dir, Pull pull)
     : _pin(pin)
     , _dir(dir)
     , _pull(pull)
 {
-    switch (dir) {
-    case DIR_INPUT:
-        bcm2835_gpio_fsel(_pin, BCM2835_GPIO_FSEL_INPT);
-        break;
-    case DIR_OUTPUT:
-        bcm2835_gpio_fsel(_pin, BCM2835_GPIO_FSEL_OUTP);
-        break;
-    }
-
+    HAL::Pull hal_pull = HAL::Pull::None;
     switch (pull) {
     case PULL_UP:
-        bcm2835_gpio_set_pud(_pin, BCM2835_GPIO_PUD_UP);
+        hal_pull = HAL::Pull::Up;
         break;
     case PULL_DOWN:
-        bcm2835_gpio_set_pud(_pin, BCM2835_GPIO_PUD_DOWN);
+        hal_pull = HAL::Pull::Down;
         break;
     case PULL_NONE:
-        bcm2835_gpio_set_pud(_pin, BCM2835_GPIO_PUD_OFF);
         break;
     }
+    HAL::Platform::instance().gpio().configure(_pin, dir == DIR_OUTPUT, hal_pull);
 }
 
 GPIO& GPIO::operator=(int v)
 {
     if (_dir == DIR_OUTPUT) {
-        bcm2835_gpio_write(_pin, v);
+        HAL::Platform::instance().gpio().write(_pin, v != 0);
     }
     return *this;
 }
@@ -39,7 +31,7 @@ GPIO& GPIO::operator=(int v)
 GPIO& GPIO::operator=(bool v)
 {
     if (_dir == DIR_OUTPUT) {
-        bcm2835_gpio_write(_pin, v ? HIGH : LOW);
+        HAL::Platform::instance().gpio().write(_pin, v);
     }
     return *this;
 }
@@ -47,7 +39,7 @@ GPIO& GPIO::operator=(bool v)
 GPIO::operator int()
 {
     if (_dir == DIR_INPUT) {
-        return bcm2835_gpio_lev(_pin);
+        return HAL::Platform::instance().gpio().read(_pin);
     } else {
         return 0;
     }
@@ -56,7 +48,7 @@ GPIO::operator int()
 GPIO::operator bool()
 {
     if (_dir == DIR_INPUT) {
-        return bcm2835_gpio_lev(_pin) == HIGH;
+        return HAL::Platform::instance().gpio().read(_pin);
     } else {
         return 0;
     }
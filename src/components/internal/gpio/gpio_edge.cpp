@@ -0,0 +1,33 @@
+#include "gpio_edge.h"
+#include <poll.h>
+
+static HAL::Edge to_hal(GPIOEdge::Edge edge)
+{
+    switch (edge) {
+    case GPIOEdge::Rising:
+        return HAL::Edge::Rising;
+    case GPIOEdge::Falling:
+        return HAL::Edge::Falling;
+    default:
+        return HAL::Edge::Both;
+    }
+}
+
+GPIOEdge::GPIOEdge(int pin, Edge edge, std::string consumer)
+    : _pin(pin)
+    , _source(HAL::Platform::instance().gpio().edges(pin, to_hal(edge), consumer))
+{
+}
+
+std::optional<GPIOEdge::Event> GPIOEdge::wait(std::chrono::microseconds timeout)
+{
+    pollfd pfd = { fd(), POLLIN, 0 };
+    timespec ts;
+    ts.tv_sec = timeout.count() / 1000000;
+    ts.tv_nsec = (timeout.count() % 1000000) * 1000;
+
+    if (ppoll(&pfd, 1, &ts, nullptr) <= 0 || !(pfd.revents & POLLIN)) {
+        return std::nullopt;
+    }
+    return read();
+}
@@ -0,0 +1,45 @@
+#ifndef GPIO_EDGE_H
+#define GPIO_EDGE_H
+
+#include "hal/platform.h"
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+
+/**
+ * \brief Edge events of an input line, from the GPIO controller of the platform.
+ *
+ * On the Pi the kernel timestamps the edges in its interrupt handler, so
+ * waiting for an event neither polls the line nor loses the time it
+ * occurred. On the host the edges come from HostGPIO::set_input().
+ */
+class GPIOEdge {
+public:
+    enum Edge {
+        Rising,
+        Falling,
+        Both
+    };
+
+    using Event = HAL::EdgeEvent;
+
+    GPIOEdge(int pin, Edge edge, std::string consumer = "sam");
+
+    GPIOEdge(const GPIOEdge&) = delete;
+    GPIOEdge& operator=(const GPIOEdge&) = delete;
+
+    std::optional<Event> wait(std::chrono::microseconds timeout);
+    // Next pending event, without waiting
+    std::optional<Event> read() { return _source->read(); }
+    bool level() { return _source->level(); }
+
+    int fd() const { return _source->fd(); }
+    int pin() const { return _pin; }
+
+private:
+    int _pin;
+    std::unique_ptr<HAL::EdgeSource> _source;
+};
+
+#endif // GPIO_EDGE_H
@@ -1,11 +1,32 @@
 #include "touch_bionics_hand.h"
 
 #include "utils/log/log.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
 
 TouchBionicsHand::TouchBionicsHand()
+    : Worker("touchbionics_hand", Worker::Continuous)
+    , _speed(3)
+    , _owner(std::thread::id())
+    , _last_levels({})
+    , _count(0)
+    , _next_step(clock::now())
+    , _next_frame(clock::now())
 {
     _sp.open("/dev/touchbionics", B115200);
-    _speed = 3;
+
+    // Leaves the hand time to apply a frame, whose 13 bytes alone take ~1.1 ms at 115200 bauds
+    const auto min_frame_interval = std::chrono::milliseconds(10);
+    unsigned int bps = _sp.bits_per_second();
+    auto wire = std::chrono::microseconds(bps > 0 ? 2 * 13 * 10 * 1000000 / bps : 0);
+    _frame_interval = std::max<clock::duration>(min_frame_interval, wire);
+
+    for (int action = 0; action < ACTION_COUNT; ++action) {
+        for (int speed = 0; speed < 10; ++speed) {
+            _commands[action][speed] = build_command(action, speed);
+        }
+    }
 
     _menu->set_description("TouchBionics Hand ");
     _menu->set_code("tb");
@@ -20,173 +41,248 @@ TouchBionicsHand::TouchBionicsHand()
     _menu->add_item("ctp", "Close triple pinch", [this](std::string) { move(TRIPLE_PINCH_CLOSING); });
     _menu->add_item("otp", "Open triple pinch ", [this](std::string) { move(TRIPLE_PINCH_OPENING); });
     _menu->add_item("off", "Open forefinger ", [this](std::string) { move(FOREFINGER_OPENING); });
+    _menu->add_item("d", "Digit speeds (6 values in [-1, 1])", [this](std::string args) {
+        DigitSpeeds speeds = {};
+        std::istringstream ss(args);
+        for (std::size_t i = 0; i < digit_count && ss >> speeds[i]; ++i) {
+        }
+        set_digit_speeds(speeds);
+    });
+
+    do_work();
 }
 
 TouchBionicsHand::~TouchBionicsHand()
 {
+    {
+        std::lock_guard<std::mutex> lock(_queue_mutex);
+        _worker_loop_condition = false;
+    }
+    _queue_cv.notify_all();
+    stop();
 }
 
 void TouchBionicsHand::init_sequence()
 {
-    setPosture(HAND_POSTURE);
-    std::this_thread::sleep_for(std::chrono::seconds(2));
-
     set_speed(5);
-    move(HAND_CLOSING);
-
-    std::this_thread::sleep_for(std::chrono::seconds(2));
-    move(STOP);
+    play({ { Step::Posture, HAND_POSTURE, std::chrono::milliseconds(100) },
+        { Step::Move, HAND_OPENING_ALL, std::chrono::seconds(2) },
+        { Step::Move, HAND_CLOSING, std::chrono::seconds(2) },
+        { Step::Move, STOP, std::chrono::milliseconds(0) } });
 }
 
 void TouchBionicsHand::setPosture(POSTURE posture)
 {
-    debug() << "TouchBionicsHand::setPosture(" << posture << ")";
-    std::string cmd = "QG";
-    if (static_cast<int>(posture) < 10) {
-        cmd += '0';
-    }
-    cmd += std::to_string(posture) + '\r';
-    _sp.write(cmd);
-
-    switch (posture) {
-    case HAND_POSTURE:
-        debug() << "TouchBionics: Setting Hand Posture";
-        break;
-    case PINCH_POSTURE:
-        debug() << "TouchBionics: Setting Pinch Posture";
-        break;
-    case TRIPLE_PINCH_POSTURE:
-        debug() << "TouchBionics: Setting Triple Pinch Posture";
-        break;
-    case GLOVE_POSTURE:
-        debug() << "TouchBionics: Setting Glove Posture";
-        break;
-    default:
-        warning() << "TouchBionics: Unknown Posture";
-        break;
-    }
-
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    move(HAND_OPENING_ALL);
+    play({ { Step::Posture, posture, std::chrono::milliseconds(100) },
+        { Step::Move, HAND_OPENING_ALL, std::chrono::milliseconds(0) } });
 }
 
 void TouchBionicsHand::set_speed(int new_speed)
 {
-    if (new_speed < 0) {
-        _speed = 0;
-    } else if (new_speed > 9) {
-        _speed = 9;
-    } else {
-        _speed = new_speed;
-    }
+    _speed = std::clamp(new_speed, 0, 9);
 }
 
 void TouchBionicsHand::move(int action)
 {
-    debug() << "TouchBionicsHand::move(" << action << ")";
-    // If changing direction, send 0 before
-    if (((_last_action + action) % 2 == 1) && _last_action != 0) {
-        if (_last_action % 2 == 0)
-            _sp.write("+0+0+0+0+0+0\r", 13);
-        else
-            _sp.write("-0-0-0-0-0-0\r", 13);
+    play({ { Step::Move, action, std::chrono::milliseconds(0) } });
+}
+
+void TouchBionicsHand::play(Timeline timeline)
+{
+    if (!accepts_commands()) {
+        warning() << "TouchBionics: hand is owned by another controller, command dropped";
+        return;
     }
 
-    if (_last_action != action) {
-        _count = 0;
-        switch (action) {
-        case THUMB_CLOSING: // thumb flexion + rotation
-            sprintf(_cmd, "-%d-0-0-0-0-%d\r", _speed, _speed);
-            break;
-        case THUMB_OPENING:
-            sprintf(_cmd, "+%d+0+0+0+0+%d\r", _speed, _speed);
-            break;
-        case THUMB_EXT_CLOSING: // thumb flexion
-            sprintf(_cmd, "-%d-0-0-0-0-0\r", _speed);
-            break;
-        case THUMB_EXT_OPENING:
-            sprintf(_cmd, "+%d+0+0+0+0+0\r", _speed);
-            break;
-        case THUMB_INT_CLOSING: // thumb rotation
-            sprintf(_cmd, "-0-0-0-0-0-%d\r", _speed);
-            break;
-        case THUMB_INT_OPENING:
-            sprintf(_cmd, "+0+0+0+0+0+%d\r", _speed);
-            break;
-        case FOREFINGER_CLOSING: // Forefinger flexion
-            sprintf(_cmd, "-0-%d-0-0-0-0\r", _speed);
-            break;
-        case FOREFINGER_OPENING:
-            sprintf(_cmd, "+0+%d+0+0+0+0\r", _speed);
-            break;
-        case MIDDLEFINGER_CLOSING: // Middle finger flexion
-            sprintf(_cmd, "-0-0-%d-0-0-0\r", _speed);
-            break;
-        case MIDDLEFINGER_OPENING:
-            sprintf(_cmd, "+0+0+%d+0+0+0\r", _speed);
-            break;
-        case RINGFINGER_CLOSING: // Annulaire
-            sprintf(_cmd, "-0-0-0-%d-0-0\r", _speed);
-            break;
-        case RINGFINGER_OPENING:
-            sprintf(_cmd, "+0+0+0+%d+0+0\r", _speed);
-            break;
-        case LITTLEFINGER_CLOSING: // Auriculaire
-            sprintf(_cmd, "-0-0-0-0-%d-0\r", _speed);
-            break;
-        case LITTLEFINGER_OPENING:
-            sprintf(_cmd, "+0+0+0+0+%d+0\r", _speed);
-            break;
-        case PINCH_CLOSING: // Pinch but thumb rotation
-            sprintf(_cmd, "-%d-%d-0-0-0-0\r", _speed, _speed);
-            break;
-        case PINCH_OPENING:
-            sprintf(_cmd, "+%d+%d+0+0+0+0\r", _speed, _speed);
-            break;
-        case TRIPLE_PINCH_CLOSING: // Pinch but thumb rotation
-            sprintf(_cmd, "-%d-%d-%d-0-0-0\r", _speed, _speed, _speed);
-            break;
-        case TRIPLE_PINCH_OPENING:
-            sprintf(_cmd, "+%d+%d+%d+0+0+0\r", _speed, _speed, _speed);
-            break;
-        case HAND_CLOSING: // Hand but thumb rotation
-            sprintf(_cmd, "-%d-%d-%d-%d-%d-0\r", _speed, _speed, _speed, _speed, _speed);
-            break;
-        case HAND_OPENING:
-            sprintf(_cmd, "+%d+%d+%d+%d+%d+0\r", _speed, _speed, _speed, _speed, _speed);
-            break;
-        case PINCH_CLOSING_ALL: // Pinch
-            sprintf(_cmd, "-%d-%d-0-0-0-%d\r", _speed, _speed, _speed);
-            break;
-        case PINCH_OPENING_ALL:
-            sprintf(_cmd, "+%d+%d+0+0+0+%d\r", _speed, _speed, _speed);
-            break;
-        case HAND_CLOSING_ALL: // Hand
-            sprintf(_cmd, "-%d-%d-%d-%d-%d-%d\r", _speed, _speed, _speed, _speed, _speed, _speed);
-            break;
-        case HAND_OPENING_ALL:
-            sprintf(_cmd, "+%d+%d+%d+%d+%d+%d\r", _speed, _speed, _speed, _speed, _speed, _speed);
-            break;
-        case ALL_BUT_PINCH_CLOSING: // three last fingers
-            sprintf(_cmd, "-0-0-%d-%d-%d-0\r", _speed, _speed, _speed);
-            break;
-        case ALL_BUT_PINCH_OPENING:
-            sprintf(_cmd, "+0+0+%d+%d+%d+0\r", _speed, _speed, _speed);
-            break;
-        default:
-            action = 0;
-            sprintf(_cmd, "+0+0+0+0+0+0\r");
-            break;
+    {
+        std::lock_guard<std::mutex> lock(_queue_mutex);
+        _pending_levels.reset();
+        for (Step& step : timeline) {
+            if (step.speed < 0) {
+                step.speed = _speed;
+            }
+            // A move not followed by a hold is superseded by the next one
+            if (step.kind == Step::Move && !_queue.empty() && _queue.back().kind == Step::Move && _queue.back().hold.count() == 0) {
+                _queue.back() = step;
+            } else {
+                _queue.push_back(step);
+            }
         }
-        _sp.write(_cmd, 13);
+    }
+    _queue_cv.notify_one();
+}
+
+void TouchBionicsHand::set_digit_speeds(const DigitSpeeds& speeds)
+{
+    if (!accepts_commands()) {
+        debug() << "TouchBionics: hand is owned by another controller, speeds dropped";
+        return;
+    }
+
+    DigitLevels levels;
+    for (std::size_t i = 0; i < digit_count; ++i) {
+        levels[i] = std::clamp(static_cast<int>(std::lround(9. * speeds[i])), -9, 9);
+    }
+
+    {
+        // Queued moves are superseded, postures still apply first
+        std::lock_guard<std::mutex> lock(_queue_mutex);
+        _queue.erase(std::remove_if(_queue.begin(), _queue.end(), [](const Step& step) { return step.kind == Step::Move; }), _queue.end());
+        _pending_levels = levels;
+    }
+    _queue_cv.notify_one();
+}
+
+void TouchBionicsHand::work()
+{
+    const auto idle_wait = std::chrono::milliseconds(100);
+
+    std::unique_lock<std::mutex> lock(_queue_mutex);
+    if (!_worker_loop_condition) {
+        return;
+    }
+
+    auto now = clock::now();
+    auto due = _queue.empty() && !_pending_levels ? clock::time_point::max() : std::max(_next_step, _next_frame);
+    if (now < due) {
+        _queue_cv.wait_until(lock, std::min(due, now + idle_wait));
+        return;
+    }
+
+    std::optional<Step> step;
+    std::optional<DigitLevels> levels;
+    if (!_queue.empty()) {
+        step = _queue.front();
+        _queue.pop_front();
     } else {
-        if (_count < _NB_OF_CMD_TO_RESEND) {
-            _count++;
-            _sp.write(_cmd, 13);
+        levels.swap(_pending_levels);
+    }
+    lock.unlock();
+
+    try {
+        if (step) {
+            execute(*step);
+        } else {
+            send_frame(encode(*levels, _last_levels));
+        }
+    } catch (std::exception& e) {
+        warning() << "TouchBionics:" << e.what();
+    }
+
+    if (step) {
+        lock.lock();
+        _next_step = clock::now() + step->hold;
+    }
+}
+
+void TouchBionicsHand::execute(const Step& step)
+{
+    if (step.kind == Step::Posture) {
+        std::string cmd = "QG";
+        if (step.value < 10) {
+            cmd += '0';
+        }
+        cmd += std::to_string(step.value) + '\r';
+        _sp.write(cmd);
+        debug() << "TouchBionics: Setting posture" << step.value;
+        _last_command.clear();
+        _next_frame = clock::now() + _frame_interval;
+        return;
+    }
+
+    int action = step.value > 0 && step.value < ACTION_COUNT ? step.value : STOP;
+    send_frame(_commands[action][std::clamp(step.speed, 0, 9)]);
+}
+
+void TouchBionicsHand::send_frame(const std::string& frame)
+{
+    DigitLevels levels = decode(frame);
+
+    // A digit changing direction is stopped before
+    DigitLevels stop = _last_levels;
+    bool reversing = false;
+    for (std::size_t i = 0; i < digit_count; ++i) {
+        if (_last_levels[i] * levels[i] < 0) {
+            stop[i] = 0;
+            reversing = true;
         }
     }
+    if (reversing) {
+        _sp.write(encode(stop, _last_levels));
+    }
 
-    debug() << std::string(_cmd, 13);
+    if (frame == _last_command) {
+        if (_count >= _NB_OF_CMD_TO_RESEND) {
+            return;
+        }
+        ++_count;
+    } else {
+        _count = 0;
+    }
 
-    _last_action = action;
+    _sp.write(frame);
+    _last_command = frame;
+    _last_levels = levels;
+    _next_frame = clock::now() + _frame_interval;
+}
+
+bool TouchBionicsHand::accepts_commands()
+{
+    std::thread::id owner = _owner;
+    return owner == std::thread::id() || owner == std::this_thread::get_id();
+}
+
+std::string TouchBionicsHand::build_command(int action, int speed)
+{
+    // Digits driven by each pair of actions: thumb flexion, forefinger, middle, ring, little, thumb rotation
+    static const std::array<const char*, (ACTION_COUNT + 1) / 2> digits = {
+        "000000", // STOP
+        "100001", // THUMB
+        "010000", // FOREFINGER
+        "001000", // MIDDLEFINGER
+        "000100", // RINGFINGER
+        "000010", // LITTLEFINGER
+        "110000", // PINCH, but thumb rotation
+        "111110", // HAND, but thumb rotation
+        "100000", // THUMB_EXT, thumb flexion
+        "000001", // THUMB_INT, thumb rotation
+        "110001", // PINCH_ALL
+        "111111", // HAND_ALL
+        "001110", // ALL_BUT_PINCH, three last fingers
+        "111000", // TRIPLE_PINCH
+    };
+
+    // Closing actions are odd, opening ones even
+    char sign = action % 2 == 1 ? '-' : '+';
+    const char* mask = digits[static_cast<std::size_t>((action + 1) / 2)];
+
+    std::string cmd;
+    for (std::size_t i = 0; i < digit_count; ++i) {
+        cmd += sign;
+        cmd += mask[i] == '1' ? static_cast<char>('0' + speed) : '0';
+    }
+    cmd += '\r';
+    return cmd;
+}
+
+std::string TouchBionicsHand::encode(const DigitLevels& levels, const DigitLevels& previous)
+{
+    // A stopped digit keeps the sign of its last direction
+    std::string cmd(2 * digit_count + 1, '\r');
+    for (std::size_t i = 0; i < digit_count; ++i) {
+        bool closing = levels[i] != 0 ? levels[i] < 0 : previous[i] < 0;
+        cmd[2 * i] = closing ? '-' : '+';
+        cmd[2 * i + 1] = static_cast<char>('0' + std::abs(levels[i]));
+    }
+    return cmd;
+}
+
+TouchBionicsHand::DigitLevels TouchBionicsHand::decode(const std::string& frame)
+{
+    DigitLevels levels = {};
+    for (std::size_t i = 0; i < digit_count && 2 * i + 1 < frame.size(); ++i) {
+        int level = frame[2 * i + 1] - '0';
+        levels[i] = frame[2 * i] == '-' ? -level : level;
+    }
+    return levels;
 }
@@ -3,12 +3,27 @@
 
 #include "utils/interfaces/menu_user.h"
 #include "utils/serial_port.h"
+#include "utils/worker.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <memory>
+#include <optional>
 
 /**
  * @brief The TouchBionicsHand class allows to control the TouchBionics hands.
+ *
+ * Commands are queued and sent by the hand's own thread, callers never wait.
+ * Postures and scripted sequences are timelines of steps separated by hold
+ * times. Consecutive moves are coalesced in the queue and a command equal to
+ * the last one sent is only repeated a few times.
+ *
+ * Continuous controllers drive each digit with its own signed speed through
+ * set_digit_speeds(); only the latest speeds are kept and frames are rate
+ * limited to what the hand link can carry.
  */
-class TouchBionicsHand : public MenuUser {
+class TouchBionicsHand : public Worker, public MenuUser {
 public:
     enum ACTION {
         STOP,
@@ -38,6 +53,7 @@ public:
         ALL_BUT_PINCH_OPENING,
         TRIPLE_PINCH_CLOSING,
         TRIPLE_PINCH_OPENING,
+        ACTION_COUNT
     };
 
     enum POSTURE {
@@ -48,26 +64,69 @@ public:
         GLOVE_POSTURE = 24,
     };
 
+    struct Step {
+        enum Kind {
+            Move,
+            Posture
+        } kind;
+        int value; // ACTION or POSTURE
+        std::chrono::milliseconds hold; // before the next step
+        int speed = -1; // -1: speed at the time the step is queued
+    };
+    using Timeline = std::vector<Step>;
+
+    // Thumb flexion, forefinger, middle finger, ring finger, little finger, thumb rotation
+    static const std::size_t digit_count = 6;
+    // Signed speeds in [-1, 1], negative closes the digit
+    using DigitSpeeds = std::array<double, digit_count>;
+    // Signed speeds levels in [-9, 9]
+    using DigitLevels = std::array<int, digit_count>;
+
     TouchBionicsHand();
-    ~TouchBionicsHand();
+    ~TouchBionicsHand() override;
 
     void init_sequence();
     void move(int action);
     void setPosture(POSTURE posture);
+    void play(Timeline timeline);
+    void set_digit_speeds(const DigitSpeeds& speeds);
 
     int speed() { return _speed; }
     void set_speed(int new_speed);
 
-    void take_ownership() { _sp.take_ownership(); }
-    void release_ownership() { _sp.release_ownership(); }
+    // Commands from other threads are dropped while the hand is owned
+    void take_ownership() { _owner = std::this_thread::get_id(); }
+    void release_ownership() { _owner = std::thread::id(); }
 
 private:
-    int _speed;
-    char _cmd[32];
-    int _last_action;
+    using clock = std::chrono::steady_clock;
+
+    void work() override;
+    void execute(const Step& step);
+    void send_frame(const std::string& frame);
+    bool accepts_commands();
+
+    static std::string build_command(int action, int speed);
+    static std::string encode(const DigitLevels& levels, const DigitLevels& previous);
+    static DigitLevels decode(const std::string& frame);
+
+    std::atomic<int> _speed;
+    std::atomic<std::thread::id> _owner;
+
+    std::array<std::array<std::string, 10>, ACTION_COUNT> _commands;
+    std::string _last_command;
+    DigitLevels _last_levels;
     int _count;
     const int _NB_OF_CMD_TO_RESEND = 3;
 
+    std::deque<Step> _queue;
+    std::optional<DigitLevels> _pending_levels;
+    std::mutex _queue_mutex;
+    std::condition_variable _queue_cv;
+    clock::time_point _next_step;
+    clock::time_point _next_frame;
+    clock::duration _frame_interval;
+
     SerialPort _sp;
 };
 
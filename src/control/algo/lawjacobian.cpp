@@ -48,8 +48,8 @@ void LawJacobian::initialization(Eigen::Vector3d posA, Eigen::Quaterniond qHip,
     delta[2] = 0;
     Rhip = Eigen::Matrix3d::Zero();
     Rframe = Eigen::Matrix3d::Zero();
-    thetaNew = Eigen::MatrixXd::Zero(nbFrames, 1);
-    thetaDot = Eigen::MatrixXd::Zero(nbFrames, 1);
+    thetaNew.setZero();
+    thetaDot.setZero();
 }
 /**
  * @brief LawJacobian::initialPositions computes the initial position of the acromion marker = mean over the initCounts first measures of the acromion position
@@ -236,9 +236,9 @@ void LawJacobian::controlLaw(Eigen::Vector3d posA, int lambda, double threshold[
 
 void LawJacobian::writeDebugData(double d[], double theta[])
 {
-    for (int i = 0; i < nbFrames; i++) {
+    for (int i = 0; i < nbLinks; i++) {
         d[i] = theta[i];
-        d[i + nbFrames] = thetaNew[i];
-        d[i + 2 * nbFrames] = thetaDot[i];
+        d[i + nbLinks] = thetaNew[i];
+        d[i + 2 * nbLinks] = thetaDot[i];
     }
 }
@@ -6,21 +6,23 @@
 CompensationIMU::CompensationIMU(std::shared_ptr<SAM::Components> robot)
     : ThreadedLoop("Compensation IMU", 0.01)
     , _robot(robot)
+    , _params("params", this)
     , _Lt(40)
-    , _Lua(0.)
-    , _Lfa(0.)
-    , _l(0.)
-    , _lambdaW(0)
-    , _lambda(0)
-    , _thresholdW(5.)
 {
     if (!check_ptr(_robot->joints.elbow_flexion, _robot->joints.wrist_pronation, _robot->sensors.fa_imu)) {
         throw std::runtime_error("Compensation IMU Control is missing components");
     }
 
-    if (!_receiver.bind("0.0.0.0", 45454)) {
-        critical() << "CompensationOptitrack: Failed to bind receiver";
-    }
+    _params.add_field("Lua", &Parameters::lua);
+    _params.add_field("Lfa", &Parameters::lfa);
+    _params.add_field("l", &Parameters::l);
+    _params.add_field("lambda", &Parameters::lambda);
+    _params.add_field("lambdaW", &Parameters::lambda_w);
+    _params.add_field("threshold", &Parameters::threshold, M_PI / 180.);
+    _params.add_field("thresholdW", &Parameters::threshold_w, M_PI / 180.);
+    _params.start();
+
+    supervise(std::chrono::milliseconds(200), Supervisor::SafeStop);
 
     _menu->set_description("CompensationIMU");
     _menu->set_code("imu");
@@ -61,40 +63,6 @@ void CompensationIMU::tare_IMU()
     //    qDebug("qFA after tare: %lf; %lf; %lf; %lf", qFA[0], qFA[1], qFA[2], qFA[3]);
 }
 
-void CompensationIMU::receiveData()
-{
-    printf("in receiveData \n");
-    while (_receiver.available()) {
-        auto data = _receiver.receive();
-        std::string buf;
-        std::transform(data.begin(), data.end(), buf.begin(), [](std::byte b) { return static_cast<char>(b); });
-        std::istringstream ts(buf);
-        int tmp;
-
-        ts >> tmp;
-        _Lua = tmp;
-
-        ts >> tmp;
-        _Lfa = tmp;
-
-        ts >> tmp;
-        _l = tmp;
-
-        ts >> tmp;
-        _lambda = tmp;
-
-        ts >> tmp;
-        _lambdaW = tmp;
-
-        ts >> tmp;
-        _threshold = tmp * M_PI / 180.; // dead zone limit for beta change, in rad.
-
-        ts >> tmp;
-        _thresholdW = tmp * M_PI / 180; // dead zone limit for wrist angle change, in rad.
-        printf("lambdaW:%d\n", _lambdaW);
-    }
-}
-
 void CompensationIMU::displayPin()
 {
     int pin_down_value = _robot->btn2;
@@ -127,6 +95,7 @@ bool CompensationIMU::setup()
     }
     _need_to_write_header = true;
     _start_time = clock::now();
+    Remote::CommandServer::instance().set_handler(this);
     return true;
 }
 
@@ -135,7 +104,7 @@ void CompensationIMU::loop(double dt, clock::time_point time)
     int init_cnt = 10;
     double timeWithDelta = (time - _start_time).count();
 
-    receiveData();
+    const Parameters& p = _params.get();
 
     _robot->sensors.optitrack->update();
     optitrack_data_t data = _robot->sensors.optitrack->get_last_data();
@@ -156,7 +125,7 @@ void CompensationIMU::loop(double dt, clock::time_point time)
     }
 
     /// WRIST
-    double wristAngleEncoder = _robot->joints.wrist_pronation->read_encoder_position();
+    double wristAngleEncoder = _robot->joints.wrist_pronation->encoder_position();
 
     double qBras[4], qTronc[4], qFA[4];
     _robot->sensors.arm_imu->get_quat(qBras);
@@ -177,15 +146,9 @@ void CompensationIMU::loop(double dt, clock::time_point time)
         _lawimu.initialPositions(qFA_record, _cnt, init_cnt);
     } else {
         _lawimu.rotationMatrices(qFA_record);
-        _lawimu.controlLawWrist(_lambdaW, _thresholdW);
-
-        if (_lawimu.returnWristVel_deg() > 0) {
-            _robot->joints.wrist_pronation->move_to(350, _lawimu.returnWristVel_deg());
-        } else if (_lawimu.returnWristVel_deg() < 0) {
-            _robot->joints.wrist_pronation->move_to(-350, -_lawimu.returnWristVel_deg());
-        } else if (_lawimu.returnWristVel_deg() == 0) {
-            _robot->joints.wrist_pronation->forward(0);
-        }
+        _lawimu.controlLawWrist(p.lambda_w, p.threshold_w);
+
+        _robot->joints.wrist_pronation->set_velocity_safe(_lawimu.returnWristVel_deg());
 
         if (_cnt % 50 == 0) {
             _lawimu.displayData();
@@ -203,7 +166,7 @@ void CompensationIMU::loop(double dt, clock::time_point time)
     _file << ' ' << qBras[0] << ' ' << qBras[1] << ' ' << qBras[2] << ' ' << qBras[3] << ' ' << qTronc[0] << ' ' << qTronc[1] << ' ' << qTronc[2] << ' ' << qTronc[3];
     _file << ' ' << qFA[0] << ' ' << qFA[1] << ' ' << qFA[2] << ' ' << qFA[3];
     _file << ' ' << debugData[0] << ' ' << debugData[1] << ' ' << debugData[2] << ' ' << debugData[3];
-    _file << ' ' << _lambdaW << ' ' << _thresholdW << ' ' << wristAngleEncoder;
+    _file << ' ' << p.lambda_w << ' ' << p.threshold_w << ' ' << wristAngleEncoder;
     _file << ' ' << data.nRigidBodies;
 
     for (int i = 0; i < data.nRigidBodies; i++) {
@@ -219,7 +182,13 @@ void CompensationIMU::loop(double dt, clock::time_point time)
 
 void CompensationIMU::cleanup()
 {
+    Remote::CommandServer::instance().clear_handler(this);
     //    _robot.elbow->forward(0);
     _robot->joints.wrist_pronation->forward(0);
     _file.close();
 }
+
+Remote::Status CompensationIMU::on_params(const std::string& transaction)
+{
+    return _params.stage_raw(transaction) ? Remote::Ok : Remote::Malformed;
+}
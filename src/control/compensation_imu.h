@@ -2,19 +2,31 @@
 #define COMPENSATIONIMU_H
 
 #include "control/algo/lawimu.h"
+#include "control/remote/command_server.h"
 #include "sam/sam.h"
-#include "utils/socket.h"
+#include "utils/param_block.h"
 #include "utils/threaded_loop.h"
 #include <fstream>
 
-class CompensationIMU : public ThreadedLoop {
+class CompensationIMU : public ThreadedLoop, public Remote::CommandHandler {
 public:
     explicit CompensationIMU(std::shared_ptr<SAM::Components> robot);
     ~CompensationIMU() override;
 
+    Remote::Status on_params(const std::string& transaction) override;
+
 private:
+    struct Parameters {
+        double lua = 0.;
+        double lfa = 0.;
+        double l = 0.;
+        int lambda = 0;
+        int lambda_w = 0;
+        double threshold = 0.; // dead zone limit for beta change, in rad.
+        double threshold_w = 5.; // dead zone limit for wrist angle change, in rad.
+    };
+
     void tare_IMU();
-    void receiveData();
     void displayPin();
 
     bool setup() override;
@@ -22,7 +34,7 @@ private:
     void cleanup() override;
 
     std::shared_ptr<SAM::Components> _robot;
-    Socket _receiver;
+    ParamBlock<Parameters> _params;
 
     clock::time_point _start_time;
 
@@ -32,11 +44,6 @@ private:
     LawIMU _lawimu;
 
     int _Lt;
-    double _Lua;
-    double _Lfa;
-    double _l;
-    int _lambdaW, _lambda;
-    double _thresholdW, _threshold;
 };
 
 #endif // COMPENSATION_IMU_H
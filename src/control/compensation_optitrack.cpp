@@ -1,4 +1,5 @@
 #include "compensation_optitrack.h"
+#include "sam/calibration.h"
 #include "utils/check_ptr.h"
 #include "utils/log/log.h"
 #include <filesystem>
@@ -6,28 +7,30 @@
 CompensationOptitrack::CompensationOptitrack(std::shared_ptr<SAM::Components> robot)
     : ThreadedLoop("compensation_optitrack", 0.01)
     , _robot(robot)
+    , _params("params", this)
     , _Lt(40)
-    , _Lua(0.)
-    , _Lfa(0.)
-    , _l(0.)
     , _lsh(-35)
-    , _lambdaW(0)
-    , _lambda(0)
-    , _thresholdW(5.)
     , _pinArduino(0)
 {
     if (!check_ptr(_robot->joints.elbow_flexion, _robot->joints.wrist_pronation, _robot->sensors.trunk_imu, _robot->sensors.arm_imu, _robot->sensors.optitrack)) {
         throw std::runtime_error("Optitrack Compensation is missing components");
     }
 
-    if (!_receiver.bind("0.0.0.0", 45454)) {
-        critical() << "CompensationOptitrack: Failed to bind receiver";
-    }
+    _params.add_field("Lua", &Parameters::lua);
+    _params.add_field("Lfa", &Parameters::lfa);
+    _params.add_field("l", &Parameters::l);
+    _params.add_field("lambda", &Parameters::lambda);
+    _params.add_field("lambdaW", &Parameters::lambda_w);
+    _params.add_field("threshold", &Parameters::threshold, M_PI / 180.);
+    _params.add_field("thresholdW", &Parameters::threshold_w, M_PI / 180.);
+    _params.start();
 
     if (!_receiverArduino.bind("0.0.0.0", 45455)) {
         critical() << "CompensationOptitrack: Failed to bind arduino receiver";
     }
 
+    supervise(std::chrono::milliseconds(200), Supervisor::SafeStop);
+
     _menu->set_description("Control with optitrack recording");
     _menu->set_code("opti");
     _menu->add_item("1", "Start (+ filename [comp for compensation, vol for voluntary control])", [this](std::string args) { this->start(args); });
@@ -72,13 +75,14 @@ void CompensationOptitrack::tareIMU()
 
 void CompensationOptitrack::display_parameters()
 {
-    debug() << "lambda: " << _lambda;
-    debug() << "Lfa: " << _Lfa;
-    debug() << "Lua: " << _Lua;
-    debug() << "l: " << _l;
-    debug() << "Threshold (in rad): " << _threshold;
-    debug() << "Threshold wrist (in rad): " << _thresholdW;
-    debug() << "lambda wrist: " << _lambdaW;
+    Parameters p = _params.staged();
+    debug() << "lambda: " << p.lambda;
+    debug() << "Lfa: " << p.lfa;
+    debug() << "Lua: " << p.lua;
+    debug() << "l: " << p.l;
+    debug() << "Threshold (in rad): " << p.threshold;
+    debug() << "Threshold wrist (in rad): " << p.threshold_w;
+    debug() << "lambda wrist: " << p.lambda_w;
 }
 
 void CompensationOptitrack::display_lengths()
@@ -149,11 +153,20 @@ void CompensationOptitrack::read_optiData(optitrack_data_t data)
 
     _lawopti.initialization(posA, posEE, posHip, qHip, opti_freq);
     _lawopti.rotationMatrices(qHip, qFA_record, 1, 10);
-    _lawopti.computeEEfromFA(posFA, _l, qFA_record);
+    _lawopti.computeEEfromFA(posFA, _params.get().l, qFA_record);
     _lawopti.projectionInHip(posA, posElbow, posHip, 1, 10);
-    _Lua = std::round((_lawopti.returnPosElbowinHip() - _lawopti.returnPosAinHip()).norm());
-    _Lfa = std::round((posElbow - posFA).norm());
-    _l = std::round((posFA - posEE).norm());
+
+    Parameters p = _params.staged();
+    double lua = std::round((_lawopti.returnPosElbowinHip() - _lawopti.returnPosAinHip()).norm());
+    double lfa = std::round((posElbow - posFA).norm());
+    double l = std::round((posFA - posEE).norm());
+    // Committing republishes the retained value, only do it when the lengths change
+    if (lua != p.lua || lfa != p.lfa || l != p.l) {
+        p.lua = lua;
+        p.lfa = lfa;
+        p.l = l;
+        _params.commit(p);
+    }
 
     if (_ind == 0) {
         debug() << "posA: " << posA[0] << " " << posA[1] << " " << posA[2];
@@ -161,7 +174,7 @@ void CompensationOptitrack::read_optiData(optitrack_data_t data)
         debug() << "posEE: " << posEE[0] << " " << posEE[1] << " " << posEE[2];
         debug() << "posHip: " << posHip[0] << " " << posHip[1] << " " << posHip[2];
         debug() << "qHip: " << qHip.w() << ", " << qHip.x() << ", " << qHip.y() << ", " << qHip.z();
-        debug() << "Lua: " << _Lua << ", Lfa: " << _Lfa << ", l: " << _l;
+        debug() << "Lua: " << p.lua << ", Lfa: " << p.lfa << ", l: " << p.l;
         _ind = 1;
     }
 }
@@ -214,7 +227,14 @@ void CompensationOptitrack::stop()
 
 bool CompensationOptitrack::setup()
 {
-    on_def();
+    if (!_robot->joints.elbow_flexion->calibrated()) {
+        critical() << "The elbow is not calibrated";
+        return false;
+    }
+    if (_robot->sensors.adc_acquisition) {
+        _robot->sensors.adc_acquisition->start();
+    }
+    Remote::CommandServer::instance().set_handler(this);
     return true;
 }
 
@@ -232,6 +252,10 @@ void CompensationOptitrack::loop(double dt, clock::time_point time)
 
 void CompensationOptitrack::cleanup()
 {
+    Remote::CommandServer::instance().clear_handler(this);
+    if (_robot->sensors.adc_acquisition) {
+        _robot->sensors.adc_acquisition->pause();
+    }
 }
 
 void CompensationOptitrack::on_new_data_compensation(optitrack_data_t data, double dt, clock::time_point time)
@@ -242,7 +266,7 @@ void CompensationOptitrack::on_new_data_compensation(optitrack_data_t data, doub
     Eigen::Vector3f posA, posElbow, posFA, posEE, posHip;
     Eigen::Quaternionf qHip, qFA_record;
     double timeWithDelta = (time - _time_start).count();
-    double deltaTtable = dt;
+    double deltaTtable = std::chrono::duration<double>(time - _time_start).count();
     double absTtable = (time - _abs_time_start).count();
 
     int timerTask = 1;
@@ -254,6 +278,7 @@ void CompensationOptitrack::on_new_data_compensation(optitrack_data_t data, doub
     //    qDebug() << "IMU Tronc : " << qTronc[0] << " " << qTronc[1] << " " << qTronc[2] << " " << qTronc[3];
 
     double debugData[35];
+    const Parameters& p = _params.get();
 
     int index_acromion = -1, index_FA = -1, index_EE = -1, index_elbow = -1, index_hip = -1;
 
@@ -311,7 +336,7 @@ void CompensationOptitrack::on_new_data_compensation(optitrack_data_t data, doub
 
     if (_cnt == 0) {
         const unsigned int opti_freq = 100;
-        if (_Lua == 0 && _Lfa == 0) {
+        if (p.lua == 0 && p.lfa == 0) {
             //            _Lua = qRound((posElbow - posA).norm());
             //            //            _Lfa = qRound((posElbow - posEE).norm());
             //            _Lfa = qRound((posElbow - posFA).norm());
@@ -335,7 +360,7 @@ void CompensationOptitrack::on_new_data_compensation(optitrack_data_t data, doub
         //        _lawopti.computeEEfromFA(posFA, _l, qFA_record);
         //        _lawopti.projectionInHip(posA, posElbow, posHip, _cnt, init_cnt);
         //        _lawopti.controlLaw(posEE, beta, _Lua, _Lfa, _l, _lambda, _threshold);
-        _lawopti.controlLawWrist(_lambdaW, _thresholdW);
+        _lawopti.controlLawWrist(p.lambda_w, p.threshold_w);
         _robot->joints.elbow_flexion->set_velocity_safe(_lawopti.returnBetaDot_deg());
 
         if (_lawopti.returnWristVel_deg() > 0)
@@ -360,15 +385,21 @@ void CompensationOptitrack::on_new_data_compensation(optitrack_data_t data, doub
     _lawopti.writeDebugData(debugData, posEE, beta);
 
     if (_cnt == 0) {
-        _file << _Lua << ' ' << _Lfa << ' ' << _l << std::endl;
+        _file << p.lua << ' ' << p.lfa << ' ' << p.l << std::endl;
     }
-    _file << deltaTtable << ' ' << timeWithDelta << ' ' << btn_sync << ' ' << absTtable << ' ' << _robot->sensors.adc->readADC_SingleEnded(0) << ' ' << _robot->sensors.adc->readADC_SingleEnded(1) << ' ' << timerTask;
+    // Without the ADC board the columns stay, at 0
+    int adc0 = 0, adc1 = 0;
+    if (_robot->sensors.adc_acquisition) {
+        adc0 = _robot->sensors.adc_acquisition->latest(0).raw;
+        adc1 = _robot->sensors.adc_acquisition->latest(1).raw;
+    }
+    _file << deltaTtable << ' ' << timeWithDelta << ' ' << btn_sync << ' ' << absTtable << ' ' << adc0 << ' ' << adc1 << ' ' << timerTask;
     _file << ' ' << _pinArduino;
     _file << ' ' << qBras[0] << ' ' << qBras[1] << ' ' << qBras[2] << ' ' << qBras[3] << ' ' << qTronc[0] << ' ' << qTronc[1] << ' ' << qTronc[2] << ' ' << qTronc[3];
     _file << ' ' << index_acromion << ' ' << index_EE << ' ' << index_elbow << ' ' << debugData[0] << ' ' << debugData[1] << ' ' << debugData[2] << ' ' << posA[0] << ' ' << posA[1] << ' ' << posA[2];
     _file << ' ' << debugData[3] << ' ' << debugData[4] << ' ' << debugData[5] << ' ' << debugData[6] << ' ' << debugData[7] << ' ' << debugData[8];
-    _file << ' ' << debugData[9] << ' ' << debugData[10] << ' ' << debugData[11] << ' ' << debugData[12] << ' ' << _lambda << ' ' << _threshold << ' ' << data.nRigidBodies;
-    _file << ' ' << debugData[13] << ' ' << debugData[14] << ' ' << debugData[15] << ' ' << debugData[16] << ' ' << _lambdaW << ' ' << _thresholdW;
+    _file << ' ' << debugData[9] << ' ' << debugData[10] << ' ' << debugData[11] << ' ' << debugData[12] << ' ' << p.lambda << ' ' << p.threshold << ' ' << data.nRigidBodies;
+    _file << ' ' << debugData[13] << ' ' << debugData[14] << ' ' << debugData[15] << ' ' << debugData[16] << ' ' << p.lambda_w << ' ' << p.threshold_w;
 
     for (unsigned int i = 0; i < data.nRigidBodies; i++) {
         _file << ' ' << data.rigidBodies[i].ID << ' ' << data.rigidBodies[i].bTrackingValid << ' ' << data.rigidBodies[i].fError;
@@ -409,7 +440,7 @@ void CompensationOptitrack::on_new_data_vol(optitrack_data_t data, double dt, cl
     //    }
 
     /// WRIST
-    double wristAngle = _robot->joints.wrist_pronation->read_encoder_position();
+    double wristAngle = _robot->joints.wrist_pronation->encoder_position();
 
     if (pin_down_value == 0 && prev_pin_down_value == 1) {
         _robot->joints.wrist_pronation->move_to(6000, 5000, 6000, 35000);
@@ -452,45 +483,12 @@ void CompensationOptitrack::on_new_data_vol(optitrack_data_t data, double dt, cl
 
 void CompensationOptitrack::on_activated()
 {
-    _robot->joints.elbow_flexion->calibrate();
-    _robot->joints.wrist_pronation->set_encoder_position(0);
-}
-
-void CompensationOptitrack::on_def()
-{
-    while (_receiver.available()) {
-        auto data = _receiver.receive();
-
-        std::string buf;
-        buf.resize(data.size());
-        std::transform(data.begin(), data.end(), buf.begin(), [](std::byte b) -> char { return static_cast<char>(b); });
-
-        debug() << buf;
-
-        std::istringstream ts(buf);
-        int tmp;
-
-        ts >> tmp;
-        _Lua = tmp;
-
-        ts >> tmp;
-        _Lfa = tmp;
-
-        ts >> tmp;
-        _l = tmp;
-
-        ts >> tmp;
-        _lambda = tmp;
-
-        ts >> tmp;
-        _lambdaW = tmp;
-
-        ts >> tmp;
-        _threshold = tmp * M_PI / 180.; // dead zone limit for beta change, in rad.
-
-        ts >> tmp;
-        _thresholdW = tmp * M_PI / 180; // dead zone limit for wrist angle change, in rad.
+    if (!Calibration::instance().run({ _robot->joints.elbow_flexion.get() })) {
+        critical() << "Elbow calibration failed, leaving" << _menu->description();
+        _menu->activate_item("exit");
+        return;
     }
+    _robot->joints.wrist_pronation->set_encoder_position(0);
 }
 
 void CompensationOptitrack::listenArduino()
@@ -501,8 +499,16 @@ void CompensationOptitrack::listenArduino()
             _infoSent = 1;
         }
         auto data = _receiverArduino.receive();
-        std::string buf;
-        std::transform(data.begin(), data.end(), buf.begin(), [](std::byte b) { return static_cast<char>(b); });
-        _pinArduino = std::stoi(buf);
+        std::string buf(reinterpret_cast<const char*>(data.data()), data.size());
+        try {
+            _pinArduino = std::stoi(buf);
+        } catch (std::exception&) {
+            warning() << "Invalid Arduino pin value:" << buf;
+        }
     }
 }
+
+Remote::Status CompensationOptitrack::on_params(const std::string& transaction)
+{
+    return _params.stage_raw(transaction) ? Remote::Ok : Remote::Malformed;
+}
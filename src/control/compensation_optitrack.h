@@ -3,16 +3,20 @@
 
 #include "algo/lawopti.h"
 #include "components/external/optitrack/optitrack_listener.h"
+#include "control/remote/command_server.h"
 #include "sam/sam.h"
+#include "utils/param_block.h"
 #include "utils/socket.h"
 #include "utils/threaded_loop.h"
 #include <fstream>
 
-class CompensationOptitrack : public ThreadedLoop {
+class CompensationOptitrack : public ThreadedLoop, public Remote::CommandHandler {
 public:
     explicit CompensationOptitrack(std::shared_ptr<SAM::Components> robot);
     ~CompensationOptitrack() override;
 
+    Remote::Status on_params(const std::string& transaction) override;
+
     void start(std::string filename = std::string());
     void stop();
     void zero();
@@ -26,6 +30,16 @@ private:
         VOL
     };
 
+    struct Parameters {
+        double lua = 0.;
+        double lfa = 0.;
+        double l = 0.;
+        int lambda = 0;
+        int lambda_w = 0;
+        double threshold = 0.; // dead zone limit for beta change, in rad.
+        double threshold_w = 5.; // dead zone limit for wrist angle change, in rad.
+    };
+
     bool setup() override;
     void loop(double dt, clock::time_point time) override;
     void cleanup() override;
@@ -34,11 +48,10 @@ private:
     void on_new_data_compensation(optitrack_data_t data, double dt, clock::time_point time);
     void on_new_data_vol(optitrack_data_t data, double dt, clock::time_point time);
     void read_optiData(optitrack_data_t data);
-    void on_def();
     void listenArduino();
 
     std::shared_ptr<SAM::Components> _robot;
-    Socket _receiver;
+    ParamBlock<Parameters> _params;
     Socket _receiverArduino;
 
     int _previous_elapsed;
@@ -57,12 +70,7 @@ private:
     unsigned int _infoSent;
 
     int _Lt;
-    double _Lua;
-    double _Lfa;
-    double _l;
     int _lsh;
-    int _lambdaW, _lambda;
-    double _thresholdW, _threshold;
     int _pinArduino;
 };
 
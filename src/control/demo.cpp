@@ -1,5 +1,6 @@
 #include "demo.h"
 #include "algo/myocontrol.h"
+#include "sam/calibration.h"
 #include "ui/visual/ledstrip.h"
 #include "utils/check_ptr.h"
 #include "utils/log/log.h"
@@ -16,6 +17,8 @@ Demo::Demo(std::shared_ptr<SAM::Components> robot)
         throw std::runtime_error("Demo is missing components");
     }
 
+    supervise(std::chrono::milliseconds(200), Supervisor::SafeStop);
+
     _menu->set_description("Demo");
     _menu->set_code("demo");
 
@@ -38,13 +41,7 @@ bool Demo::setup()
 {
     _robot->joints.hand->take_ownership();
     _robot->joints.hand->init_sequence();
-    _robot->joints.elbow_flexion->calibrate();
-    if (_robot->joints.wrist_flexion) {
-        _robot->joints.wrist_flexion->calibrate();
-    }
-    _robot->joints.wrist_pronation->calibrate();
-
-    return true;
+    return Calibration::instance().run({ _robot->joints.elbow_flexion.get(), _robot->joints.wrist_flexion.get(), _robot->joints.wrist_pronation.get() });
 }
 
 void Demo::loop(double, clock::time_point)
@@ -127,10 +124,10 @@ void Demo::loop(double, clock::time_point)
         }
     }
 
-    if (!_robot->btn1) {
+    if (_robot->btn1.pressed()) {
         emg[0] = 80;
     }
-    if (!_robot->btn2) {
+    if (_robot->btn2.pressed()) {
         emg[1] = 80;
     }
 
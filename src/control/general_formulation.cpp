@@ -1,4 +1,5 @@
 #include "general_formulation.h"
+#include "sam/calibration.h"
 #include "utils/check_ptr.h"
 #include "utils/log/log.h"
 #include <filesystem>
@@ -7,20 +8,24 @@
 GeneralFormulation::GeneralFormulation(std::shared_ptr<SAM::Components> robot)
     : ThreadedLoop("General Formulation", 0.01)
     , _robot(robot)
+    , _params("params", this)
     , _Lt(40)
-    , _Lua(0.)
-    , _Lfa(0.)
-    , _lhand(0.)
-    , _lambdaW(0)
-    , _lambda(0)
 {
     if (!check_ptr(_robot->joints.elbow_flexion, _robot->joints.wrist_pronation, _robot->joints.wrist_flexion)) { //}, _robot->sensors.optitrack)) {
         throw std::runtime_error("General Formulation Control is missing components");
     }
 
-    if (!_receiver.bind("0.0.0.0", 45454)) {
-        critical() << "CompensationOptitrack: Failed to bind receiver";
-    }
+    _params.add_field("Lua", &Parameters::lua);
+    _params.add_field("Lfa", &Parameters::lfa);
+    _params.add_field("lhand", &Parameters::lhand);
+    _params.add_field("lambda", &Parameters::lambda);
+    _params.add_field("lambdaW", &Parameters::lambda_w);
+    _params.add_field("threshold_pronosup", &Parameters::threshold_pronosup, M_PI / 180.);
+    _params.add_field("threshold_wrist_flex", &Parameters::threshold_wrist_flex, M_PI / 180.);
+    _params.add_field("threshold_elbow", &Parameters::threshold_elbow, M_PI / 180.);
+    _params.start();
+
+    supervise(std::chrono::milliseconds(200), Supervisor::SafeStop);
 
     _menu->set_description("GeneralFormulation");
     _menu->set_code("gf");
@@ -31,12 +36,10 @@ GeneralFormulation::GeneralFormulation(std::shared_ptr<SAM::Components> robot)
     _menu->add_item(_robot->joints.wrist_pronation->menu());
     _menu->add_item(_robot->joints.hand->menu());
 
-    for (int i = 1; i < nbLinks; i++) {
+    for (int i = 0; i < nbLinks; i++) {
+        l[i] = 0.;
         _threshold[i] = 0.;
     }
-    l[0] = _lhand;
-    l[1] = _Lfa;
-    l[2] = _Lua;
 }
 
 GeneralFormulation::~GeneralFormulation()
@@ -59,43 +62,6 @@ void GeneralFormulation::tare_IMU()
     _robot->user_feedback.buzzer->makeNoise(Buzzer::TRIPLE_BUZZ);
 }
 
-void GeneralFormulation::receiveData()
-{
-    printf("in receiveData \n");
-    while (_receiver.available()) {
-        auto data = _receiver.receive();
-        std::string buf;
-        std::transform(data.begin(), data.end(), buf.begin(), [](std::byte b) { return static_cast<char>(b); });
-        std::istringstream ts(buf);
-        int tmp;
-
-        ts >> tmp;
-        l[2] = tmp; // _Lua
-
-        ts >> tmp;
-        l[1] = tmp; // _Lfa
-
-        ts >> tmp;
-        l[0] = tmp; // _lhand
-
-        ts >> tmp;
-        _lambda = tmp;
-
-        ts >> tmp;
-        _lambdaW = tmp;
-        printf("lambdaW:%d\n", _lambdaW);
-
-        ts >> tmp;
-        _threshold[0] = tmp * M_PI / 180.; // dead zone limit for pronosup, in rad.
-
-        ts >> tmp;
-        _threshold[1] = tmp * M_PI / 180; // dead zone limit for wrist flex, in rad.
-
-        ts >> tmp;
-        _threshold[2] = tmp * M_PI / 180; // dead zone limit for elbow flex, in rad.
-    }
-}
-
 void GeneralFormulation::displayPin()
 {
     int pin_down_value = _robot->btn2;
@@ -109,9 +75,9 @@ bool GeneralFormulation::setup()
     // Calibrations
     _robot->joints.hand->take_ownership();
     _robot->joints.hand->init_sequence();
-    _robot->joints.elbow_flexion->calibrate();
-    _robot->joints.wrist_flexion->calibrate();
-    _robot->joints.wrist_pronation->calibrate();
+    if (!Calibration::instance().run({ _robot->joints.elbow_flexion.get(), _robot->joints.wrist_flexion.get(), _robot->joints.wrist_pronation.get() })) {
+        return false;
+    }
 
     _robot->joints.wrist_pronation->set_encoder_position(0);
     std::string filename("GalF");
@@ -137,6 +103,7 @@ bool GeneralFormulation::setup()
     theta[1] = 0.;
     theta[2] = 0.;
     theta[3] = 0.;
+    Remote::CommandServer::instance().set_handler(this);
     return true;
 }
 
@@ -145,12 +112,18 @@ void GeneralFormulation::loop(double, clock::time_point time)
     int init_cnt = 10;
     double timeWithDelta = (time - _start_time).count();
 
-    receiveData();
+    const Parameters& p = _params.get();
+    l[0] = p.lhand;
+    l[1] = p.lfa;
+    l[2] = p.lua;
+    _threshold[0] = p.threshold_pronosup;
+    _threshold[1] = p.threshold_wrist_flex;
+    _threshold[2] = p.threshold_elbow;
 
     _robot->sensors.optitrack->update();
     optitrack_data_t data = _robot->sensors.optitrack->get_last_data();
 
-    double debugData[10];
+    double debugData[3 * nbLinks];
 
     /// WRITE FILE HEADERS
     if (_need_to_write_header) {
@@ -206,10 +179,10 @@ void GeneralFormulation::loop(double, clock::time_point time)
     }
 
     /// WRIST
-    double pronoSupEncoder = _robot->joints.wrist_pronation->read_encoder_position();
-    double wristFlexEncoder = _robot->joints.wrist_flexion->read_encoder_position();
+    double pronoSupEncoder = _robot->joints.wrist_pronation->encoder_position();
+    double wristFlexEncoder = _robot->joints.wrist_flexion->encoder_position();
     /// ELBOW
-    double elbowEncoder = _robot->joints.elbow_flexion->read_encoder_position();
+    double elbowEncoder = _robot->joints.elbow_flexion->encoder_position();
     theta[1] = pronoSupEncoder;
     theta[2] = wristFlexEncoder;
     theta[3] = elbowEncoder;
@@ -231,7 +204,7 @@ void GeneralFormulation::loop(double, clock::time_point time)
     } else {
         _lawJ.rotationMatrices(qHand, qHip, _cnt, init_cnt);
         _lawJ.updateFrames(theta, l);
-        _lawJ.controlLaw(posA, _lambda, _threshold);
+        _lawJ.controlLaw(posA, p.lambda, _threshold);
         Eigen::Matrix<double, nbLinks, 1, Eigen::DontAlign> thetaDot_toSend = _lawJ.returnthetaDot_deg();
         _robot->joints.wrist_pronation->set_velocity_safe(thetaDot_toSend[1]);
         _robot->joints.wrist_flexion->set_velocity_safe(thetaDot_toSend[2]);
@@ -245,7 +218,7 @@ void GeneralFormulation::loop(double, clock::time_point time)
     _file << ' ' << qFA[0] << ' ' << qFA[1] << ' ' << qFA[2] << ' ' << qFA[3];
     /// A COMPLETER !!!!
     _file << ' ' << debugData[0] << ' ' << debugData[1] << ' ' << debugData[2] << ' ' << debugData[3];
-    _file << ' ' << _lambdaW << ' ' << _threshold[0] << ' ' << _threshold[1] << ' ' << _threshold[2] << ' ' << pronoSupEncoder << ' ' << wristFlexEncoder << ' ' << elbowEncoder;
+    _file << ' ' << p.lambda_w << ' ' << _threshold[0] << ' ' << _threshold[1] << ' ' << _threshold[2] << ' ' << pronoSupEncoder << ' ' << wristFlexEncoder << ' ' << elbowEncoder;
     _file << ' ' << data.nRigidBodies;
 
     for (int i = 0; i < data.nRigidBodies; i++) {
@@ -261,9 +234,15 @@ void GeneralFormulation::loop(double, clock::time_point time)
 
 void GeneralFormulation::cleanup()
 {
+    Remote::CommandServer::instance().clear_handler(this);
     _robot->joints.wrist_pronation->forward(0);
     _robot->joints.wrist_flexion->forward(0);
     _robot->joints.elbow_flexion->move_to(0, 20);
     _robot->joints.hand->release_ownership();
     _file.close();
 }
+
+Remote::Status GeneralFormulation::on_params(const std::string& transaction)
+{
+    return _params.stage_raw(transaction) ? Remote::Ok : Remote::Malformed;
+}
@@ -2,26 +2,39 @@
 #define GENERAL_FORMULATION_H
 
 #include "algo/lawjacobian.h"
+#include "control/remote/command_server.h"
 #include "sam/sam.h"
-#include "utils/socket.h"
+#include "utils/param_block.h"
 #include "utils/threaded_loop.h"
 #include <fstream>
 
-class GeneralFormulation : public ThreadedLoop {
+class GeneralFormulation : public ThreadedLoop, public Remote::CommandHandler {
 public:
     explicit GeneralFormulation(std::shared_ptr<SAM::Components> robot);
     ~GeneralFormulation() override;
 
+    Remote::Status on_params(const std::string& transaction) override;
+
 private:
+    struct Parameters {
+        double lua = 0.;
+        double lfa = 0.;
+        double lhand = 0.;
+        int lambda = 0;
+        int lambda_w = 0;
+        double threshold_pronosup = 0.; // dead zone limit for pronosup, in rad.
+        double threshold_wrist_flex = 0.; // dead zone limit for wrist flex, in rad.
+        double threshold_elbow = 0.; // dead zone limit for elbow flex, in rad.
+    };
+
     void tare_IMU();
-    void receiveData();
     void displayPin();
     bool setup() override;
     void loop(double dt, clock::time_point time) override;
     void cleanup() override;
 
     std::shared_ptr<SAM::Components> _robot;
-    Socket _receiver;
+    ParamBlock<Parameters> _params;
     std::ofstream _file;
     bool _need_to_write_header;
     int _cnt;
@@ -29,11 +42,7 @@ private:
 
     LawJacobian _lawJ;
     int _Lt;
-    double _Lua;
-    double _Lfa;
-    double _lhand;
     double l[nbLinks];
-    int _lambdaW, _lambda;
     double theta[nbLinks];
     double _threshold[nbLinks];
 };
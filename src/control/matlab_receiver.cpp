@@ -1,4 +1,5 @@
 #include "matlab_receiver.h"
+#include "sam/calibration.h"
 #include "utils/check_ptr.h"
 #include "utils/log/log.h"
 
@@ -10,14 +11,11 @@ MatlabReceiver::MatlabReceiver(std::shared_ptr<SAM::Components> robot)
         throw std::runtime_error("Matlab Receiver is missing components");
     }
 
+    supervise(std::chrono::milliseconds(200), Supervisor::SafeStop);
+
     _menu->set_description("Matlab receiver");
     _menu->set_code("mr");
 
-    int port = 45456;
-    if (!_socket.bind("0.0.0.0", 45456)) {
-        critical() << "Failed to bind on port" << port;
-    }
-
     _menu->add_item(_robot->joints.wrist_pronation->menu());
     _menu->add_item(_robot->joints.elbow_flexion->menu());
     _menu->add_item(_robot->joints.hand->menu());
@@ -30,25 +28,36 @@ MatlabReceiver::~MatlabReceiver()
 
 bool MatlabReceiver::setup()
 {
-    _robot->joints.elbow_flexion->calibrate();
+    if (!Calibration::instance().run({ _robot->joints.elbow_flexion.get() })) {
+        return false;
+    }
     _robot->joints.hand->take_ownership();
     _robot->joints.hand->init_sequence();
+    {
+        std::lock_guard<std::mutex> lock(_pending_mutex);
+        _pending_commands.clear();
+    }
+    Remote::CommandServer::instance().set_handler(this);
     info() << "MatlabReceiver: Starting";
     return true;
 }
 
 void MatlabReceiver::loop(double, clock::time_point)
 {
-    if (_socket.available()) {
-        std::vector<std::byte> buf = _socket.receive();
-        if (buf.size() > 3) {
-            handle_command(static_cast<Command>(buf[3]));
-        }
+    std::deque<Command> commands;
+    {
+        std::lock_guard<std::mutex> lock(_pending_mutex);
+        commands.swap(_pending_commands);
+    }
+
+    for (Command c : commands) {
+        handle_command(c);
     }
 }
 
 void MatlabReceiver::cleanup()
 {
+    Remote::CommandServer::instance().clear_handler(this);
     _robot->joints.hand->release_ownership();
     _robot->joints.wrist_pronation->forward(0);
     _robot->joints.elbow_flexion->set_velocity_safe(0);
@@ -148,3 +157,21 @@ void MatlabReceiver::handle_command(Command c)
         _robot->joints.elbow_flexion->set_velocity_safe(0);
     }
 }
+
+Remote::Status MatlabReceiver::on_legacy_command(uint8_t command)
+{
+    std::lock_guard<std::mutex> lock(_pending_mutex);
+    if (_pending_commands.size() >= _max_pending_commands) {
+        _pending_commands.pop_front();
+    }
+    _pending_commands.push_back(static_cast<Command>(command));
+    return Remote::Ok;
+}
+
+Remote::Status MatlabReceiver::on_stop()
+{
+    std::lock_guard<std::mutex> lock(_pending_mutex);
+    _pending_commands.clear();
+    _pending_commands.push_back(NONE);
+    return Remote::Ok;
+}
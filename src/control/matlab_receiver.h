@@ -1,11 +1,12 @@
 #ifndef MATLAB_RECEIVER_H
 #define MATLAB_RECEIVER_H
 
+#include "control/remote/command_server.h"
 #include "sam/sam.h"
-#include "utils/socket.h"
 #include "utils/threaded_loop.h"
+#include <deque>
 
-class MatlabReceiver : public ThreadedLoop {
+class MatlabReceiver : public ThreadedLoop, public Remote::CommandHandler {
 public:
     enum Command {
         NONE = 0,
@@ -36,6 +37,9 @@ public:
     explicit MatlabReceiver(std::shared_ptr<SAM::Components> robot);
     ~MatlabReceiver() override;
 
+    Remote::Status on_legacy_command(uint8_t command) override;
+    Remote::Status on_stop() override;
+
 private:
     bool setup() override;
     void loop(double dt, clock::time_point time) override;
@@ -43,7 +47,10 @@ private:
 
     void handle_command(Command c);
 
-    Socket _socket;
+    std::deque<Command> _pending_commands;
+    std::mutex _pending_mutex;
+    static const std::size_t _max_pending_commands = 16;
+
     std::shared_ptr<SAM::Components> _robot;
 };
 
@@ -0,0 +1,222 @@
+#include "command_server.h"
+#include "utils/log/log.h"
+#include <chrono>
+
+namespace Remote {
+
+CommandHandler::~CommandHandler()
+{
+}
+
+Status CommandHandler::on_joint_setpoints(const std::vector<JointSetpoint>&)
+{
+    return Unsupported;
+}
+
+Status CommandHandler::on_hand_action(uint8_t, uint8_t)
+{
+    return Unsupported;
+}
+
+Status CommandHandler::on_hand_posture(uint8_t)
+{
+    return Unsupported;
+}
+
+Status CommandHandler::on_params(const std::string&)
+{
+    return Unsupported;
+}
+
+Status CommandHandler::on_legacy_command(uint8_t)
+{
+    return Unsupported;
+}
+
+Status CommandHandler::on_stop()
+{
+    return Unsupported;
+}
+
+CommandServer::CommandServer()
+    : Worker("remote_commands", Worker::Continuous)
+    , NamedObject("remote")
+    , MenuUser("remote", "Remote command server")
+    , _handler(nullptr)
+    , _has_seq(false)
+    , _last_seq(0)
+    , _received(0)
+    , _lost(0)
+    , _stale(0)
+    , _malformed(0)
+    , _rejected(0)
+    , _last_processing_us(0)
+    , _max_processing_us(0)
+    , _stats_stream("stats", this,
+          Telemetry::Schema()
+              .add("received", Telemetry::Field::UInt32)
+              .add("lost", Telemetry::Field::UInt32)
+              .add("stale", Telemetry::Field::UInt32)
+              .add("malformed", Telemetry::Field::UInt32)
+              .add("rejected", Telemetry::Field::UInt32)
+              .add("processing_us", Telemetry::Field::UInt32)
+              .add("max_processing_us", Telemetry::Field::UInt32),
+          1., Telemetry::Low, std::string(), Telemetry::Packed)
+{
+    _menu->add_item("stats", "Show command statistics", [this](std::string) { show_stats(); });
+
+    if (!_socket.bind("0.0.0.0", default_port)) {
+        critical() << "Remote command server failed to bind on port" << default_port;
+        return;
+    }
+    do_work();
+}
+
+CommandServer::~CommandServer()
+{
+    stop();
+}
+
+CommandServer& CommandServer::instance()
+{
+    static CommandServer s;
+    return s;
+}
+
+void CommandServer::set_handler(CommandHandler* handler)
+{
+    std::lock_guard<std::mutex> lock(_handler_mutex);
+    _handler = handler;
+    _has_seq = false;
+}
+
+void CommandServer::clear_handler(CommandHandler* handler)
+{
+    std::lock_guard<std::mutex> lock(_handler_mutex);
+    if (_handler == handler) {
+        _handler = nullptr;
+    }
+}
+
+void CommandServer::show_stats()
+{
+    info() << "Remote commands: " << _received << " received, " << _lost << " lost, " << _stale << " stale, " << _malformed << " malformed, " << _rejected << " rejected";
+    info() << "Processing time: " << _last_processing_us << " us (max " << _max_processing_us << " us)";
+}
+
+void CommandServer::work()
+{
+    if (!_socket.wait_available(100)) {
+        return;
+    }
+
+    std::vector<std::byte> buf = _socket.receive();
+    if (!buf.empty()) {
+        handle_datagram(buf);
+    }
+}
+
+void CommandServer::handle_datagram(const std::vector<std::byte>& buf)
+{
+    uint64_t t_rx = now_us();
+    ++_received;
+
+    std::optional<Message> msg = decode(buf);
+    if (!msg) {
+        bool has_magic = buf.size() >= 2 && (static_cast<uint16_t>(buf[0]) | static_cast<uint16_t>(buf[1]) << 8) == magic;
+        if (!has_magic && buf.size() > 3) {
+            std::lock_guard<std::mutex> lock(_handler_mutex);
+            if (_handler) {
+                _handler->on_legacy_command(static_cast<uint8_t>(buf[3]));
+            }
+        } else {
+            ++_malformed;
+        }
+        return;
+    }
+
+    Status status = Ok;
+    if (msg->header.type == Ack) {
+        status = Unsupported;
+    } else if (msg->header.type != Ping && !check_sequence(msg->header.seq)) {
+        status = Stale;
+    } else {
+        status = dispatch(*msg);
+    }
+    if (status != Ok && status != Stale) {
+        ++_rejected;
+    }
+
+    uint32_t processing_us = static_cast<uint32_t>(now_us() - t_rx);
+    _last_processing_us = processing_us;
+    if (processing_us > _max_processing_us) {
+        _max_processing_us = processing_us;
+    }
+
+    if (msg->header.flags & AckRequested) {
+        Message ack;
+        ack.header.type = Ack;
+        ack.header.flags = 0;
+        ack.header.seq = msg->header.seq;
+        ack.header.timestamp_us = now_us();
+        ack.ack.seq = msg->header.seq;
+        ack.ack.status = status;
+        ack.ack.echo_timestamp_us = msg->header.timestamp_us;
+        ack.ack.processing_us = processing_us;
+        _socket.reply(encode(ack));
+    }
+
+    _stats_stream.update({ static_cast<double>(_received), static_cast<double>(_lost), static_cast<double>(_stale), static_cast<double>(_malformed),
+        static_cast<double>(_rejected), static_cast<double>(processing_us), static_cast<double>(_max_processing_us) });
+}
+
+Status CommandServer::dispatch(const Message& msg)
+{
+    std::lock_guard<std::mutex> lock(_handler_mutex);
+    if (msg.header.type == Ping) {
+        return Ok;
+    }
+    if (!_handler) {
+        return NoController;
+    }
+
+    switch (msg.header.type) {
+    case JointSetpoints:
+        return _handler->on_joint_setpoints(msg.setpoints);
+    case HandAction:
+        return _handler->on_hand_action(msg.hand_action, msg.hand_speed);
+    case HandPosture:
+        return _handler->on_hand_posture(msg.hand_posture);
+    case Params:
+        return _handler->on_params(msg.params);
+    case LegacyCommand:
+        return _handler->on_legacy_command(msg.legacy_command);
+    case Stop:
+        return _handler->on_stop();
+    default:
+        return Unsupported;
+    }
+}
+
+bool CommandServer::check_sequence(uint32_t seq)
+{
+    // Only called from the server thread, wrap-around safe
+    int32_t diff = static_cast<int32_t>(seq - _last_seq);
+    if (_has_seq && diff <= 0 && diff > -1000) {
+        ++_stale;
+        return false;
+    }
+    if (_has_seq && diff > 1) {
+        _lost += static_cast<uint32_t>(diff - 1);
+    }
+    _has_seq = true;
+    _last_seq = seq;
+    return true;
+}
+
+uint64_t CommandServer::now_us()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}
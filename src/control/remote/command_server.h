@@ -0,0 +1,84 @@
+#ifndef REMOTE_COMMAND_SERVER_H
+#define REMOTE_COMMAND_SERVER_H
+
+#include "protocol.h"
+#include "utils/interfaces/menu_user.h"
+#include "utils/named_object.h"
+#include "utils/socket.h"
+#include "utils/telemetry/telemetry_stream.h"
+#include "utils/worker.h"
+#include <atomic>
+#include <mutex>
+
+namespace Remote {
+
+/**
+ * \brief Receiver of the remote commands, implemented by controllers.
+ *
+ * Callbacks run on the server thread: implementations must only stage the
+ * command and let their own loop apply it.
+ */
+class CommandHandler {
+public:
+    virtual ~CommandHandler();
+
+    virtual Status on_joint_setpoints(const std::vector<JointSetpoint>& setpoints);
+    virtual Status on_hand_action(uint8_t action, uint8_t speed);
+    virtual Status on_hand_posture(uint8_t posture);
+    virtual Status on_params(const std::string& transaction);
+    virtual Status on_legacy_command(uint8_t command);
+    virtual Status on_stop();
+};
+
+/**
+ * \brief Serves the remote control protocol on a single UDP port.
+ *
+ * Messages are dispatched to the active handler, which controllers register
+ * while they are running. Datagrams without the protocol magic are treated
+ * as legacy Matlab commands (command byte at offset 3) and never acknowledged.
+ */
+class CommandServer : public Worker, public NamedObject, public MenuUser {
+public:
+    static CommandServer& instance();
+
+    static constexpr int default_port = 45456;
+
+    void set_handler(CommandHandler* handler);
+    void clear_handler(CommandHandler* handler);
+
+    void show_stats();
+
+private:
+    CommandServer();
+    ~CommandServer() override;
+
+    void work() override;
+
+    void handle_datagram(const std::vector<std::byte>& buf);
+    Status dispatch(const Message& msg);
+    bool check_sequence(uint32_t seq);
+
+    static uint64_t now_us();
+
+    Socket _socket;
+
+    CommandHandler* _handler;
+    std::mutex _handler_mutex;
+
+    std::atomic<bool> _has_seq;
+    uint32_t _last_seq;
+
+    std::atomic<uint32_t> _received;
+    std::atomic<uint32_t> _lost;
+    std::atomic<uint32_t> _stale;
+    std::atomic<uint32_t> _malformed;
+    std::atomic<uint32_t> _rejected;
+    std::atomic<uint32_t> _last_processing_us;
+    std::atomic<uint32_t> _max_processing_us;
+
+    Telemetry::Stream _stats_stream;
+};
+
+}
+
+#endif // REMOTE_COMMAND_SERVER_H
@@ -0,0 +1,183 @@
+#include "protocol.h"
+#include <cstring>
+
+namespace Remote {
+
+namespace {
+
+    class Reader {
+    public:
+        explicit Reader(const std::vector<std::byte>& buf)
+            : _buf(buf)
+            , _pos(0)
+            , _ok(true)
+        {
+        }
+
+        uint64_t le(std::size_t bytes)
+        {
+            if (_pos + bytes > _buf.size()) {
+                _ok = false;
+                return 0;
+            }
+            uint64_t v = 0;
+            for (std::size_t i = 0; i < bytes; ++i) {
+                v |= static_cast<uint64_t>(_buf[_pos + i]) << (8 * i);
+            }
+            _pos += bytes;
+            return v;
+        }
+
+        float f32()
+        {
+            uint32_t u = static_cast<uint32_t>(le(4));
+            float f;
+            std::memcpy(&f, &u, sizeof(f));
+            return f;
+        }
+
+        std::string rest()
+        {
+            std::string s(reinterpret_cast<const char*>(_buf.data()) + _pos, _buf.size() - _pos);
+            _pos = _buf.size();
+            return s;
+        }
+
+        bool ok() const { return _ok; }
+
+    private:
+        const std::vector<std::byte>& _buf;
+        std::size_t _pos;
+        bool _ok;
+    };
+
+    void put_le(std::vector<std::byte>& out, uint64_t v, std::size_t bytes)
+    {
+        for (std::size_t i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<std::byte>((v >> (8 * i)) & 0xff));
+        }
+    }
+
+    void put_f32(std::vector<std::byte>& out, float f)
+    {
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        put_le(out, u, 4);
+    }
+
+}
+
+std::optional<Message> decode(const std::vector<std::byte>& buf)
+{
+    Reader r(buf);
+    if (r.le(2) != magic || r.le(1) != version) {
+        return std::nullopt;
+    }
+
+    Message msg;
+    msg.header.type = static_cast<MessageType>(r.le(1));
+    msg.header.flags = static_cast<uint8_t>(r.le(1));
+    r.le(3);
+    msg.header.seq = static_cast<uint32_t>(r.le(4));
+    msg.header.timestamp_us = r.le(8);
+
+    switch (msg.header.type) {
+    case Ping:
+    case Stop:
+        break;
+    case JointSetpoints: {
+        std::size_t count = r.le(1);
+        for (std::size_t i = 0; i < count && r.ok(); ++i) {
+            JointSetpoint sp;
+            sp.joint = static_cast<JointId>(r.le(1));
+            sp.mode = static_cast<JointSetpoint::Mode>(r.le(1));
+            sp.value = r.f32();
+            sp.speed = r.f32();
+            if (sp.joint >= JointCount || sp.mode > JointSetpoint::Position) {
+                return std::nullopt;
+            }
+            msg.setpoints.push_back(sp);
+        }
+        break;
+    }
+    case HandAction:
+        msg.hand_action = static_cast<uint8_t>(r.le(1));
+        msg.hand_speed = static_cast<uint8_t>(r.le(1));
+        break;
+    case HandPosture:
+        msg.hand_posture = static_cast<uint8_t>(r.le(1));
+        break;
+    case Params:
+        msg.params = r.rest();
+        break;
+    case LegacyCommand:
+        msg.legacy_command = static_cast<uint8_t>(r.le(1));
+        break;
+    case Ack:
+        msg.ack.seq = static_cast<uint32_t>(r.le(4));
+        msg.ack.status = static_cast<Status>(r.le(1));
+        msg.ack.echo_timestamp_us = r.le(8);
+        msg.ack.processing_us = static_cast<uint32_t>(r.le(4));
+        break;
+    default:
+        return std::nullopt;
+    }
+
+    if (!r.ok()) {
+        return std::nullopt;
+    }
+    return msg;
+}
+
+std::vector<std::byte> encode(const Message& msg)
+{
+    std::vector<std::byte> out;
+    out.reserve(header_size + 32);
+
+    put_le(out, magic, 2);
+    put_le(out, version, 1);
+    put_le(out, msg.header.type, 1);
+    put_le(out, msg.header.flags, 1);
+    put_le(out, 0, 3);
+    put_le(out, msg.header.seq, 4);
+    put_le(out, msg.header.timestamp_us, 8);
+
+    switch (msg.header.type) {
+    case JointSetpoints:
+        put_le(out, msg.setpoints.size(), 1);
+        for (const JointSetpoint& sp : msg.setpoints) {
+            put_le(out, sp.joint, 1);
+            put_le(out, sp.mode, 1);
+            put_f32(out, sp.value);
+            put_f32(out, sp.speed);
+        }
+        break;
+    case HandAction:
+        put_le(out, msg.hand_action, 1);
+        put_le(out, msg.hand_speed, 1);
+        break;
+    case HandPosture:
+        put_le(out, msg.hand_posture, 1);
+        break;
+    case Params:
+        for (char c : msg.params) {
+            out.push_back(static_cast<std::byte>(c));
+        }
+        break;
+    case LegacyCommand:
+        put_le(out, msg.legacy_command, 1);
+        break;
+    case Ack:
+        put_le(out, msg.ack.seq, 4);
+        put_le(out, msg.ack.status, 1);
+        put_le(out, msg.ack.echo_timestamp_us, 8);
+        put_le(out, msg.ack.processing_us, 4);
+        break;
+    default:
+        break;
+    }
+
+    return out;
+}
+
+}
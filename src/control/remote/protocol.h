@@ -0,0 +1,109 @@
+#ifndef REMOTE_PROTOCOL_H
+#define REMOTE_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Remote control protocol, one UDP datagram per message, little-endian.
+ *
+ * Header (20 bytes):
+ *   u16 magic (0x5341), u8 version, u8 type, u8 flags, u8[3] reserved,
+ *   u32 sequence number, u64 sender timestamp in us.
+ *
+ * Payloads:
+ *   JointSetpoints: u8 count, then count * { u8 joint, u8 mode, f32 value, f32 speed }
+ *   HandAction:     u8 action, u8 speed (0xff keeps the current speed)
+ *   HandPosture:    u8 posture
+ *   Params:         ASCII parameter transaction (see ParamBlock)
+ *   LegacyCommand:  u8 MatlabReceiver command
+ *   Ack:            u32 acked sequence, u8 status, u64 echoed sender timestamp,
+ *                   u32 processing time in us
+ *
+ * Every message with the AckRequested flag is acknowledged; the header of an
+ * Ack carries the server timestamp.
+ */
+namespace Remote {
+
+static const uint16_t magic = 0x5341;
+static const uint8_t version = 1;
+static const std::size_t header_size = 20;
+
+enum MessageType : uint8_t {
+    Ping = 0x01,
+    JointSetpoints = 0x02,
+    HandAction = 0x03,
+    HandPosture = 0x04,
+    Params = 0x05,
+    LegacyCommand = 0x06,
+    Stop = 0x07,
+    Ack = 0x80
+};
+
+enum Flags : uint8_t {
+    AckRequested = 0x01
+};
+
+enum Status : uint8_t {
+    Ok = 0,
+    NoController = 1,
+    Unsupported = 2,
+    Malformed = 3,
+    Stale = 4,
+    Rejected = 5
+};
+
+enum JointId : uint8_t {
+    ElbowFlexion = 0,
+    WristPronation = 1,
+    WristFlexion = 2,
+    ShoulderMedialRotation = 3,
+    JointCount
+};
+
+struct JointSetpoint {
+    enum Mode : uint8_t {
+        Velocity = 0, // value in deg/s
+        Position = 1 // value in deg, reached at speed deg/s
+    };
+
+    JointId joint;
+    Mode mode;
+    float value;
+    float speed;
+};
+
+struct Header {
+    MessageType type;
+    uint8_t flags;
+    uint32_t seq;
+    uint64_t timestamp_us;
+};
+
+struct AckPayload {
+    uint32_t seq;
+    Status status;
+    uint64_t echo_timestamp_us;
+    uint32_t processing_us;
+};
+
+struct Message {
+    Header header;
+    std::vector<JointSetpoint> setpoints;
+    uint8_t hand_action = 0;
+    uint8_t hand_speed = 0xff;
+    uint8_t hand_posture = 0;
+    uint8_t legacy_command = 0;
+    std::string params;
+    AckPayload ack = {};
+};
+
+std::optional<Message> decode(const std::vector<std::byte>& buf);
+std::vector<std::byte> encode(const Message& msg);
+
+}
+
+#endif // REMOTE_PROTOCOL_H
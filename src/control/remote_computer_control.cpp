@@ -1,15 +1,23 @@
 #include "remote_computer_control.h"
+#include "sam/calibration.h"
 #include "utils/check_ptr.h"
+#include <cmath>
 
 RemoteComputerControl::RemoteComputerControl(std::shared_ptr<SAM::Components> robot)
     : ThreadedLoop("remote_computer_control", .01)
     , _robot(robot)
+    , _joints({ _robot->joints.elbow_flexion.get(), _robot->joints.wrist_pronation.get(), _robot->joints.wrist_flexion.get(), _robot->joints.shoulder_medial_rotation.get() })
+    , _pending_stop(false)
+    , _velocity_active()
+    , _setpoint_timeout("setpoint_timeout", BaseParam::ReadWrite, this, 0.2)
 {
     if (!check_ptr(_robot->joints.elbow_flexion, _robot->joints.wrist_pronation, _robot->joints.hand)) {
         throw std::runtime_error("Remote Computer Control is missing components");
     }
 
-    _menu->set_description("Remote control with keyboard");
+    supervise(std::chrono::milliseconds(200), Supervisor::SafeStop);
+
+    _menu->set_description("Remote control from a computer");
     _menu->set_code("key");
     _menu->add_item(_robot->joints.wrist_pronation->menu());
     _menu->add_item(_robot->joints.elbow_flexion->menu());
@@ -25,38 +33,154 @@ bool RemoteComputerControl::setup()
 {
     _robot->user_feedback.buzzer->makeNoise(Buzzer::SHORT_BUZZ);
 
-    _robot->joints.hand->setPosture(TouchBionicsHand::HAND_POSTURE);
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    using Step = TouchBionicsHand::Step;
+    using namespace std::chrono_literals;
 
+    // The hand plays its sequence while the elbow is calibrated
     _robot->joints.hand->set_speed(5);
+    _robot->joints.hand->play({ { Step::Posture, TouchBionicsHand::HAND_POSTURE, 100ms },
+        { Step::Move, TouchBionicsHand::HAND_OPENING_ALL, 1s },
+        { Step::Move, TouchBionicsHand::HAND_CLOSING, 1s },
+        { Step::Move, TouchBionicsHand::HAND_OPENING, 1s },
+        { Step::Move, TouchBionicsHand::THUMB_INT_CLOSING, 0ms } });
 
-    _robot->joints.hand->move(TouchBionicsHand::HAND_CLOSING);
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-
-    _robot->joints.hand->move(TouchBionicsHand::HAND_OPENING);
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-
-    _robot->joints.hand->move(TouchBionicsHand::THUMB_INT_CLOSING);
-
-    _robot->joints.elbow_flexion->calibrate();
+    if (!Calibration::instance().run({ _robot->joints.elbow_flexion.get() })) {
+        return false;
+    }
     _robot->joints.wrist_pronation->set_encoder_position(0);
 
-    _robot->joints.hand->move(TouchBionicsHand::HAND_CLOSING_ALL);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    _robot->joints.hand->play({ { Step::Move, TouchBionicsHand::HAND_CLOSING_ALL, 500ms },
+        { Step::Move, TouchBionicsHand::HAND_OPENING_ALL, 0ms } });
 
-    _robot->joints.hand->move(TouchBionicsHand::HAND_OPENING_ALL);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    {
+        std::lock_guard<std::mutex> lock(_pending_mutex);
+        _pending_setpoints = {};
+        _pending_hand_action.reset();
+        _pending_hand_posture.reset();
+        _pending_stop = false;
+    }
+    _velocity_active = {};
+    Remote::CommandServer::instance().set_handler(this);
 
     return true;
 }
 
-void RemoteComputerControl::loop(double, clock::time_point)
+void RemoteComputerControl::loop(double, clock::time_point time)
 {
+    std::array<std::optional<Remote::JointSetpoint>, Remote::JointCount> setpoints;
+    std::optional<std::pair<uint8_t, uint8_t>> hand_action;
+    std::optional<uint8_t> hand_posture;
+    bool stop;
+    {
+        std::lock_guard<std::mutex> lock(_pending_mutex);
+        setpoints.swap(_pending_setpoints);
+        hand_action.swap(_pending_hand_action);
+        hand_posture.swap(_pending_hand_posture);
+        stop = _pending_stop;
+        _pending_stop = false;
+    }
+
+    if (stop) {
+        stop_joints();
+        _robot->joints.hand->move(TouchBionicsHand::STOP);
+        return;
+    }
+
+    double timeout_s = _setpoint_timeout;
+    auto timeout = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(timeout_s));
+    for (std::size_t i = 0; i < Remote::JointCount; ++i) {
+        if (setpoints[i]) {
+            if (setpoints[i]->mode == Remote::JointSetpoint::Velocity) {
+                _joints[i]->set_velocity_safe(setpoints[i]->value);
+                _velocity_active[i] = true;
+                _velocity_deadlines[i] = time + timeout;
+            } else {
+                _joints[i]->move_to(setpoints[i]->value, setpoints[i]->speed);
+                _velocity_active[i] = false;
+            }
+        } else if (_velocity_active[i] && time > _velocity_deadlines[i]) {
+            _joints[i]->set_velocity_safe(0);
+            _velocity_active[i] = false;
+        }
+    }
+
+    if (hand_posture) {
+        _robot->joints.hand->setPosture(static_cast<TouchBionicsHand::POSTURE>(*hand_posture));
+    }
+    if (hand_action) {
+        if (hand_action->second != 0xff) {
+            _robot->joints.hand->set_speed(hand_action->second);
+        }
+        _robot->joints.hand->move(hand_action->first);
+    }
 }
 
 void RemoteComputerControl::cleanup()
 {
-    _robot->joints.elbow_flexion->forward(0);
-    _robot->joints.wrist_pronation->forward(0);
+    Remote::CommandServer::instance().clear_handler(this);
+    // Ends the trajectories, then stops the uncalibrated joints it skipped
+    stop_joints();
+    for (Actuator* joint : _joints) {
+        if (joint) {
+            joint->forward(0);
+        }
+    }
     _robot->joints.hand->move(TouchBionicsHand::HAND_CLOSING_ALL);
 }
+
+void RemoteComputerControl::stop_joints()
+{
+    for (std::size_t i = 0; i < Remote::JointCount; ++i) {
+        if (_joints[i]) {
+            _joints[i]->set_velocity_safe(0);
+        }
+        _velocity_active[i] = false;
+    }
+}
+
+Remote::Status RemoteComputerControl::on_joint_setpoints(const std::vector<Remote::JointSetpoint>& setpoints)
+{
+    for (const Remote::JointSetpoint& sp : setpoints) {
+        if (!_joints[sp.joint] || !std::isfinite(sp.value) || !std::isfinite(sp.speed) || (sp.mode == Remote::JointSetpoint::Position && sp.speed <= 0.f)) {
+            return Remote::Rejected;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_pending_mutex);
+    for (const Remote::JointSetpoint& sp : setpoints) {
+        _pending_setpoints[sp.joint] = sp;
+    }
+    return Remote::Ok;
+}
+
+Remote::Status RemoteComputerControl::on_hand_action(uint8_t action, uint8_t speed)
+{
+    if (action > TouchBionicsHand::TRIPLE_PINCH_OPENING) {
+        return Remote::Rejected;
+    }
+
+    std::lock_guard<std::mutex> lock(_pending_mutex);
+    _pending_hand_action = std::make_pair(action, speed);
+    return Remote::Ok;
+}
+
+Remote::Status RemoteComputerControl::on_hand_posture(uint8_t posture)
+{
+    if (posture > TouchBionicsHand::ONLY_THUMB_POSTURE && posture != TouchBionicsHand::GLOVE_POSTURE) {
+        return Remote::Rejected;
+    }
+
+    std::lock_guard<std::mutex> lock(_pending_mutex);
+    _pending_hand_posture = posture;
+    return Remote::Ok;
+}
+
+Remote::Status RemoteComputerControl::on_stop()
+{
+    std::lock_guard<std::mutex> lock(_pending_mutex);
+    _pending_setpoints = {};
+    _pending_hand_action.reset();
+    _pending_hand_posture.reset();
+    _pending_stop = true;
+    return Remote::Ok;
+}
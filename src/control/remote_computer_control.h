@@ -1,20 +1,49 @@
 #ifndef REMOTECOMPUTERCONTROL_H
 #define REMOTECOMPUTERCONTROL_H
 
+#include "control/remote/command_server.h"
 #include "sam/sam.h"
 #include "utils/threaded_loop.h"
+#include <array>
+#include <optional>
 
-class RemoteComputerControl : public ThreadedLoop {
+/**
+ * \brief Applies the setpoints streamed by a remote computer.
+ *
+ * Commands are received by the Remote::CommandServer and only the latest one
+ * per joint is applied at each tick. Velocity setpoints that are not refreshed
+ * within "setpoint_timeout" seconds stop the joint.
+ */
+class RemoteComputerControl : public ThreadedLoop, public Remote::CommandHandler {
 public:
     explicit RemoteComputerControl(std::shared_ptr<SAM::Components> robot);
     ~RemoteComputerControl() override;
 
+    Remote::Status on_joint_setpoints(const std::vector<Remote::JointSetpoint>& setpoints) override;
+    Remote::Status on_hand_action(uint8_t action, uint8_t speed) override;
+    Remote::Status on_hand_posture(uint8_t posture) override;
+    Remote::Status on_stop() override;
+
 private:
     bool setup() override;
     void loop(double dt, clock::time_point time) override;
     void cleanup() override;
 
+    void stop_joints();
+
     std::shared_ptr<SAM::Components> _robot;
+    std::array<Actuator*, Remote::JointCount> _joints;
+
+    std::mutex _pending_mutex;
+    std::array<std::optional<Remote::JointSetpoint>, Remote::JointCount> _pending_setpoints;
+    std::optional<std::pair<uint8_t, uint8_t>> _pending_hand_action;
+    std::optional<uint8_t> _pending_hand_posture;
+    bool _pending_stop;
+
+    std::array<clock::time_point, Remote::JointCount> _velocity_deadlines;
+    std::array<bool, Remote::JointCount> _velocity_active;
+
+    Param<double> _setpoint_timeout;
 };
 
 #endif // REMOTECOMPUTERCONTROL_H
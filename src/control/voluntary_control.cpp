@@ -6,6 +6,8 @@
 VoluntaryControl::VoluntaryControl(std::shared_ptr<SAM::Components> robot)
     : ThreadedLoop("Voluntary control")
     , _robot(robot)
+    , _need_to_write_header(false)
+    , _wrist_command(NoCommand)
 {
     if (!check_ptr(_robot->joints.elbow_flexion, _robot->joints.wrist_pronation)) {
         throw std::runtime_error("Volontary Control is missing components");
@@ -13,6 +15,8 @@ VoluntaryControl::VoluntaryControl(std::shared_ptr<SAM::Components> robot)
 
     set_period(0.01);
 
+    supervise(std::chrono::milliseconds(200), Supervisor::SafeStop);
+
     _menu->set_description("Voluntary Control");
     _menu->set_code("vc");
     _menu->add_item(_robot->joints.elbow_flexion->menu());
@@ -44,12 +48,24 @@ bool VoluntaryControl::setup()
         return false;
     }
     _need_to_write_header = true;
+
+    _wrist_command = NoCommand;
+    _robot->btn1.subscribe(this, [this](Button::Event e, Button::clock::time_point) { on_button(e, Supinate); });
+    _robot->btn2.subscribe(this, [this](Button::Event e, Button::clock::time_point) { on_button(e, Pronate); });
     return true;
 }
 
+void VoluntaryControl::on_button(Button::Event event, WristCommand on_down)
+{
+    if (event == Button::Down) {
+        _wrist_command = on_down;
+    } else if (event == Button::Up && !_robot->btn1.pressed() && !_robot->btn2.pressed()) {
+        _wrist_command = StopWrist;
+    }
+}
+
 void VoluntaryControl::loop(double, clock::time_point)
 {
-    static int prev_pin_up_value = 1, prev_pin_down_value = 1;
     int pin_down_value = _robot->btn2;
     int pin_up_value = _robot->btn1;
 
@@ -67,19 +83,20 @@ void VoluntaryControl::loop(double, clock::time_point)
     //    }
 
     /// WRIST
-    double wristAngle = _robot->joints.wrist_pronation->read_encoder_position();
+    double wristAngle = _robot->joints.wrist_pronation->encoder_position();
 
-    if (pin_down_value == 0 && prev_pin_down_value == 1) {
+    switch (_wrist_command.exchange(NoCommand)) {
+    case Pronate:
         _robot->joints.wrist_pronation->move_to(6000, 5000, 6000, 35000);
-    } else if (pin_up_value == 0 && prev_pin_up_value == 1) {
+        break;
+    case Supinate:
         _robot->joints.wrist_pronation->move_to(6000, 5000, 6000, -35000);
-    } else if ((pin_down_value == 1 && pin_up_value == 1) && (prev_pin_down_value == 0 || prev_pin_up_value == 0)) {
+        break;
+    case StopWrist:
         _robot->joints.wrist_pronation->forward(0);
+        break;
     }
 
-    prev_pin_down_value = pin_down_value;
-    prev_pin_up_value = pin_up_value;
-
     optitrack_data_t data = _robot->sensors.optitrack->get_last_data();
     double qBras[4], qTronc[4];
     _robot->sensors.trunk_imu->get_quat(qTronc);
@@ -107,6 +124,8 @@ void VoluntaryControl::loop(double, clock::time_point)
 
 void VoluntaryControl::cleanup()
 {
+    _robot->btn1.unsubscribe(this);
+    _robot->btn2.unsubscribe(this);
     //_robot.elbow->forward(0);
     _robot->joints.wrist_pronation->forward(0);
     _file.close();
@@ -3,6 +3,7 @@
 
 #include "sam/sam.h"
 #include "utils/threaded_loop.h"
+#include <atomic>
 #include <fstream>
 
 class VoluntaryControl : public ThreadedLoop {
@@ -11,14 +12,25 @@ public:
     ~VoluntaryControl() override;
 
 private:
+    enum WristCommand {
+        NoCommand,
+        Pronate,
+        Supinate,
+        StopWrist
+    };
+
     bool setup() override;
     void loop(double dt, clock::time_point time) override;
     void cleanup() override;
 
+    void on_button(Button::Event event, WristCommand on_down);
+
     std::ofstream _file;
 
     std::shared_ptr<SAM::Components> _robot;
     bool _need_to_write_header;
+    // Staged by the button callbacks, applied by the loop
+    std::atomic<int> _wrist_command;
 };
 
 #endif // VOLUNTARYCONTROL_H
@@ -0,0 +1,131 @@
+#include "host_platform.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace HAL {
+
+Platform& Platform::instance()
+{
+    static HostPlatform platform;
+    return platform;
+}
+
+std::unique_ptr<I2C::Backend> HostPlatform::i2c(const std::string&)
+{
+    auto backend = std::make_unique<I2C::FakeBackend>();
+    // ADS1115, config register at its reset value
+    backend->add_device(0x48);
+    backend->set_register(0x48, 1, 0x8583);
+    // MCP4728
+    backend->add_device(0x60);
+    return backend;
+}
+
+void HostGPIO::configure(int pin, bool output, Pull pull)
+{
+    std::lock_guard lock(_mutex);
+    if (!output) {
+        _levels[pin] = pull == Pull::Up;
+    }
+}
+
+void HostGPIO::write(int pin, bool value)
+{
+    std::lock_guard lock(_mutex);
+    _levels[pin] = value;
+}
+
+bool HostGPIO::read(int pin)
+{
+    std::lock_guard lock(_mutex);
+    return _levels[pin];
+}
+
+std::unique_ptr<EdgeSource> HostGPIO::edges(int pin, Edge edge, const std::string&)
+{
+    return std::make_unique<HostEdgeSource>(*this, pin, edge);
+}
+
+void HostGPIO::set_input(int pin, bool value)
+{
+    std::chrono::steady_clock::time_point stamp = std::chrono::steady_clock::now();
+    std::lock_guard lock(_mutex);
+    bool& level = _levels[pin];
+    if (level == value) {
+        return;
+    }
+    level = value;
+    for (HostEdgeSource* source : _sources) {
+        if (source->_pin == pin) {
+            source->push(value, stamp);
+        }
+    }
+}
+
+HostEdgeSource::HostEdgeSource(HostGPIO& gpio, int pin, Edge edge)
+    : _gpio(gpio)
+    , _pin(pin)
+    , _edge(edge)
+{
+    // One count per queued event, so the fd stays readable until the last one is read
+    _fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+    if (_fd < 0) {
+        throw std::runtime_error(std::string("Failed to create edge eventfd: ") + strerror(errno));
+    }
+
+    std::lock_guard lock(_gpio._mutex);
+    _gpio._sources.push_back(this);
+}
+
+HostEdgeSource::~HostEdgeSource()
+{
+    {
+        std::lock_guard lock(_gpio._mutex);
+        _gpio._sources.erase(std::remove(_gpio._sources.begin(), _gpio._sources.end(), this), _gpio._sources.end());
+    }
+    close(_fd);
+}
+
+std::optional<EdgeEvent> HostEdgeSource::read()
+{
+    std::lock_guard lock(_gpio._mutex);
+    eventfd_t count;
+    if (_events.empty() || eventfd_read(_fd, &count) != 0) {
+        return std::nullopt;
+    }
+    EdgeEvent event = _events.front();
+    _events.pop_front();
+    return event;
+}
+
+bool HostEdgeSource::level()
+{
+    return _gpio.read(_pin);
+}
+
+// Called by HostGPIO with its lock held
+void HostEdgeSource::push(bool rising, std::chrono::steady_clock::time_point stamp)
+{
+    if ((rising && _edge == Edge::Falling) || (!rising && _edge == Edge::Rising)) {
+        return;
+    }
+    _events.push_back({ rising, stamp });
+    eventfd_write(_fd, 1);
+}
+
+HostSPI::HostSPI()
+    : _frames(0)
+    , _bytes(0)
+{
+}
+
+void HostSPI::write(const uint8_t*, std::size_t size)
+{
+    ++_frames;
+    _bytes += size;
+}
+
+}
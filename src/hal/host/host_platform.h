@@ -0,0 +1,94 @@
+#ifndef HAL_HOST_PLATFORM_H
+#define HAL_HOST_PLATFORM_H
+
+#include "hal/platform.h"
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace HAL {
+
+class HostGPIO;
+
+// Edges produced by HostGPIO::set_input(), stamped when the level is set
+class HostEdgeSource : public EdgeSource {
+public:
+    HostEdgeSource(HostGPIO& gpio, int pin, Edge edge);
+    ~HostEdgeSource() override;
+
+    int fd() const override { return _fd; }
+    std::optional<EdgeEvent> read() override;
+    bool level() override;
+
+private:
+    friend class HostGPIO;
+
+    void push(bool rising, std::chrono::steady_clock::time_point stamp);
+
+    HostGPIO& _gpio;
+    int _pin;
+    Edge _edge;
+    int _fd;
+    std::deque<EdgeEvent> _events;
+};
+
+/**
+ * \brief In-memory pins. Inputs rest at their pull level until set_input(),
+ * which also raises the edge events of the pin.
+ */
+class HostGPIO : public GPIOController {
+public:
+    void configure(int pin, bool output, Pull pull) override;
+    void write(int pin, bool value) override;
+    bool read(int pin) override;
+    std::unique_ptr<EdgeSource> edges(int pin, Edge edge, const std::string& consumer) override;
+
+    void set_input(int pin, bool value);
+
+private:
+    friend class HostEdgeSource;
+
+    std::map<int, bool> _levels;
+    std::vector<HostEdgeSource*> _sources;
+    std::mutex _mutex;
+};
+
+// Frames are counted and dropped
+class HostSPI : public SPIController {
+public:
+    HostSPI();
+
+    bool begin() override { return true; }
+    void end() override {}
+    void write(const uint8_t* data, std::size_t size) override;
+
+    std::size_t frames() const { return _frames; }
+    std::size_t bytes() const { return _bytes; }
+
+private:
+    std::atomic<std::size_t> _frames;
+    std::atomic<std::size_t> _bytes;
+};
+
+/**
+ * \brief Development machine. The I2C buses hold a simulated ADS1115 and
+ * MCP4728 clocked at 400 kHz, so the acquisition timing stays realistic.
+ */
+class HostPlatform : public Platform {
+public:
+    std::string name() const override { return "host"; }
+
+    GPIOController& gpio() override { return _gpio; }
+    SPIController& spi() override { return _spi; }
+    std::unique_ptr<I2C::Backend> i2c(const std::string& device) override;
+
+private:
+    HostGPIO _gpio;
+    HostSPI _spi;
+};
+
+}
+
+#endif // HAL_HOST_PLATFORM_H
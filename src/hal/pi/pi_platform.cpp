@@ -0,0 +1,152 @@
+#include "pi_platform.h"
+#include "utils/log/log.h"
+#include <bcm2835.h>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <stdexcept>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace HAL {
+
+Platform& Platform::instance()
+{
+    static PiPlatform platform;
+    return platform;
+}
+
+PiPlatform::PiPlatform()
+{
+    if (!bcm2835_init()) {
+        critical() << "bcm2835_init failed";
+    }
+}
+
+PiPlatform::~PiPlatform()
+{
+    bcm2835_close();
+}
+
+std::unique_ptr<I2C::Backend> PiPlatform::i2c(const std::string& device)
+{
+    return std::make_unique<I2C::DeviceBackend>(device);
+}
+
+void PiGPIO::configure(int pin, bool output, Pull pull)
+{
+    bcm2835_gpio_fsel(pin, output ? BCM2835_GPIO_FSEL_OUTP : BCM2835_GPIO_FSEL_INPT);
+
+    switch (pull) {
+    case Pull::Up:
+        bcm2835_gpio_set_pud(pin, BCM2835_GPIO_PUD_UP);
+        break;
+    case Pull::Down:
+        bcm2835_gpio_set_pud(pin, BCM2835_GPIO_PUD_DOWN);
+        break;
+    case Pull::None:
+        bcm2835_gpio_set_pud(pin, BCM2835_GPIO_PUD_OFF);
+        break;
+    }
+}
+
+void PiGPIO::write(int pin, bool value)
+{
+    bcm2835_gpio_write(pin, value ? HIGH : LOW);
+}
+
+bool PiGPIO::read(int pin)
+{
+    return bcm2835_gpio_lev(pin) == HIGH;
+}
+
+std::unique_ptr<EdgeSource> PiGPIO::edges(int pin, Edge edge, const std::string& consumer)
+{
+    return std::make_unique<PiEdgeSource>(pin, edge, consumer);
+}
+
+PiEdgeSource::PiEdgeSource(int pin, Edge edge, const std::string& consumer, const std::string& chip)
+    : _fd(-1)
+{
+    int chip_fd = open(chip.c_str(), O_RDONLY | O_CLOEXEC);
+    if (chip_fd < 0) {
+        throw std::runtime_error("Failed to open " + chip + ": " + strerror(errno));
+    }
+
+    gpioevent_request request;
+    std::memset(&request, 0, sizeof(request));
+    request.lineoffset = static_cast<uint32_t>(pin);
+    request.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    switch (edge) {
+    case Edge::Rising:
+        request.eventflags = GPIOEVENT_REQUEST_RISING_EDGE;
+        break;
+    case Edge::Falling:
+        request.eventflags = GPIOEVENT_REQUEST_FALLING_EDGE;
+        break;
+    case Edge::Both:
+        request.eventflags = GPIOEVENT_REQUEST_BOTH_EDGES;
+        break;
+    }
+    std::strncpy(request.consumer_label, consumer.c_str(), sizeof(request.consumer_label) - 1);
+
+    int ret = ioctl(chip_fd, GPIO_GET_LINEEVENT_IOCTL, &request);
+    int err = errno;
+    close(chip_fd);
+    if (ret < 0) {
+        throw std::runtime_error("Failed to request edge events on GPIO " + std::to_string(pin) + ": " + strerror(err));
+    }
+    _fd = request.fd;
+    fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) | O_NONBLOCK);
+}
+
+PiEdgeSource::~PiEdgeSource()
+{
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+std::optional<EdgeEvent> PiEdgeSource::read()
+{
+    gpioevent_data data;
+    if (::read(_fd, &data, sizeof(data)) != sizeof(data)) {
+        return std::nullopt;
+    }
+
+    // Event timestamps are taken on CLOCK_MONOTONIC, the steady clock
+    EdgeEvent event;
+    event.rising = data.id == GPIOEVENT_EVENT_RISING_EDGE;
+    event.stamp = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(data.timestamp)));
+    return event;
+}
+
+bool PiEdgeSource::level()
+{
+    gpiohandle_data data;
+    std::memset(&data, 0, sizeof(data));
+    ioctl(_fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data);
+    return data.values[0];
+}
+
+bool PiSPI::begin()
+{
+    if (!bcm2835_spi_begin()) {
+        return false;
+    }
+    bcm2835_spi_setClockDivider(BCM2835_SPI_CLOCK_DIVIDER_512);
+    bcm2835_spi_chipSelect(BCM2835_SPI_CS0);
+    return true;
+}
+
+void PiSPI::end()
+{
+    bcm2835_spi_end();
+}
+
+void PiSPI::write(const uint8_t* data, std::size_t size)
+{
+    bcm2835_spi_writenb(reinterpret_cast<const char*>(data), static_cast<uint32_t>(size));
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef HAL_PI_PLATFORM_H
+#define HAL_PI_PLATFORM_H
+
+#include "hal/platform.h"
+
+namespace HAL {
+
+// Line event of the GPIO character device, timestamped by the kernel in its interrupt handler
+class PiEdgeSource : public EdgeSource {
+public:
+    PiEdgeSource(int pin, Edge edge, const std::string& consumer, const std::string& chip = "/dev/gpiochip0");
+    ~PiEdgeSource() override;
+
+    int fd() const override { return _fd; }
+    std::optional<EdgeEvent> read() override;
+    bool level() override;
+
+private:
+    int _fd;
+};
+
+class PiGPIO : public GPIOController {
+public:
+    void configure(int pin, bool output, Pull pull) override;
+    void write(int pin, bool value) override;
+    bool read(int pin) override;
+    std::unique_ptr<EdgeSource> edges(int pin, Edge edge, const std::string& consumer) override;
+};
+
+class PiSPI : public SPIController {
+public:
+    bool begin() override;
+    void end() override;
+    void write(const uint8_t* data, std::size_t size) override;
+};
+
+/**
+ * \brief Raspberry Pi: GPIO and SPI0 through bcm2835, I2C through i2c-dev.
+ */
+class PiPlatform : public Platform {
+public:
+    PiPlatform();
+    ~PiPlatform() override;
+
+    std::string name() const override { return "pi"; }
+
+    GPIOController& gpio() override { return _gpio; }
+    SPIController& spi() override { return _spi; }
+    std::unique_ptr<I2C::Backend> i2c(const std::string& device) override;
+
+private:
+    PiGPIO _gpio;
+    PiSPI _spi;
+};
+
+}
+
+#endif // HAL_PI_PLATFORM_H
@@ -0,0 +1,21 @@
+#include "platform.h"
+
+namespace HAL {
+
+EdgeSource::~EdgeSource()
+{
+}
+
+GPIOController::~GPIOController()
+{
+}
+
+SPIController::~SPIController()
+{
+}
+
+Platform::~Platform()
+{
+}
+
+}
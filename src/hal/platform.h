@@ -0,0 +1,85 @@
+#ifndef HAL_PLATFORM_H
+#define HAL_PLATFORM_H
+
+#include "utils/i2c/backend.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+/**
+ * \brief Access to the board peripherals.
+ *
+ * The backend is selected at build time with the "platform" meson option:
+ * "pi" drives the Raspberry Pi through bcm2835 and i2c-dev, "host" simulates
+ * the peripherals so the application runs on a development machine.
+ * Monitors only read procfs and sysfs and need no backend.
+ */
+namespace HAL {
+
+enum class Pull {
+    Up,
+    Down,
+    None
+};
+
+enum class Edge {
+    Rising,
+    Falling,
+    Both
+};
+
+struct EdgeEvent {
+    bool rising;
+    std::chrono::steady_clock::time_point stamp;
+};
+
+// Edges of one input line, queued until read. fd() is readable while some are pending.
+class EdgeSource {
+public:
+    virtual ~EdgeSource();
+
+    virtual int fd() const = 0;
+    virtual std::optional<EdgeEvent> read() = 0;
+    virtual bool level() = 0;
+};
+
+class GPIOController {
+public:
+    virtual ~GPIOController();
+
+    virtual void configure(int pin, bool output, Pull pull) = 0;
+    virtual void write(int pin, bool value) = 0;
+    virtual bool read(int pin) = 0;
+    // Throws if the line cannot deliver edge events
+    virtual std::unique_ptr<EdgeSource> edges(int pin, Edge edge, const std::string& consumer) = 0;
+};
+
+// The bus of the LED strip
+class SPIController {
+public:
+    virtual ~SPIController();
+
+    virtual bool begin() = 0;
+    virtual void end() = 0;
+    virtual void write(const uint8_t* data, std::size_t size) = 0;
+};
+
+class Platform {
+public:
+    static Platform& instance();
+
+    virtual ~Platform();
+
+    virtual std::string name() const = 0;
+
+    virtual GPIOController& gpio() = 0;
+    virtual SPIController& spi() = 0;
+    virtual std::unique_ptr<I2C::Backend> i2c(const std::string& device) = 0;
+};
+
+}
+
+#endif // HAL_PLATFORM_H
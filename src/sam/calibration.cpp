@@ -0,0 +1,234 @@
+#include "calibration.h"
+#include "utils/log/log.h"
+#include <algorithm>
+#include <fstream>
+#include <future>
+
+const std::string Calibration::_path = "/var/lib/sam/calibration";
+
+Calibration::Calibration()
+    : NamedObject("calibration")
+    , MenuUser("calib", "Joint calibration")
+    , _homing(false)
+{
+    _menu->add_item("status", "Show calibration status", [this](std::string) { show_status(); });
+    _menu->add_item("home", "Home every joint", [this](std::string) { home_all(); });
+    _menu->add_item("save", "Save encoder positions", [this](std::string) { save(); });
+    _menu->add_item("forget", "Forget saved positions", [this](std::string) { forget(); });
+
+    load();
+}
+
+Calibration::~Calibration()
+{
+    if (_homing_thread.joinable()) {
+        _homing_thread.join();
+    }
+}
+
+Calibration& Calibration::instance()
+{
+    static Calibration c;
+    return c;
+}
+
+void Calibration::add_joint(Actuator* joint)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (joint && std::find(_joints.begin(), _joints.end(), joint) == _joints.end()) {
+        _joints.push_back(joint);
+    }
+}
+
+void Calibration::remove_joint(Actuator* joint)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _joints.erase(std::remove(_joints.begin(), _joints.end(), joint), _joints.end());
+}
+
+void Calibration::set_controllers_active(std::function<bool()> controllers_active)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _controllers_active = controllers_active;
+}
+
+void Calibration::home_all()
+{
+    std::vector<Actuator*> joints;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_controllers_active && _controllers_active()) {
+            warning() << "Stop the active controller before homing";
+            return;
+        }
+        joints = _joints;
+    }
+
+    if (_homing) {
+        warning() << "Homing already in progress";
+        return;
+    }
+    if (_homing_thread.joinable()) {
+        _homing_thread.join();
+    }
+
+    _homing = true;
+    _homing_thread = std::thread([this, joints] {
+        run(joints, true);
+        _homing = false;
+    });
+}
+
+bool Calibration::run(std::vector<Actuator*> joints, bool force)
+{
+    std::lock_guard<std::mutex> run_lock(_run_mutex);
+
+    joints.erase(std::remove(joints.begin(), joints.end(), nullptr), joints.end());
+
+    std::map<std::pair<std::string, uint8_t>, std::vector<Actuator*>> controllers;
+    for (Actuator* joint : joints) {
+        add_joint(joint);
+        if (!force && (joint->calibrated() || try_restore(joint))) {
+            continue;
+        }
+        set_state(joint, Pending);
+        controllers[std::make_pair(joint->port_name(), joint->address())].push_back(joint);
+    }
+
+    std::vector<std::future<bool>> results;
+    for (auto& c : controllers) {
+        std::vector<Actuator*> group = c.second;
+        results.push_back(std::async(std::launch::async, [this, group] {
+            bool ok = true;
+            for (Actuator* joint : group) {
+                set_state(joint, Homing);
+                try {
+                    joint->calibrate();
+                    set_state(joint, Done);
+                } catch (std::exception& e) {
+                    critical() << "Calibration of" << joint->name() << "failed:" << e.what();
+                    set_state(joint, Failed);
+                    ok = false;
+                }
+            }
+            return ok;
+        }));
+    }
+
+    bool ok = true;
+    for (auto& r : results) {
+        ok = r.get() && ok;
+    }
+
+    save();
+    return ok;
+}
+
+bool Calibration::try_restore(Actuator* joint)
+{
+    int32_t saved;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _persisted.find(joint->name());
+        if (it == _persisted.end()) {
+            return false;
+        }
+        saved = it->second;
+    }
+
+    // A power cycled RoboClaw restarts at zero, so a parked joint near zero proves nothing
+    if (std::abs(saved) <= _restore_tolerance) {
+        return false;
+    }
+
+    try {
+        if (std::abs(joint->encoder_position() - saved) > _restore_tolerance) {
+            return false;
+        }
+        joint->mark_calibrated();
+    } catch (std::exception&) {
+        return false;
+    }
+
+    info() << joint->name() << "calibration restored";
+    set_state(joint, Restored);
+    return true;
+}
+
+void Calibration::load()
+{
+    std::ifstream file(_path);
+    std::string name;
+    int32_t position;
+    while (file >> name >> position) {
+        _persisted[name] = position;
+    }
+}
+
+void Calibration::save()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (Actuator* joint : _joints) {
+        if (!joint->calibrated()) {
+            _persisted.erase(joint->name());
+            continue;
+        }
+        try {
+            _persisted[joint->name()] = joint->encoder_position();
+        } catch (std::exception&) {
+            _persisted.erase(joint->name());
+        }
+    }
+
+    std::ofstream file(_path, std::ios::trunc);
+    if (!file.good()) {
+        warning() << "Failed to save calibration to" << _path;
+        return;
+    }
+    for (auto& p : _persisted) {
+        file << p.first << ' ' << p.second << '\n';
+    }
+}
+
+void Calibration::forget()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _persisted.clear();
+    std::ofstream file(_path, std::ios::trunc);
+}
+
+void Calibration::show_status()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (Actuator* joint : _joints) {
+        auto it = _states.find(joint->name());
+        info() << joint->name() << ":" << (it != _states.end() ? state_name(it->second) : (joint->calibrated() ? "calibrated" : "not calibrated"));
+    }
+}
+
+void Calibration::set_state(Actuator* joint, State state)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _states[joint->name()] = state;
+    }
+    _mqtt.publish(full_name() + "/" + joint->name(), state_name(state), Mosquittopp::Client::QoS1, true);
+}
+
+std::string Calibration::state_name(State state)
+{
+    switch (state) {
+    case Pending:
+        return "pending";
+    case Homing:
+        return "homing";
+    case Done:
+        return "done";
+    case Restored:
+        return "restored";
+    case Failed:
+        return "failed";
+    }
+    return "";
+}
@@ -0,0 +1,80 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include "components/internal/actuators/actuator.h"
+#include "utils/interfaces/menu_user.h"
+#include "utils/interfaces/mqtt_user.h"
+#include "utils/named_object.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Homes several joints concurrently.
+ *
+ * Joints driven by different RoboClaw controllers home in parallel, joints
+ * sharing a controller home one after the other so a single power stage never
+ * drives two end stop searches at once.
+ *
+ * Encoder positions are persisted once a joint is calibrated and on exit. On
+ * the next start, a joint whose controller still reports the persisted
+ * position kept its power and is marked calibrated without homing.
+ *
+ * Progress is published on sam/calibration/<joint> (retained).
+ *
+ * Homing from the menu runs on a thread owned by the calibration, and is
+ * refused while a controller is active.
+ */
+class Calibration : public NamedObject, public MqttUser, public MenuUser {
+public:
+    static Calibration& instance();
+
+    void add_joint(Actuator* joint);
+    void remove_joint(Actuator* joint);
+
+    // Blocks until every joint is homed or failed
+    bool run(std::vector<Actuator*> joints, bool force = false);
+
+    void save();
+    void forget();
+    void show_status();
+
+    // Tells whether a controller is driving the joints
+    void set_controllers_active(std::function<bool()> controllers_active);
+
+private:
+    enum State {
+        Pending,
+        Homing,
+        Done,
+        Restored,
+        Failed
+    };
+
+    Calibration();
+    ~Calibration() override;
+
+    void home_all();
+    void load();
+    bool try_restore(Actuator* joint);
+    void set_state(Actuator* joint, State state);
+    static std::string state_name(State state);
+
+    std::vector<Actuator*> _joints;
+    std::map<std::string, State> _states;
+    std::map<std::string, int32_t> _persisted;
+    std::mutex _mutex;
+    std::mutex _run_mutex;
+
+    std::function<bool()> _controllers_active;
+    std::thread _homing_thread;
+    std::atomic<bool> _homing;
+
+    static const std::string _path;
+    static const int32_t _restore_tolerance = 50; // encoder steps
+};
+
+#endif // CALIBRATION_H
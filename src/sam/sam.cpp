@@ -14,6 +14,9 @@ Sensors::Sensors()
     fa_imu = Components::make_component<XIMU>("yellow_imu", "/dev/ximu_yellow", XIMU::XIMU_LOGLEVEL_NONE, B115200);
 
     adc = Components::make_component<Adafruit_ADS1115>("adc", "/dev/i2c-1", 0x48);
+    if (adc) {
+        adc_acquisition = std::make_unique<ADS1115Acquisition>(*adc);
+    }
 
     optitrack = Components::make_component<OptiListener>("optitrack");
     if (optitrack) {
@@ -25,7 +28,8 @@ UserFeedback::UserFeedback()
 {
     buzzer = std::make_unique<Buzzer>(29);
     buzzer->set_prio(90);
-    buzzer->set_preferred_cpu(2);
+    // Off the core of the control loops, the tone wakes the thread up to 10k times per second
+    buzzer->set_preferred_cpu(3);
 
     leds = std::make_unique<LedStrip>();
 }
@@ -46,12 +50,34 @@ Joints::Joints()
     if (!elbow_flexion) {
         elbow_flexion = Components::make_component<OsmerElbow>("elbow_v1");
     }
+
+    for (Actuator* joint : actuators()) {
+        joint->attach();
+    }
+}
+
+Joints::~Joints()
+{
+    for (Actuator* joint : actuators()) {
+        joint->detach();
+    }
+}
+
+std::vector<Actuator*> Joints::actuators()
+{
+    std::vector<Actuator*> joints;
+    for (Actuator* joint : std::initializer_list<Actuator*> { wrist_pronation.get(), wrist_flexion.get(), elbow_flexion.get(), shoulder_medial_rotation.get() }) {
+        if (joint) {
+            joints.push_back(joint);
+        }
+    }
+    return joints;
 }
 
 Components::Components()
-    : demo_gpio(28, GPIO::DIR_INPUT, GPIO::PULL_UP)
-    , btn1(24, GPIO::DIR_INPUT, GPIO::PULL_UP)
-    , btn2(22, GPIO::DIR_INPUT, GPIO::PULL_UP)
+    : demo_gpio(28, "demo")
+    , btn1(24, "btn1")
+    , btn2(22, "btn2")
 {
 }
 }
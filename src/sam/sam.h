@@ -12,22 +12,23 @@
 #include "components/internal/actuators/wrist_flexor.h"
 #include "components/internal/actuators/wrist_rotator.h"
 #include "components/internal/adc/adafruit_ads1115.h"
-#include "components/internal/gpio/gpio.h"
+#include "components/internal/adc/ads1115_acquisition.h"
+#include "components/internal/gpio/button.h"
 #include "components/internal/hand/touch_bionics_hand.h"
 #include "ui/sound/buzzer.h"
 #include "ui/visual/ledstrip.h"
 #include "utils/log/log.h"
+#include "utils/bus/endpoint.h"
 #include "utils/named_object.h"
-#include "ux/mosquittopp/client.h"
 #include <memory>
+#include <vector>
 
 namespace SAM {
 
 template <typename U, typename... Ts>
 std::unique_ptr<U> make_generic(std::string type, std::string name, Ts... args)
 {
-    Mosquittopp::Client mqtt;
-    mqtt.connect(MOSQUITTO_SERVER_IP, MOSQUITTO_SERVER_PORT);
+    Bus::Endpoint mqtt;
 
     std::unique_ptr<U> p;
     try {
@@ -49,6 +50,8 @@ public:
     std::unique_ptr<XIMU> trunk_imu;
     std::unique_ptr<XIMU> fa_imu;
     std::unique_ptr<Adafruit_ADS1115> adc;
+    // Owns adc while it runs
+    std::unique_ptr<ADS1115Acquisition> adc_acquisition;
     std::unique_ptr<OptiListener> optitrack;
 };
 
@@ -63,6 +66,9 @@ public:
 class Joints {
 public:
     Joints();
+    ~Joints();
+
+    std::vector<Actuator*> actuators();
 
     std::unique_ptr<Actuator> wrist_pronation;
     std::unique_ptr<WristFlexor> wrist_flexion;
@@ -79,9 +85,9 @@ public:
     Sensors sensors;
     Joints joints;
 
-    GPIO demo_gpio;
-    GPIO btn1;
-    GPIO btn2;
+    Button demo_gpio;
+    Button btn1;
+    Button btn2;
 
     template <typename U, typename... Ts>
     inline static std::unique_ptr<U> make_component(std::string name, Ts... args)
@@ -1,12 +1,19 @@
 #include "samanager.h"
+#include "calibration.h"
+#include "components/internal/actuators/roboclaw/bus_monitor.h"
+#include "control/remote/command_server.h"
+#include "hal/platform.h"
+#include "utils/i2c/i2c_bus.h"
 #include "utils/log/log.h"
+#include "utils/supervisor.h"
+#include "utils/telemetry/scheduler.h"
+#include "utils/trace/tracer.h"
 #include <unistd.h>
-#include <bcm2835.h>
 
 SAManager::SAManager()
     : _main_menu(std::make_unique<MenuBackend>("main", "Main menu", [this] { _cv.notify_one(); }))
 {
-    bcm2835_init();
+    info() << "Running on the " << HAL::Platform::instance().name() << " platform";
 
     if (isatty(fileno(stdin))) {
         _menu_console_binding = std::make_unique<MenuConsole>();
@@ -21,6 +28,15 @@ SAManager::SAManager()
 
 SAManager::~SAManager()
 {
+    Supervisor::instance().set_safe_stop(nullptr);
+
+    Calibration& calibration = Calibration::instance();
+    calibration.set_controllers_active(nullptr);
+    calibration.save();
+    calibration.remove_joint(_robot->joints.elbow_flexion.get());
+    calibration.remove_joint(_robot->joints.wrist_flexion.get());
+    calibration.remove_joint(_robot->joints.wrist_pronation.get());
+
     _menu_mqtt_binding->show_message("Exited gracefully.");
     if (_robot->user_feedback.leds)
         _robot->user_feedback.leds->set(LedStrip::none, 10);
@@ -31,7 +47,21 @@ void SAManager::run()
     _robot = std::make_shared<SAM::Components>();
     _robot->user_feedback.leds->set(LedStrip::white, 10);
 
+    Calibration::instance().add_joint(_robot->joints.elbow_flexion.get());
+    Calibration::instance().add_joint(_robot->joints.wrist_flexion.get());
+    Calibration::instance().add_joint(_robot->joints.wrist_pronation.get());
+
     instantiate_controllers();
+    Supervisor::instance().set_safe_stop([this] { safe_stop(); });
+    Calibration::instance().set_controllers_active([this] {
+        for (ThreadedLoop* controller : std::initializer_list<ThreadedLoop*> { _vc.get(), _galf.get(), _opti.get(), _rm.get(), _mr.get(), _demo.get() }) {
+            if (controller && controller->running()) {
+                return true;
+            }
+        }
+        return false;
+    });
+
     fill_menus();
     autostart_demo();
 
@@ -39,6 +69,26 @@ void SAManager::run()
     _cv.wait(lock);
 }
 
+// From the supervisor thread: nothing may block or throw
+void SAManager::safe_stop()
+{
+    // Stopped first, so that they don't command the joints again. Not joined,
+    // the loop that missed its deadline may be one of them.
+    for (ThreadedLoop* controller : std::initializer_list<ThreadedLoop*> { _vc.get(), _galf.get(), _opti.get(), _rm.get(), _mr.get(), _demo.get() }) {
+        if (controller) {
+            controller->stop();
+        }
+    }
+
+    for (Actuator* joint : _robot->joints.actuators()) {
+        try {
+            joint->forward(0);
+        } catch (std::exception& e) {
+            critical() << "Failed to stop " << joint->name() << ": " << e.what();
+        }
+    }
+}
+
 void SAManager::fill_menus()
 {
     std::shared_ptr<MenuBackend> buzzer_submenu = std::make_shared<MenuBackend>("buzzer", "Buzzer submenu");
@@ -52,12 +102,25 @@ void SAManager::fill_menus()
     _main_menu->add_submenu_from_user(_robot->joints.wrist_pronation);
     _main_menu->add_submenu_from_user(_robot->joints.elbow_flexion);
     _main_menu->add_submenu_from_user(_robot->joints.hand);
+    _main_menu->add_submenu_from_user(_robot->sensors.adc_acquisition);
+    for (I2C::Bus* bus : I2C::Bus::opened()) {
+        _main_menu->add_item(bus->menu());
+    }
     _main_menu->add_submenu_from_user(_vc);
     _main_menu->add_submenu_from_user(_rm);
     _main_menu->add_submenu_from_user(_mr);
     _main_menu->add_submenu_from_user(_opti);
     _main_menu->add_submenu_from_user(_demo);
     _main_menu->add_submenu_from_user(_galf);
+    _main_menu->add_item(Telemetry::Scheduler::instance().menu());
+    _main_menu->add_item(Remote::CommandServer::instance().menu());
+    _main_menu->add_item(Calibration::instance().menu());
+    _main_menu->add_item(RC::BusMonitor::instance().menu());
+    _main_menu->add_item(ButtonService::instance().menu());
+    _main_menu->add_item(Supervisor::instance().menu());
+    _main_menu->add_item(Trace::Tracer::instance().menu());
+    _main_menu->add_item("thr", "Show per-thread usage", [this](std::string) { _sm->show_threads(); });
+    _main_menu->add_item("lat", "Show wake-up latencies", [this](std::string) { _sm->show_latency(); });
 
     _main_menu->activate();
 }
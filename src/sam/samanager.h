@@ -27,6 +27,7 @@ private:
     void fill_menus();
     void instantiate_controllers();
     void autostart_demo();
+    void safe_stop();
 
     std::condition_variable _cv;
     std::mutex _cv_mutex;
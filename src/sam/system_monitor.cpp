@@ -1,9 +1,17 @@
 #include "system_monitor.h"
-#include <iterator>
-#include <sstream>
+#include "utils/log/log.h"
+#include <algorithm>
+#include <cctype>
 
 SystemMonitor::SystemMonitor()
     : ThreadedLoop("system_monitor", 1)
+    , _latency_probe(this)
+    // The text of the legacy topics is the one of the former formatted_output()
+    , _load_stream("cpu_load", this, Telemetry::Schema().add("total", Telemetry::Field::Float32, { 6, true, "" }).add_array("cpu", Monitoring::CPULoadMonitor::cpu_count(), Telemetry::Field::Float32, { 6, true, "" }), 1., Telemetry::High, "system/cpu_load")
+    , _temp_stream("cpu_temp", this, Telemetry::Schema().add("celsius", Telemetry::Field::Float32, { 4, false, "°C" }), 1., Telemetry::High, "system/cpu_temp")
+    , _freq_stream("cpu_freq", this, Telemetry::Schema().add("mhz", Telemetry::Field::Float32, { 6, false, "MHz" }), 1., Telemetry::High, "system/cpu_freq")
+    , _process_stream("process", this, Telemetry::Schema().add("rss_kb", Telemetry::Field::UInt32).add("minor_faults", Telemetry::Field::Float32).add("major_faults", Telemetry::Field::Float32).add("voluntary_switches", Telemetry::Field::Float32).add("involuntary_switches", Telemetry::Field::Float32), 1., Telemetry::Normal, "system/process", Telemetry::Packed)
+    , _latency_stream("latency", this, Telemetry::Schema().add_array("max_us", Monitoring::LatencyProbe::cpu_count(), Telemetry::Field::Float32).add_array("avg_us", Monitoring::LatencyProbe::cpu_count(), Telemetry::Field::Float32), 1., Telemetry::Normal, "system/latency", Telemetry::Packed)
 {
 }
 
@@ -20,15 +28,69 @@ bool SystemMonitor::setup()
 void SystemMonitor::loop(double, clock::time_point)
 {
     _load_mon.update();
-    _mqtt.publish("system/cpu_load", _load_mon.formatted_output());
+    _load_stream.update(_load_mon.values());
 
     _temp_mon.update();
-    _mqtt.publish("system/cpu_temp", _temp_mon.formatted_output());
+    _temp_stream.update(_temp_mon.values());
 
     _freq_mon.update();
-    _mqtt.publish("system/cpu_freq", _freq_mon.formatted_output());
+    _freq_stream.update(_freq_mon.values());
+
+    std::lock_guard lock(_mutex);
+    _process_mon.update();
+    _process_stream.update(_process_mon.values());
+    _thread_mon.update();
+    publish_threads();
+
+    _latency_probe.update();
+    _latency_stream.update(_latency_probe.values());
 }
 
 void SystemMonitor::cleanup()
 {
+    std::lock_guard lock(_mutex);
+    _latency_probe.stop();
+}
+
+// Threads sharing a name, e.g. the workers of a pool, are summed up
+void SystemMonitor::publish_threads()
+{
+    std::map<std::string, std::vector<double>> values;
+    for (const Monitoring::ThreadMonitor::Thread& t : _thread_mon.threads()) {
+        std::string name = t.name;
+        std::replace_if(
+            name.begin(), name.end(), [](char c) { return !std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-'; }, '_');
+
+        std::vector<double>& v = values[name];
+        v.resize(5, 0.);
+        v[0] += t.cpu_load;
+        v[1] += t.minor_faults;
+        v[2] += t.major_faults;
+        v[3] += t.voluntary_switches;
+        v[4] += t.involuntary_switches;
+    }
+
+    for (auto& v : values) {
+        std::unique_ptr<Telemetry::Stream>& stream = _thread_streams[v.first];
+        if (!stream) {
+            Telemetry::Schema schema = Telemetry::Schema().add("cpu_load", Telemetry::Field::Float32).add("minor_faults", Telemetry::Field::Float32).add("major_faults", Telemetry::Field::Float32).add("voluntary_switches", Telemetry::Field::Float32).add("involuntary_switches", Telemetry::Field::Float32);
+            stream = std::make_unique<Telemetry::Stream>("thread_" + v.first, this, schema, 1., Telemetry::Low, "system/threads/" + v.first, Telemetry::Packed);
+        }
+        stream->update(v.second);
+    }
+}
+
+void SystemMonitor::show_threads()
+{
+    std::lock_guard lock(_mutex);
+    info() << _process_mon.formatted_output();
+    info() << "\n"
+           << _thread_mon.formatted_output();
+}
+
+void SystemMonitor::show_latency()
+{
+    std::lock_guard lock(_mutex);
+    info() << "\n"
+           << _latency_probe.report();
 }
@@ -1,27 +1,48 @@
 #ifndef SYSTEMMONITOR_H
 #define SYSTEMMONITOR_H
 
-#include "utils/interfaces/mqtt_user.h"
 #include "utils/monitoring/cpu_freq_monitor.h"
 #include "utils/monitoring/cpu_load_monitor.h"
 #include "utils/monitoring/cpu_temp_monitor.h"
+#include "utils/monitoring/latency_probe.h"
+#include "utils/monitoring/process_monitor.h"
+#include "utils/monitoring/thread_monitor.h"
+#include "utils/telemetry/telemetry_stream.h"
 #include "utils/threaded_loop.h"
 #include <fstream>
+#include <map>
 #include <memory>
 
-class SystemMonitor : public ThreadedLoop, public MqttUser {
+class SystemMonitor : public ThreadedLoop {
 public:
     explicit SystemMonitor();
     ~SystemMonitor() override;
 
+    void show_threads();
+    void show_latency();
+
 private:
     bool setup() override;
     void loop(double dt, clock::time_point time) override;
     void cleanup() override;
 
+    void publish_threads();
+
     Monitoring::CPUFreqMonitor _freq_mon;
     Monitoring::CPULoadMonitor _load_mon;
     Monitoring::CPUTempMonitor _temp_mon;
+    Monitoring::ProcessMonitor _process_mon;
+    Monitoring::ThreadMonitor _thread_mon;
+    Monitoring::LatencyProbe _latency_probe;
+
+    Telemetry::Stream _load_stream;
+    Telemetry::Stream _temp_stream;
+    Telemetry::Stream _freq_stream;
+    Telemetry::Stream _process_stream;
+    Telemetry::Stream _latency_stream;
+
+    // One per thread name, created when the name first shows up
+    std::map<std::string, std::unique_ptr<Telemetry::Stream>> _thread_streams;
 };
 
 #endif // SYSTEMMONITOR_H
@@ -5,7 +5,7 @@ MenuMQTT::MenuMQTT()
     : MenuFrontend()
 {
     connect_to_backend();
-    _mqtt.subscribe("sam/menu/input", Mosquittopp::Client::QoS2)->add_callback(this, [](Mosquittopp::Message msg) { MenuBackend::broker.handle_input(msg.payload()); });
+    _mqtt.subscribe("sam/menu/input", [](std::string payload) { MenuBackend::broker.handle_input(payload); }, Mosquittopp::Client::QoS2);
 }
 
 void MenuMQTT::show_menu(std::string title, std::map<std::string, std::shared_ptr<MenuItem> > items)
@@ -1,73 +1,179 @@
 #include "buzzer.h"
+#include "utils/log/log.h"
+#include <algorithm>
+#include <stdexcept>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 Buzzer::Buzzer(int pin)
     : ThreadedLoop("buzzer", 0.)
     , _gpio(pin, GPIO::DIR_OUTPUT, GPIO::PULL_NONE)
+    , _playing(-1)
+    , _preempt(false)
 {
     _gpio = 0;
+
+    _timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (_timer_fd < 0) {
+        throw std::runtime_error("Buzzer: timerfd_create failed");
+    }
+
+    start();
 }
 
 Buzzer::~Buzzer()
 {
+    stop();
+    silence();
     stop_and_join();
+    close(_timer_fd);
 }
 
-bool Buzzer::setup()
+void Buzzer::makeNoise(BUZZ_TYPE buzz_type, int freq)
 {
-    return true;
+    if (buzz_type == NO_BUZZ) {
+        return;
+    }
+    play(pattern(buzz_type, freq), buzz_type == ERROR_BUZZ ? Alert : Normal);
 }
 
-void Buzzer::loop(double, clock::time_point)
+void Buzzer::play(Pattern pattern, Priority priority)
 {
-    for (; _cfg.n_buzzes > 0; --_cfg.n_buzzes) {
-        for (int i = 0; i < _cfg.n_pulses; i++) {
-            _gpio = 1;
-            std::this_thread::sleep_for(std::chrono::microseconds(_cfg.half_period_us));
-            _gpio = 0;
-            std::this_thread::sleep_for(std::chrono::microseconds(_cfg.half_period_us));
+    {
+        std::lock_guard lock(_queue_mutex);
+        if (_queue.size() >= max_queued) {
+            if (priority == Normal || _queue.back().priority == Alert) {
+                debug() << "Buzzer queue full, pattern dropped";
+                return;
+            }
+            _queue.pop_back();
+        }
+
+        auto it = std::find_if(_queue.begin(), _queue.end(), [priority](const Queued& q) { return q.priority < priority; });
+        _queue.insert(it, { std::move(pattern), priority });
+
+        if (_playing >= 0 && priority > _playing) {
+            _preempt = true;
         }
-        if (_cfg.n_buzzes > 0)
-            std::this_thread::sleep_for(std::chrono::microseconds(_cfg.time_between_buzzes_us));
     }
-    stop();
+    _queue_cv.notify_all();
 }
 
-void Buzzer::cleanup()
+void Buzzer::silence()
 {
+    {
+        std::lock_guard lock(_queue_mutex);
+        _queue.clear();
+        if (_playing >= 0) {
+            _preempt = true;
+        }
+    }
+    _queue_cv.notify_all();
 }
 
-void Buzzer::makeNoise(BUZZ_TYPE buzz_type, int freq)
+Buzzer::Pattern Buzzer::pattern(BUZZ_TYPE buzz_type, int freq)
 {
-    if (_thread.joinable()) {
-        _thread.join();
-    }
+    // The pin used to be toggled every 1/freq s: keep the same pitch
+    int tone_hz = freq / 2;
+    auto pulses = [freq](int n) { return std::chrono::microseconds(static_cast<int64_t>(2e6 * n / freq)); };
 
-    _cfg.n_pulses = 500;
-    _cfg.half_period_us = static_cast<int>(1000000. / freq);
-    _cfg.time_between_buzzes_us = 200000;
-    _cfg.n_buzzes = 1;
+    int n_buzzes = 1;
+    int n_pulses = 500;
+    std::chrono::microseconds between(200000);
 
     switch (buzz_type) {
     case NO_BUZZ:
-        return;
+        return Pattern();
     case STANDARD_BUZZ:
         break;
     case DOUBLE_BUZZ:
-        _cfg.n_buzzes = 2;
+        n_buzzes = 2;
         break;
     case TRIPLE_BUZZ:
-        _cfg.n_pulses = 200;
-        _cfg.time_between_buzzes_us = 50000;
-        _cfg.n_buzzes = 3;
+        n_pulses = 200;
+        between = std::chrono::microseconds(50000);
+        n_buzzes = 3;
         break;
     case SHORT_BUZZ:
-        _cfg.n_pulses = 200;
+        n_pulses = 200;
         break;
     case ERROR_BUZZ:
-        _cfg.n_pulses = 200;
-        _cfg.n_buzzes = 15;
+        n_pulses = 200;
+        n_buzzes = 15;
         break;
     }
 
-    start();
+    Pattern p(n_buzzes, Tone { tone_hz, pulses(n_pulses), between });
+    p.back().off = std::chrono::microseconds(0);
+    return p;
+}
+
+void Buzzer::loop(double, clock::time_point)
+{
+    Queued q;
+    {
+        std::unique_lock lock(_queue_mutex);
+        _queue_cv.wait_for(lock, std::chrono::milliseconds(100), [this] { return !_queue.empty() || !_loop_condition; });
+        if (_queue.empty()) {
+            return;
+        }
+        q = std::move(_queue.front());
+        _queue.pop_front();
+        _playing = q.priority;
+        _preempt = false;
+    }
+
+    for (const Tone& tone : q.pattern) {
+        if (!play_tone(tone) || !pause(tone.off)) {
+            break;
+        }
+    }
+
+    std::lock_guard lock(_queue_mutex);
+    _playing = -1;
+}
+
+bool Buzzer::play_tone(const Tone& tone)
+{
+    if (tone.freq_hz <= 0) {
+        return pause(tone.on);
+    }
+
+    int64_t half_period_ns = 500000000 / tone.freq_hz;
+    uint64_t toggles = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(tone.on).count() / half_period_ns);
+
+    itimerspec its = {};
+    its.it_interval.tv_nsec = half_period_ns % 1000000000;
+    its.it_interval.tv_sec = half_period_ns / 1000000000;
+    its.it_value = its.it_interval;
+    timerfd_settime(_timer_fd, 0, &its, nullptr);
+
+    // Expirations missed by a late wake up are counted, the phase is kept
+    bool level = false;
+    uint64_t done = 0;
+    while (done < toggles && !_preempt) {
+        uint64_t expirations;
+        if (read(_timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            break;
+        }
+        done += expirations;
+        if (expirations & 1) {
+            level = !level;
+            _gpio = level;
+        }
+    }
+
+    its = {};
+    timerfd_settime(_timer_fd, 0, &its, nullptr);
+    _gpio = 0;
+    return !_preempt;
+}
+
+bool Buzzer::pause(std::chrono::microseconds d)
+{
+    if (d.count() <= 0) {
+        return !_preempt;
+    }
+    std::unique_lock lock(_queue_mutex);
+    return !_queue_cv.wait_for(lock, d, [this] { return _preempt.load(); });
 }
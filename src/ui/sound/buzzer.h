@@ -3,9 +3,17 @@
 
 #include "components/internal/gpio/gpio.h"
 #include "utils/threaded_loop.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 
 /**
  * \brief The Buzzer class handles the buzzer on the prosthesis. Through it, you can beep the buzzer in a thread with different patterns.
+ *
+ * Patterns are queued and played by the buzzer thread, callers never wait.
+ * The buzzer pin has no hardware PWM, the tone is toggled on the expirations
+ * of a periodic timerfd. Alerts go before the queued patterns and interrupt
+ * the one being played if it has a lower priority.
  */
 class Buzzer : public ThreadedLoop {
 public:
@@ -18,25 +26,48 @@ public:
         ERROR_BUZZ
     };
 
-    struct BuzzerConfig {
-        int n_buzzes;
-        int n_pulses;
-        int half_period_us;
-        int time_between_buzzes_us;
+    enum Priority {
+        Normal,
+        Alert
     };
 
+    struct Tone {
+        int freq_hz; // 0 for silence
+        std::chrono::microseconds on;
+        std::chrono::microseconds off; // before the next tone
+    };
+    using Pattern = std::vector<Tone>;
+
     Buzzer(int pin);
     ~Buzzer() override;
 
     void makeNoise(BUZZ_TYPE buzz_type = STANDARD_BUZZ, int freq = 10000);
+    void play(Pattern pattern, Priority priority = Normal);
+    void silence();
+
+    static Pattern pattern(BUZZ_TYPE buzz_type, int freq = 10000);
+
+    static const std::size_t max_queued = 8;
 
 private:
-    bool setup() override;
+    struct Queued {
+        Pattern pattern;
+        Priority priority;
+    };
+
     void loop(double dt, clock::time_point time) override;
-    void cleanup() override;
+
+    bool play_tone(const Tone& tone);
+    bool pause(std::chrono::microseconds d);
 
     GPIO _gpio;
-    BuzzerConfig _cfg;
+    int _timer_fd;
+
+    std::deque<Queued> _queue;
+    std::mutex _queue_mutex;
+    std::condition_variable _queue_cv;
+    int _playing; // priority of the pattern being played, -1 if none
+    std::atomic<bool> _preempt;
 };
 
 #endif // BUZZER_H
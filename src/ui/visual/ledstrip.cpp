@@ -1,6 +1,8 @@
 #include "ledstrip.h"
+#include "hal/platform.h"
 #include "utils/log/log.h"
-#include <bcm2835.h>
+#include <algorithm>
+#include <cmath>
 
 static const uint8_t led_value = 50;
 
@@ -11,56 +13,141 @@ LedStrip::color LedStrip::blue(0, 0, led_value, 1);
 LedStrip::color LedStrip::none(0, 0, 0, 0);
 
 LedStrip::LedStrip()
+    : Worker("ledstrip", Worker::Continuous)
+    , _changed(false)
 {
-    if (bcm2835_spi_begin() < 0) {
-        critical() << "bcm2835_spi_begin failed";
+    if (!HAL::Platform::instance().spi().begin()) {
+        critical() << "LED strip SPI initialization failed";
     }
-    bcm2835_spi_setClockDivider(BCM2835_SPI_CLOCK_DIVIDER_512);
-    bcm2835_spi_chipSelect(BCM2835_SPI_CS0);
+
+    do_work();
 }
 
 LedStrip::~LedStrip()
 {
-    bcm2835_spi_end();
+    stop();
+    // Show the last posted state before releasing the bus
+    render(std::chrono::steady_clock::now());
+    HAL::Platform::instance().spi().end();
 }
 
 void LedStrip::set(std::vector<color> colors)
 {
-    send_opening_bytes();
-    for (color c : colors) {
-        send_color_bytes(c);
+    {
+        std::lock_guard lock(_state_mutex);
+        if (colors == _colors && _animations.empty()) {
+            return;
+        }
+        _colors = std::move(colors);
+        _animations.clear();
+        _changed = true;
     }
-    send_closing_bytes();
+    _state_cv.notify_one();
 }
 
 void LedStrip::set(color c, unsigned int n)
 {
-    send_opening_bytes();
-    for (unsigned int i = 0; i < n; ++i) {
-        send_color_bytes(c);
+    set(std::vector<color>(n, c));
+}
+
+void LedStrip::blink(color c, duration period, std::size_t first, std::size_t count)
+{
+    animate(Animation::Blink, c, period, first, count);
+}
+
+void LedStrip::breathe(color c, duration period, std::size_t first, std::size_t count)
+{
+    animate(Animation::Breathe, c, period, first, count);
+}
+
+void LedStrip::progress(color c, duration total, std::size_t first, std::size_t count)
+{
+    animate(Animation::Progress, c, total, first, count);
+}
+
+void LedStrip::stop_animations()
+{
+    {
+        std::lock_guard lock(_state_mutex);
+        _animations.clear();
+        _changed = true;
     }
-    send_closing_bytes();
+    _state_cv.notify_one();
 }
 
-void LedStrip::send_opening_bytes()
+void LedStrip::animate(Animation::Kind kind, color c, duration period, std::size_t first, std::size_t count)
 {
-    char buf[4] = { 0x00, 0x00, 0x00, 0x00 };
-    bcm2835_spi_writenb(reinterpret_cast<char*>(&buf), 4);
+    {
+        std::lock_guard lock(_state_mutex);
+        _animations.push_back({ kind, c, std::max(period, duration(1)), first, count, std::chrono::steady_clock::now() });
+        _changed = true;
+    }
+    _state_cv.notify_one();
 }
 
-void LedStrip::send_closing_bytes()
+void LedStrip::work()
 {
-    char buf[4] = { 0xff, 0xff, 0xff, 0xff };
-    bcm2835_spi_writenb(reinterpret_cast<char*>(&buf), 4);
+    {
+        std::unique_lock lock(_state_mutex);
+        // Animated frames are rendered periodically, static ones on change
+        auto timeout = _animations.empty() ? std::chrono::milliseconds(100) : animation_period;
+        _state_cv.wait_for(lock, timeout, [this] { return _changed; });
+    }
+    render(std::chrono::steady_clock::now());
 }
 
-void LedStrip::send_color_bytes(color c)
+void LedStrip::render(std::chrono::steady_clock::time_point now)
 {
-    char led_frame[4];
-    led_frame[0] = 0b11100000 | (0b00011111 & c.brightness);
-    led_frame[1] = c.b;
-    led_frame[2] = c.g;
-    led_frame[3] = c.r;
+    std::vector<color> colors;
+    {
+        std::lock_guard lock(_state_mutex);
+        _changed = false;
+        colors = _colors;
 
-    bcm2835_spi_writenb(reinterpret_cast<char*>(&led_frame), 4);
+        for (const Animation& a : _animations) {
+            std::size_t end = a.count == all ? colors.size() : std::min(colors.size(), a.first + a.count);
+            if (a.first >= end) {
+                continue;
+            }
+            double phase = std::fmod(std::chrono::duration<double>(now - a.start).count() / std::chrono::duration<double>(a.period).count(), 1.);
+            switch (a.kind) {
+            case Animation::Blink:
+                std::fill(colors.begin() + a.first, colors.begin() + end, phase < 0.5 ? a.c : none);
+                break;
+            case Animation::Breathe:
+                std::fill(colors.begin() + a.first, colors.begin() + end, scaled(a.c, 0.5 - 0.5 * std::cos(2 * M_PI * phase)));
+                break;
+            case Animation::Progress: {
+                double elapsed = std::min(1., std::chrono::duration<double>(now - a.start).count() / std::chrono::duration<double>(a.period).count());
+                std::size_t lit = static_cast<std::size_t>(std::ceil(elapsed * (end - a.first)));
+                std::fill(colors.begin() + a.first, colors.begin() + a.first + lit, a.c);
+                break;
+            }
+            }
+        }
+    }
+
+    // Start frame, one frame per LED, and at least half a clock per LED
+    // to push the data through the strip
+    std::size_t end_bytes = std::max<std::size_t>(4, (colors.size() + 15) / 16);
+    _frame.assign(4 + 4 * colors.size() + end_bytes, 0);
+    std::size_t i = 4;
+    for (const color& c : colors) {
+        _frame[i++] = static_cast<char>(0b11100000 | (0b00011111 & c.brightness));
+        _frame[i++] = static_cast<char>(c.b);
+        _frame[i++] = static_cast<char>(c.g);
+        _frame[i++] = static_cast<char>(c.r);
+    }
+    std::fill(_frame.begin() + static_cast<long>(i), _frame.end(), static_cast<char>(0xff));
+
+    if (_frame == _sent) {
+        return;
+    }
+    HAL::Platform::instance().spi().write(reinterpret_cast<const uint8_t*>(_frame.data()), _frame.size());
+    _sent.swap(_frame);
+}
+
+LedStrip::color LedStrip::scaled(color c, double factor)
+{
+    return color(static_cast<uint8_t>(c.r * factor), static_cast<uint8_t>(c.g * factor), static_cast<uint8_t>(c.b * factor), c.brightness);
 }
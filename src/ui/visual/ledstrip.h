@@ -1,10 +1,22 @@
 #ifndef LEDSTRIP_H
 #define LEDSTRIP_H
 
+#include "utils/worker.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <stdint.h>
 #include <vector>
 
-class LedStrip {
+/**
+ * \brief APA102 LED strip, rendered by its own thread.
+ *
+ * Callers only post the desired state: static colors with set(), or
+ * animations declared once over a range of LEDs. The renderer owns the SPI
+ * bus, builds the whole frame in one buffer sent with a single transfer and
+ * skips it when nothing changed since the last one.
+ */
+class LedStrip : public Worker {
 public:
     struct color {
         color()
@@ -22,6 +34,9 @@ public:
         {
         }
 
+        bool operator==(const color& o) const { return r == o.r && g == o.g && b == o.b && brightness == o.brightness; }
+        bool operator!=(const color& o) const { return !(*this == o); }
+
         uint8_t r;
         uint8_t g;
         uint8_t b;
@@ -30,15 +45,54 @@ public:
 
     static color white, red, green, blue, none;
 
+    using duration = std::chrono::milliseconds;
+    static const std::size_t all = static_cast<std::size_t>(-1);
+
     LedStrip();
-    ~LedStrip();
+    ~LedStrip() override;
+
+    // Replace the colors of the strip and cancel the animations
     void set(std::vector<color> colors);
     void set(color c, unsigned int n);
 
+    // Animations over count LEDs from first, on top of the static colors
+    void blink(color c, duration period, std::size_t first = 0, std::size_t count = all);
+    void breathe(color c, duration period, std::size_t first = 0, std::size_t count = all);
+    // Lights the range one LED after the other over the given time, then holds
+    void progress(color c, duration total, std::size_t first = 0, std::size_t count = all);
+    void stop_animations();
+
+    static constexpr std::chrono::milliseconds animation_period { 20 };
+
 private:
-    void send_opening_bytes();
-    void send_closing_bytes();
-    void send_color_bytes(color c);
+    struct Animation {
+        enum Kind {
+            Blink,
+            Breathe,
+            Progress
+        } kind;
+        color c;
+        duration period;
+        std::size_t first;
+        std::size_t count;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void work() override;
+
+    void animate(Animation::Kind kind, color c, duration period, std::size_t first, std::size_t count);
+    void render(std::chrono::steady_clock::time_point now);
+    static color scaled(color c, double factor);
+
+    std::vector<color> _colors;
+    std::vector<Animation> _animations;
+    bool _changed;
+    std::mutex _state_mutex;
+    std::condition_variable _state_cv;
+
+    // Renderer thread only
+    std::vector<char> _frame;
+    std::vector<char> _sent;
 };
 
 #endif // LEDSTRIP_H
@@ -0,0 +1,56 @@
+#include "endpoint.h"
+#include "mqtt_bridge.h"
+
+namespace Bus {
+Endpoint::Endpoint()
+{
+    // Makes sure the bus and the bridge outlive every endpoint
+    LocalBus::instance();
+    MqttBridge::instance();
+}
+
+Endpoint::~Endpoint()
+{
+    LocalBus::instance().unsubscribe_all(this);
+    for (const std::string& topic : _mirrored) {
+        MqttBridge::instance().release(topic);
+    }
+}
+
+void Endpoint::publish(std::string topic, std::string payload, QoS qos, bool retain)
+{
+    Message m;
+    m.topic = topic;
+    m.type = typeid(std::string);
+    m.data = std::make_shared<const std::string>(std::move(payload));
+    m.sender = this;
+    m.mirror = true;
+    m.qos = qos;
+    m.retain = retain;
+    LocalBus::instance().publish(m);
+}
+
+void Endpoint::subscribe(std::string topic, std::function<void(std::string)> cb, QoS qos)
+{
+    subscribe<std::string>(topic, [cb](std::shared_ptr<const std::string> payload) { cb(*payload); });
+    {
+        std::lock_guard<std::mutex> lock(_mirrored_mutex);
+        _mirrored.insert(topic);
+    }
+    MqttBridge::instance().mirror_in(topic, qos);
+}
+
+void Endpoint::unsubscribe(std::string topic)
+{
+    LocalBus::instance().unsubscribe(topic, this);
+
+    std::size_t count;
+    {
+        std::lock_guard<std::mutex> lock(_mirrored_mutex);
+        count = _mirrored.erase(topic);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        MqttBridge::instance().release(topic);
+    }
+}
+}
@@ -0,0 +1,57 @@
+#ifndef ENDPOINT_H
+#define ENDPOINT_H
+
+#include "local_bus.h"
+#include <mutex>
+#include <set>
+
+namespace Bus {
+/**
+ * \brief Per-component access point to the local bus.
+ *
+ * Text messages are delivered in-process and mirrored to the MQTT broker by
+ * the MqttBridge; typed messages never leave the process.
+ * Subscriptions are released when the endpoint is destroyed.
+ */
+class Endpoint {
+public:
+    Endpoint();
+    ~Endpoint();
+
+    Endpoint(const Endpoint&) = delete;
+    Endpoint& operator=(const Endpoint&) = delete;
+
+    void publish(std::string topic, std::string payload, QoS qos = Mosquittopp::Client::QoS0, bool retain = false);
+    void subscribe(std::string topic, std::function<void(std::string)> cb, QoS qos = Mosquittopp::Client::QoS0);
+    void unsubscribe(std::string topic);
+
+    template <typename T>
+    void publish(std::string topic, std::shared_ptr<const T> msg, bool retain = false)
+    {
+        Message m;
+        m.topic = topic;
+        m.type = typeid(T);
+        m.data = msg;
+        m.sender = this;
+        m.retain = retain;
+        LocalBus::instance().publish(m);
+    }
+
+    template <typename T>
+    void subscribe(std::string topic, std::function<void(std::shared_ptr<const T>)> cb)
+    {
+        LocalBus::instance().subscribe(topic, this, [cb](const Message& m) {
+            if (auto data = m.as<T>()) {
+                cb(data);
+            }
+        });
+    }
+
+private:
+    // Text subscriptions also hold the broker subscription of their topic
+    std::multiset<std::string> _mirrored;
+    std::mutex _mirrored_mutex;
+};
+}
+
+#endif // ENDPOINT_H
@@ -0,0 +1,156 @@
+#include "local_bus.h"
+#include <algorithm>
+
+namespace Bus {
+LocalBus::LocalBus()
+{
+}
+
+LocalBus& LocalBus::instance()
+{
+    static LocalBus b;
+    return b;
+}
+
+void LocalBus::publish(Message msg)
+{
+    std::vector<std::shared_ptr<Slot>> slots;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (msg.retain) {
+            _retained[msg.topic] = msg;
+        }
+        for (auto& s : _subscribers) {
+            if (s.owner != msg.sender && matches(s.filter, msg.topic)) {
+                slots.push_back(s.slot);
+            }
+        }
+    }
+
+    // Callbacks may publish in turn, so they are called without holding the lock
+    for (auto& slot : slots) {
+        call(*slot, msg);
+    }
+}
+
+void LocalBus::subscribe(std::string filter, const void* owner, Callback cb)
+{
+    auto slot = std::make_shared<Slot>();
+    slot->cb = cb;
+    std::vector<Message> retained;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _subscribers.push_back({ filter, owner, slot });
+        for (auto& r : _retained) {
+            if (r.second.sender != owner && matches(filter, r.first)) {
+                retained.push_back(r.second);
+            }
+        }
+    }
+
+    for (auto& msg : retained) {
+        call(*slot, msg);
+    }
+}
+
+void LocalBus::call(Slot& slot, const Message& msg)
+{
+    const std::thread::id self = std::this_thread::get_id();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (slot.removed) {
+            return;
+        }
+        slot.running.insert(self);
+    }
+
+    auto done = [this, &slot, self] {
+        std::lock_guard<std::mutex> lock(_mutex);
+        slot.running.erase(slot.running.find(self));
+        _idle.notify_all();
+    };
+
+    try {
+        slot.cb(msg);
+    } catch (...) {
+        done();
+        throw;
+    }
+    done();
+}
+
+void LocalBus::remove_if(std::function<bool(const Subscriber&)> pred)
+{
+    const std::thread::id self = std::this_thread::get_id();
+    std::unique_lock<std::mutex> lock(_mutex);
+    std::vector<std::shared_ptr<Slot>> removed;
+    for (auto& s : _subscribers) {
+        if (pred(s)) {
+            s.slot->removed = true;
+            removed.push_back(s.slot);
+        }
+    }
+    _subscribers.erase(std::remove_if(_subscribers.begin(), _subscribers.end(), pred), _subscribers.end());
+
+    // Calls that have not started yet skip the removed slots. Running ones are
+    // waited for, except in this thread and in threads waiting here as well.
+    _unsubscribing.insert(self);
+    _idle.notify_all();
+    _idle.wait(lock, [this, self, &removed] {
+        for (auto& slot : removed) {
+            for (const std::thread::id& t : slot->running) {
+                if (t != self && !_unsubscribing.count(t)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    });
+    _unsubscribing.erase(self);
+    _idle.notify_all();
+}
+
+void LocalBus::unsubscribe(std::string filter, const void* owner)
+{
+    remove_if([&](const Subscriber& s) { return s.owner == owner && s.filter == filter; });
+}
+
+void LocalBus::unsubscribe_all(const void* owner)
+{
+    remove_if([owner](const Subscriber& s) { return s.owner == owner; });
+}
+
+bool LocalBus::matches(const std::string& filter, const std::string& topic)
+{
+    std::size_t f = 0, t = 0;
+
+    while (f < filter.size()) {
+        if (filter[f] == '#') {
+            return true;
+        }
+
+        std::size_t f_end = filter.find('/', f);
+        std::size_t t_end = topic.find('/', t);
+        if (f_end == std::string::npos) {
+            f_end = filter.size();
+        }
+        if (t_end == std::string::npos) {
+            t_end = topic.size();
+        }
+
+        if (t > topic.size()) {
+            // "a/#" also matches "a"
+            return filter.compare(f, std::string::npos, "#") == 0;
+        }
+
+        if (!(filter[f] == '+' && f_end == f + 1) && filter.compare(f, f_end - f, topic, t, t_end - t) != 0) {
+            return false;
+        }
+
+        f = f_end + 1;
+        t = t_end + 1;
+    }
+
+    return f > filter.size() && t > topic.size();
+}
+}
@@ -0,0 +1,93 @@
+#ifndef LOCAL_BUS_H
+#define LOCAL_BUS_H
+
+#include "ux/mosquittopp/client.h"
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeindex>
+#include <vector>
+
+namespace Bus {
+using QoS = std::decay_t<decltype(Mosquittopp::Client::QoS0)>;
+
+struct Message {
+    std::string topic;
+    std::type_index type = typeid(void);
+    std::shared_ptr<const void> data;
+    const void* sender = nullptr;
+
+    // Only used when the message is mirrored to the MQTT broker
+    bool mirror = false;
+    QoS qos = Mosquittopp::Client::QoS0;
+    bool retain = false;
+
+    template <typename T>
+    std::shared_ptr<const T> as() const
+    {
+        if (type != typeid(T)) {
+            return nullptr;
+        }
+        return std::static_pointer_cast<const T>(data);
+    }
+};
+
+/**
+ * \brief In-process topic bus.
+ *
+ * Messages are shared immutable objects handed to every matching subscriber
+ * in the publisher's thread, without copy or serialization.
+ * Topic filters follow the MQTT syntax ('+' and '#' wildcards).
+ * Publishers dispatch from a snapshot of the subscribers; a removed
+ * subscriber is skipped by the calls that have not started yet.
+ * unsubscribe() waits for the callbacks still running in other threads, so
+ * the owner can be destroyed as soon as it returns. It does not wait for a
+ * thread that is itself blocked in unsubscribe(), so callbacks unsubscribing
+ * each other cannot deadlock.
+ */
+class LocalBus {
+public:
+    using Callback = std::function<void(const Message&)>;
+
+    static LocalBus& instance();
+
+    void publish(Message msg);
+    void subscribe(std::string filter, const void* owner, Callback cb);
+    void unsubscribe(std::string filter, const void* owner);
+    void unsubscribe_all(const void* owner);
+
+    static bool matches(const std::string& filter, const std::string& topic);
+
+private:
+    LocalBus();
+
+    struct Slot {
+        Callback cb;
+        bool removed = false;
+        std::multiset<std::thread::id> running; // Threads calling cb
+    };
+
+    struct Subscriber {
+        std::string filter;
+        const void* owner;
+        std::shared_ptr<Slot> slot;
+    };
+
+    void call(Slot& slot, const Message& msg);
+    void remove_if(std::function<bool(const Subscriber&)> pred);
+
+    std::vector<Subscriber> _subscribers;
+    std::map<std::string, Message> _retained;
+    std::mutex _mutex;
+    std::condition_variable _idle;
+    std::set<std::thread::id> _unsubscribing;
+};
+}
+
+#endif // LOCAL_BUS_H
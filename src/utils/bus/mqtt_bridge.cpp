@@ -0,0 +1,225 @@
+#include "mqtt_bridge.h"
+#include "utils/log/log.h"
+#include <algorithm>
+#include <unistd.h>
+
+namespace Bus {
+MqttBridge::MqttBridge()
+    : Worker("mqtt_bridge", Worker::Continuous)
+    , _connected(false)
+    , _ping_topic("sam/bridge/" + std::to_string(getpid()) + "/ping")
+    , _last_pong(0)
+    , _dropped(0)
+{
+    LocalBus::instance().subscribe("#", this, [this](const Message& msg) { on_local_message(msg); });
+    do_work();
+}
+
+MqttBridge::~MqttBridge()
+{
+    LocalBus::instance().unsubscribe_all(this);
+    stop();
+}
+
+MqttBridge& MqttBridge::instance()
+{
+    static MqttBridge b;
+    return b;
+}
+
+void MqttBridge::mirror_in(std::string topic, QoS qos)
+{
+    {
+        std::lock_guard<std::mutex> lock(_topics_mutex);
+        Mirror& mirror = _mirrored_topics[topic];
+        if (mirror.count++ > 0) {
+            return;
+        }
+        mirror.qos = qos;
+        _subscription_changes.push_back({ topic, qos, true });
+    }
+
+    // The client is only used from the bridge thread
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    _queue_cv.notify_one();
+}
+
+void MqttBridge::release(std::string topic)
+{
+    {
+        std::lock_guard<std::mutex> lock(_topics_mutex);
+        auto it = _mirrored_topics.find(topic);
+        if (it == _mirrored_topics.end() || --it->second.count > 0) {
+            return;
+        }
+        _mirrored_topics.erase(it);
+        for (auto e = _pending_echoes.begin(); e != _pending_echoes.end();) {
+            e = LocalBus::matches(topic, e->first) ? _pending_echoes.erase(e) : std::next(e);
+        }
+        _subscription_changes.push_back({ topic, QoS(), false });
+    }
+
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    _queue_cv.notify_one();
+}
+
+void MqttBridge::apply_subscription_changes()
+{
+    std::vector<SubscriptionChange> changes;
+    {
+        std::lock_guard<std::mutex> lock(_topics_mutex);
+        changes.swap(_subscription_changes);
+    }
+
+    // Callbacks are replaced, so subscribing again after a reconnection is harmless
+    for (auto& c : changes) {
+        auto subscription = _client.subscribe(c.topic, c.qos);
+        subscription->remove_callbacks(this);
+        if (c.subscribe) {
+            subscription->add_callback(this, [this](Mosquittopp::Message msg) { on_remote_message(msg.topic(), msg.payload()); });
+        }
+    }
+}
+
+bool MqttBridge::check_connection()
+{
+    auto now = std::chrono::steady_clock::now();
+    auto last_pong = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(_last_pong));
+    if (now - last_pong > _ping_timeout) {
+        warning() << "Lost the MQTT broker, reconnecting";
+        _connected = false;
+        return false;
+    }
+
+    if (now - _last_ping >= _ping_period) {
+        _client.publish(_ping_topic, std::string(), Mosquittopp::Client::QoS0, false);
+        _last_ping = now;
+    }
+    return true;
+}
+
+bool MqttBridge::is_mirrored(const std::string& topic)
+{
+    for (auto& m : _mirrored_topics) {
+        if (LocalBus::matches(m.first, topic)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MqttBridge::work()
+{
+    if (!_connected) {
+        auto now = std::chrono::steady_clock::now();
+        if (now - _last_connection_attempt < std::chrono::seconds(1) || !try_connect()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            return;
+        }
+    }
+
+    if (!check_connection()) {
+        return;
+    }
+    apply_subscription_changes();
+
+    std::deque<Message> queue_local;
+    {
+        std::unique_lock<std::mutex> lock(_queue_mutex);
+        _queue_cv.wait_for(lock, std::chrono::milliseconds(100), [this] { return !_queue.empty() || !_worker_loop_condition; });
+        queue_local.swap(_queue);
+    }
+
+    for (auto& msg : queue_local) {
+        auto payload = msg.as<std::string>();
+        {
+            std::lock_guard<std::mutex> lock(_topics_mutex);
+            if (is_mirrored(msg.topic)) {
+                std::deque<Echo>& echoes = _pending_echoes[msg.topic];
+                if (echoes.size() >= _max_pending_echoes) {
+                    echoes.pop_front();
+                }
+                echoes.push_back({ *payload, std::chrono::steady_clock::now() });
+            }
+        }
+        _client.publish(msg.topic, *payload, msg.qos, msg.retain);
+    }
+}
+
+void MqttBridge::on_local_message(const Message& msg)
+{
+    if (!msg.mirror || msg.type != typeid(std::string)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    if (_queue.size() >= _max_queue_size) {
+        _queue.pop_front();
+        ++_dropped;
+    }
+    _queue.push_back(msg);
+    _queue_cv.notify_one();
+}
+
+void MqttBridge::on_remote_message(std::string topic, std::string payload)
+{
+    {
+        // The broker sends our own publications back on mirrored topics, in
+        // the order they were sent. Echoes never seen, e.g. lost on a
+        // reconnection, expire so they cannot hide a later remote message.
+        std::lock_guard<std::mutex> lock(_topics_mutex);
+        auto it = _pending_echoes.find(topic);
+        if (it != _pending_echoes.end()) {
+            std::deque<Echo>& echoes = it->second;
+            auto now = std::chrono::steady_clock::now();
+            while (!echoes.empty() && now - echoes.front().sent > _echo_timeout) {
+                echoes.pop_front();
+            }
+            if (!echoes.empty() && echoes.front().payload == payload) {
+                echoes.pop_front();
+                return;
+            }
+        }
+    }
+
+    Message msg;
+    msg.topic = topic;
+    msg.type = typeid(std::string);
+    msg.data = std::make_shared<const std::string>(payload);
+    msg.sender = this;
+    LocalBus::instance().publish(msg);
+}
+
+bool MqttBridge::try_connect()
+{
+    static bool failure_reported = false;
+
+    _last_connection_attempt = std::chrono::steady_clock::now();
+    if (!_client.connect(MOSQUITTO_SERVER_IP, MOSQUITTO_SERVER_PORT)) {
+        if (!failure_reported) {
+            critical() << "Failed to connect to the MQTT broker, retrying in the background";
+            failure_reported = true;
+        }
+        return false;
+    }
+
+    // A new session may have lost the subscriptions of the previous one
+    _last_pong = std::chrono::steady_clock::now().time_since_epoch().count();
+    _last_ping = std::chrono::steady_clock::time_point();
+    _client.subscribe(_ping_topic)->remove_callbacks(this);
+    _client.subscribe(_ping_topic)->add_callback(this, [this](Mosquittopp::Message) { _last_pong = std::chrono::steady_clock::now().time_since_epoch().count(); });
+    {
+        std::lock_guard<std::mutex> lock(_topics_mutex);
+        _subscription_changes.erase(std::remove_if(_subscription_changes.begin(), _subscription_changes.end(), [](const SubscriptionChange& c) { return c.subscribe; }), _subscription_changes.end());
+        for (auto& m : _mirrored_topics) {
+            _subscription_changes.push_back({ m.first, m.second.qos, true });
+        }
+    }
+
+    failure_reported = false;
+    _connected = true;
+    info() << "Connected to the MQTT broker";
+
+    return true;
+}
+}
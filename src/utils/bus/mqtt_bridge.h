@@ -0,0 +1,91 @@
+#ifndef MQTT_BRIDGE_H
+#define MQTT_BRIDGE_H
+
+#include "local_bus.h"
+#include "utils/worker.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+
+namespace Bus {
+/**
+ * \brief Single connection between the local bus and the MQTT broker.
+ *
+ * Text messages published on the local bus with the mirror flag are forwarded
+ * to the broker from the bridge thread, and the topics subscribed through an
+ * Endpoint are injected back into the local bus. Broker subscriptions are
+ * counted per topic and released with the last endpoint using them.
+ *
+ * MQTT 3.1.1 carries no origin, so the broker also sends back what the bridge
+ * published on a mirrored topic. Each publication is recorded until its own
+ * echo comes back, in order, and only that echo is dropped.
+ *
+ * The bridge pings itself through the broker every second. Without an answer
+ * for three seconds the connection is considered lost: it reconnects and
+ * subscribes the mirrored topics again.
+ */
+class MqttBridge : public Worker {
+public:
+    static MqttBridge& instance();
+
+    void mirror_in(std::string topic, QoS qos);
+    void release(std::string topic);
+
+    std::size_t dropped_count() { return _dropped; }
+
+private:
+    MqttBridge();
+    ~MqttBridge() override;
+
+    void work() override;
+
+    void on_local_message(const Message& msg);
+    void on_remote_message(std::string topic, std::string payload);
+    bool try_connect();
+    void apply_subscription_changes();
+    bool check_connection();
+    bool is_mirrored(const std::string& topic);
+
+    Mosquittopp::Client _client;
+    std::atomic<bool> _connected;
+    std::chrono::steady_clock::time_point _last_connection_attempt;
+
+    std::string _ping_topic;
+    std::chrono::steady_clock::time_point _last_ping;
+    std::atomic<std::chrono::steady_clock::rep> _last_pong;
+    static constexpr std::chrono::seconds _ping_period { 1 };
+    static constexpr std::chrono::seconds _ping_timeout { 3 };
+
+    std::deque<Message> _queue;
+    std::mutex _queue_mutex;
+    std::condition_variable _queue_cv;
+    static const std::size_t _max_queue_size = 1000;
+    std::atomic<std::size_t> _dropped;
+
+    struct SubscriptionChange {
+        std::string topic;
+        QoS qos;
+        bool subscribe;
+    };
+
+    struct Echo {
+        std::string payload;
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    struct Mirror {
+        std::size_t count; // Endpoints subscribed to the filter
+        QoS qos;
+    };
+
+    std::map<std::string, Mirror> _mirrored_topics;
+    std::vector<SubscriptionChange> _subscription_changes;
+    std::map<std::string, std::deque<Echo>> _pending_echoes; // By concrete topic
+    static constexpr std::chrono::seconds _echo_timeout { 2 };
+    static const std::size_t _max_pending_echoes = 100;
+    std::mutex _topics_mutex;
+};
+}
+
+#endif // MQTT_BRIDGE_H
@@ -0,0 +1,133 @@
+#include "backend.h"
+#include <cstring>
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <stdexcept>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <vector>
+
+namespace I2C {
+
+Backend::~Backend()
+{
+}
+
+DeviceBackend::DeviceBackend(std::string device)
+    : _device(device)
+{
+    _fd = open(device.c_str(), O_RDWR | O_CLOEXEC);
+    if (_fd < 0) {
+        throw std::runtime_error("Failed to open I2C device " + device + ": " + strerror(errno));
+    }
+}
+
+DeviceBackend::~DeviceBackend()
+{
+    close(_fd);
+}
+
+bool DeviceBackend::transfer(Transaction& t)
+{
+    i2c_msg msgs[max_messages];
+    std::size_t n = t.messages().size();
+    if (n == 0 || n > max_messages) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const Transaction::Message& m = t.messages()[i];
+        msgs[i].addr = m.address;
+        msgs[i].flags = m.read ? I2C_M_RD : 0;
+        msgs[i].len = m.length;
+        msgs[i].buf = t.buffer() + m.offset;
+    }
+
+    i2c_rdwr_ioctl_data data;
+    data.msgs = msgs;
+    data.nmsgs = static_cast<uint32_t>(n);
+    return ioctl(_fd, I2C_RDWR, &data) == static_cast<int>(n);
+}
+
+FakeBackend::FakeBackend(unsigned int clock_hz, std::chrono::microseconds overhead)
+    : _clock_hz(clock_hz)
+    , _overhead(overhead)
+    , _transfers(0)
+{
+}
+
+void FakeBackend::add_device(uint8_t address)
+{
+    std::lock_guard lock(_devices_mutex);
+    _devices[address];
+}
+
+void FakeBackend::set_nack(uint8_t address, bool nack)
+{
+    std::lock_guard lock(_devices_mutex);
+    _devices[address].nack = nack;
+}
+
+void FakeBackend::set_register(uint8_t address, uint8_t reg, uint16_t value)
+{
+    std::lock_guard lock(_devices_mutex);
+    _devices[address].registers[reg] = value;
+}
+
+uint16_t FakeBackend::get_register(uint8_t address, uint8_t reg)
+{
+    std::lock_guard lock(_devices_mutex);
+    return _devices[address].registers[reg];
+}
+
+bool FakeBackend::transfer(Transaction& t)
+{
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point start = clock::now();
+    ++_transfers;
+
+    // Start, address and stop, then 9 clocks per byte
+    std::size_t clocks = 0;
+    bool ok = true;
+    {
+        std::lock_guard lock(_devices_mutex);
+        for (const Transaction::Message& m : t.messages()) {
+            clocks += 11 + 9 * m.length;
+
+            auto it = _devices.find(m.address);
+            if (it == _devices.end() || it->second.nack) {
+                ok = false;
+                break;
+            }
+            Device& d = it->second;
+            uint8_t* data = t.buffer() + m.offset;
+
+            if (m.read) {
+                for (std::size_t i = 0; i < m.length; i += 2) {
+                    uint16_t value = d.registers[static_cast<uint8_t>(d.pointer + i / 2)];
+                    data[i] = static_cast<uint8_t>(value >> 8);
+                    if (i + 1 < m.length) {
+                        data[i + 1] = static_cast<uint8_t>(value & 0xFF);
+                    }
+                }
+            } else if (m.length > 0) {
+                d.pointer = data[0];
+                for (std::size_t i = 1; i + 1 < m.length; i += 2) {
+                    d.registers[static_cast<uint8_t>(d.pointer + i / 2)] = static_cast<uint16_t>((data[i] << 8) | data[i + 1]);
+                }
+            }
+        }
+    }
+
+    if (_clock_hz == 0 && _overhead.count() == 0) {
+        return ok;
+    }
+    clock::time_point end = start + _overhead + std::chrono::nanoseconds(_clock_hz ? clocks * 1000000000ull / _clock_hz : 0);
+    while (clock::now() < end) {
+    }
+    return ok;
+}
+
+}
@@ -0,0 +1,77 @@
+#ifndef I2C_BACKEND_H
+#define I2C_BACKEND_H
+
+#include "transaction.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace I2C {
+
+class Backend {
+public:
+    virtual ~Backend();
+
+    // Sends all the messages of the transaction in one transfer
+    virtual bool transfer(Transaction& t) = 0;
+
+    // I2C_RDWR_IOCTL_MAX_MSGS
+    static const std::size_t max_messages = 42;
+};
+
+/**
+ * \brief Linux i2c-dev adapter, one I2C_RDWR ioctl per transfer.
+ */
+class DeviceBackend : public Backend {
+public:
+    explicit DeviceBackend(std::string device);
+    ~DeviceBackend() override;
+
+    bool transfer(Transaction& t) override;
+
+private:
+    std::string _device;
+    int _fd;
+};
+
+/**
+ * \brief In-memory bus, for tests and benchmarks.
+ *
+ * Devices are register files addressed by a pointer byte, like the ADS1x15:
+ * a write sets the pointer and then stores 16-bit registers MSB first, a read
+ * returns the registers from the pointer. Transfers take the wire time of
+ * their bytes at the simulated clock plus a fixed overhead, spent spinning
+ * so that short delays stay accurate. A clock of 0 takes no wire time.
+ */
+class FakeBackend : public Backend {
+public:
+    explicit FakeBackend(unsigned int clock_hz = 400000, std::chrono::microseconds overhead = std::chrono::microseconds(0));
+
+    void add_device(uint8_t address);
+    void set_nack(uint8_t address, bool nack);
+    void set_register(uint8_t address, uint8_t reg, uint16_t value);
+    uint16_t get_register(uint8_t address, uint8_t reg);
+
+    uint32_t transfers() const { return _transfers; }
+
+    bool transfer(Transaction& t) override;
+
+private:
+    struct Device {
+        uint8_t pointer = 0;
+        bool nack = false;
+        std::map<uint8_t, uint16_t> registers;
+    };
+
+    unsigned int _clock_hz;
+    std::chrono::microseconds _overhead;
+    std::map<uint8_t, Device> _devices;
+    std::mutex _devices_mutex;
+    std::atomic<uint32_t> _transfers;
+};
+
+}
+
+#endif // I2C_BACKEND_H
@@ -0,0 +1,182 @@
+#include "i2c_bus.h"
+#include "hal/platform.h"
+#include "utils/log/log.h"
+#include "utils/trace/trace.h"
+#include <algorithm>
+#include <map>
+
+namespace I2C {
+
+namespace {
+    std::map<std::string, std::unique_ptr<Bus>> buses;
+    std::mutex buses_mutex;
+
+    std::string bus_name(const std::string& device)
+    {
+        // /dev/i2c-1 -> i2c_1
+        std::string name = device.substr(device.find_last_of('/') + 1);
+        std::replace(name.begin(), name.end(), '-', '_');
+        return name;
+    }
+}
+
+Bus& Bus::open(const std::string& device)
+{
+    std::lock_guard lock(buses_mutex);
+    std::unique_ptr<Bus>& bus = buses[device];
+    if (!bus) {
+        try {
+            bus = std::make_unique<Bus>(bus_name(device), HAL::Platform::instance().i2c(device));
+        } catch (...) {
+            buses.erase(device);
+            throw;
+        }
+    }
+    return *bus;
+}
+
+std::vector<Bus*> Bus::opened()
+{
+    std::lock_guard lock(buses_mutex);
+    std::vector<Bus*> list;
+    for (auto& b : buses) {
+        list.push_back(b.second.get());
+    }
+    return list;
+}
+
+Bus::Bus(std::string name, std::unique_ptr<Backend> backend)
+    : Worker(name, Worker::Continuous)
+    , NamedObject(name)
+    , MenuUser(name, "I2C bus " + name)
+    , _backend(std::move(backend))
+{
+    _menu->add_item("stats", "Show transfer statistics", [this](std::string) { show_stats(); });
+    _menu->add_item("reset", "Reset statistics", [this](std::string) { reset_stats(); });
+
+    do_work();
+}
+
+Bus::~Bus()
+{
+    stop();
+    std::lock_guard lock(_io_mutex);
+    flush();
+}
+
+bool Bus::transfer(Transaction& t)
+{
+    std::lock_guard lock(_io_mutex);
+    flush();
+    return execute(t, 1);
+}
+
+void Bus::submit(Transaction t, Callback done)
+{
+    {
+        std::lock_guard lock(_queue_mutex);
+        _queue.push_back({ std::move(t), std::move(done) });
+    }
+    _queue_cv.notify_one();
+}
+
+void Bus::work()
+{
+    {
+        std::unique_lock lock(_queue_mutex);
+        _queue_cv.wait_for(lock, std::chrono::milliseconds(100), [this] { return !_queue.empty(); });
+    }
+    std::lock_guard lock(_io_mutex);
+    flush();
+}
+
+// With _io_mutex held
+void Bus::flush()
+{
+    std::deque<Pending> batch;
+    {
+        std::lock_guard lock(_queue_mutex);
+        batch.swap(_queue);
+    }
+    if (!batch.empty()) {
+        run_batch(batch);
+    }
+}
+
+void Bus::run_batch(std::deque<Pending>& batch)
+{
+    auto first = batch.begin();
+    while (first != batch.end()) {
+        // Merge as many queued transactions as one transfer can carry. A read
+        // must stay the last message, so nothing is appended after one.
+        Transaction combined = first->transaction;
+        auto last = std::next(first);
+        while (last != batch.end() && !combined.has_read() && combined.messages().size() + last->transaction.messages().size() <= Backend::max_messages) {
+            combined.append(last->transaction);
+            ++last;
+        }
+
+        std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+        if (execute(combined, count)) {
+            std::size_t offset = 0;
+            for (auto it = first; it != last; ++it) {
+                it->transaction.copy_buffer_from(combined, offset);
+                offset += it->transaction.bytes();
+                if (it->done) {
+                    it->done(true, it->transaction);
+                }
+            }
+        } else {
+            // Find out which ones failed
+            for (auto it = first; it != last; ++it) {
+                bool ok = count > 1 && execute(it->transaction, 0);
+                if (it->done) {
+                    it->done(ok, it->transaction);
+                }
+            }
+        }
+        first = last;
+    }
+}
+
+// With _io_mutex held
+bool Bus::execute(Transaction& t, std::size_t transactions)
+{
+    TRACE_SCOPE("I2C::Bus::execute");
+    auto start = std::chrono::steady_clock::now();
+    bool ok = _backend->transfer(t);
+    uint32_t us = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+    std::lock_guard lock(_stats_mutex);
+    _stats.transactions += transactions;
+    ++_stats.transfers;
+    _stats.total_us += us;
+    _stats.max_us = std::max(_stats.max_us, us);
+    if (!ok) {
+        ++_stats.errors;
+    }
+    return ok;
+}
+
+Bus::Stats Bus::stats()
+{
+    std::lock_guard lock(_stats_mutex);
+    return _stats;
+}
+
+void Bus::show_stats()
+{
+    Stats s = stats();
+    info() << name() << ": " << s.transactions << " transactions in " << s.transfers << " transfers, " << s.errors << " errors";
+    if (s.transfers) {
+        info() << "Transfer time: " << s.total_us / s.transfers << " us average, " << s.max_us << " us max";
+    }
+}
+
+void Bus::reset_stats()
+{
+    std::lock_guard lock(_stats_mutex);
+    _stats = Stats();
+}
+
+}
@@ -0,0 +1,79 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include "backend.h"
+#include "utils/interfaces/menu_user.h"
+#include "utils/named_object.h"
+#include "utils/worker.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace I2C {
+
+/**
+ * \brief Serializes the access of the drivers to one I2C adapter.
+ *
+ * Drivers of the devices on the same adapter share its Bus, opened by device
+ * path. transfer() blocks the caller for one combined transfer. submit()
+ * queues the transaction and returns immediately: the bus thread merges the
+ * queued write-only transactions into as few transfers as possible, a read
+ * ending each transfer, and calls their callback once done.
+ *
+ * Queued transactions always go first, so the requests of a driver reach the
+ * device in order whichever way they were sent. Callbacks run on the thread
+ * that flushed the queue, with the bus held: they must not use it.
+ */
+class Bus : public Worker, public NamedObject, public MenuUser {
+public:
+    using Callback = std::function<void(bool ok, const Transaction& t)>;
+
+    struct Stats {
+        uint64_t transactions = 0;
+        uint64_t transfers = 0;
+        uint64_t errors = 0;
+        uint64_t total_us = 0;
+        uint32_t max_us = 0;
+    };
+
+    static Bus& open(const std::string& device);
+    static std::vector<Bus*> opened();
+
+    Bus(std::string name, std::unique_ptr<Backend> backend);
+    ~Bus() override;
+
+    bool transfer(Transaction& t);
+    void submit(Transaction t, Callback done = nullptr);
+
+    Stats stats();
+    void show_stats();
+    void reset_stats();
+
+private:
+    struct Pending {
+        Transaction transaction;
+        Callback done;
+    };
+
+    void work() override;
+
+    void flush();
+    void run_batch(std::deque<Pending>& batch);
+    bool execute(Transaction& t, std::size_t transactions);
+
+    std::unique_ptr<Backend> _backend;
+    std::mutex _io_mutex;
+
+    std::deque<Pending> _queue;
+    std::mutex _queue_mutex;
+    std::condition_variable _queue_cv;
+
+    Stats _stats;
+    std::mutex _stats_mutex;
+};
+
+}
+
+#endif // I2C_BUS_H
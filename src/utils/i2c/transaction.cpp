@@ -0,0 +1,68 @@
+#include "transaction.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace I2C {
+
+Transaction& Transaction::write(uint8_t address, std::initializer_list<uint8_t> bytes)
+{
+    return write(address, bytes.begin(), bytes.size());
+}
+
+Transaction& Transaction::write(uint8_t address, const uint8_t* data, std::size_t size)
+{
+    _messages.push_back({ address, false, static_cast<uint16_t>(_buffer.size()), static_cast<uint16_t>(size) });
+    _buffer.insert(_buffer.end(), data, data + size);
+    return *this;
+}
+
+Transaction& Transaction::read(uint8_t address, std::size_t size)
+{
+    _messages.push_back({ address, true, static_cast<uint16_t>(_buffer.size()), static_cast<uint16_t>(size) });
+    _buffer.resize(_buffer.size() + size, 0);
+    return *this;
+}
+
+const uint8_t* Transaction::read_data(std::size_t index) const
+{
+    for (const Message& m : _messages) {
+        if (m.read && index-- == 0) {
+            return _buffer.data() + m.offset;
+        }
+    }
+    throw std::out_of_range("I2C transaction has no such read message");
+}
+
+uint16_t Transaction::read_u16(std::size_t index) const
+{
+    const uint8_t* data = read_data(index);
+    return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+void Transaction::append(const Transaction& other)
+{
+    uint16_t base = static_cast<uint16_t>(_buffer.size());
+    for (Message m : other._messages) {
+        m.offset += base;
+        _messages.push_back(m);
+    }
+    _buffer.insert(_buffer.end(), other._buffer.begin(), other._buffer.end());
+}
+
+void Transaction::copy_buffer_from(const Transaction& combined, std::size_t offset)
+{
+    std::copy_n(combined._buffer.begin() + offset, _buffer.size(), _buffer.begin());
+}
+
+bool Transaction::has_read() const
+{
+    return std::any_of(_messages.begin(), _messages.end(), [](const Message& m) { return m.read; });
+}
+
+void Transaction::clear()
+{
+    _messages.clear();
+    _buffer.clear();
+}
+
+}
@@ -0,0 +1,56 @@
+#ifndef I2C_TRANSACTION_H
+#define I2C_TRANSACTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace I2C {
+
+/**
+ * \brief Messages sent to the bus in one combined transfer.
+ *
+ * Messages are separated by repeated starts and the bus is only released
+ * after the last one, so a register pointer write and the read that follows
+ * it can't be interleaved with the traffic of another device.
+ *
+ * The Raspberry Pi controller (i2c-bcm2835) accepts at most one read
+ * message, and only as the last one of a transfer.
+ */
+class Transaction {
+public:
+    struct Message {
+        uint8_t address;
+        bool read;
+        uint16_t offset; // in the transaction buffer
+        uint16_t length;
+    };
+
+    Transaction& write(uint8_t address, std::initializer_list<uint8_t> bytes);
+    Transaction& write(uint8_t address, const uint8_t* data, std::size_t size);
+    Transaction& read(uint8_t address, std::size_t size);
+
+    // Data of the index-th read message, valid once the transaction succeeded
+    const uint8_t* read_data(std::size_t index) const;
+    uint16_t read_u16(std::size_t index) const; // MSB first
+
+    void append(const Transaction& other);
+    void copy_buffer_from(const Transaction& combined, std::size_t offset);
+
+    const std::vector<Message>& messages() const { return _messages; }
+    uint8_t* buffer() { return _buffer.data(); }
+    const uint8_t* buffer() const { return _buffer.data(); }
+    std::size_t bytes() const { return _buffer.size(); }
+    bool empty() const { return _messages.empty(); }
+    bool has_read() const;
+    void clear();
+
+private:
+    std::vector<Message> _messages;
+    std::vector<uint8_t> _buffer;
+};
+
+}
+
+#endif // I2C_TRANSACTION_H
@@ -1,7 +1,7 @@
 #ifndef MQTT_USER_H
 #define MQTT_USER_H
 
-#include "ux/mosquittopp/client.h"
+#include "utils/bus/endpoint.h"
 
 class MqttUser {
 public:
@@ -10,7 +10,7 @@ public:
 protected:
     MqttUser();
 
-    Mosquittopp::Client _mqtt;
+    Bus::Endpoint _mqtt;
 };
 
 #endif // MQTT_USER_H
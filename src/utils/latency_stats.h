@@ -0,0 +1,89 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * \brief Wake-up latency statistics written by one thread.
+ *
+ * record() only does relaxed atomic stores, so it can sit in a real-time
+ * loop. A reader collects windows with take(); the histogram and the
+ * overall maximum are kept since construction.
+ */
+class LatencyStats {
+public:
+    struct Window {
+        uint64_t count;
+        uint64_t sum_ns;
+        uint64_t max_ns;
+
+        double avg_us() const { return count ? sum_ns / 1000. / count : 0.; }
+        double max_us() const { return max_ns / 1000.; }
+    };
+
+    // Bucket i counts latencies below 2^i us, the last one everything above
+    static const int buckets = 16;
+
+    LatencyStats()
+        : _count(0)
+        , _sum_ns(0)
+        , _window_max_ns(0)
+        , _max_ns(0)
+        , _taken_count(0)
+        , _taken_sum_ns(0)
+    {
+        for (auto& bucket : _histogram) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Writer side
+    void record(int64_t latency_ns)
+    {
+        uint64_t ns = latency_ns > 0 ? static_cast<uint64_t>(latency_ns) : 0;
+
+        _count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        _sum_ns.store(_sum_ns.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+        if (ns > _max_ns.load(std::memory_order_relaxed)) {
+            _max_ns.store(ns, std::memory_order_relaxed);
+        }
+        uint64_t window_max = _window_max_ns.load(std::memory_order_relaxed);
+        while (ns > window_max && !_window_max_ns.compare_exchange_weak(window_max, ns, std::memory_order_relaxed)) {
+        }
+
+        int bucket = 0;
+        for (uint64_t us = ns / 1000; us && bucket < buckets - 1; us >>= 1) {
+            ++bucket;
+        }
+        _histogram[bucket].store(_histogram[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Reader side, returns what was recorded since the previous call
+    Window take()
+    {
+        uint64_t count = _count.load(std::memory_order_relaxed);
+        uint64_t sum_ns = _sum_ns.load(std::memory_order_relaxed);
+        Window window = { count - _taken_count, sum_ns - _taken_sum_ns, _window_max_ns.exchange(0, std::memory_order_relaxed) };
+        _taken_count = count;
+        _taken_sum_ns = sum_ns;
+        return window;
+    }
+
+    uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+    uint64_t max_ns() const { return _max_ns.load(std::memory_order_relaxed); }
+    uint64_t histogram(int bucket) const { return _histogram[bucket].load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sum_ns;
+    std::atomic<uint64_t> _window_max_ns;
+    std::atomic<uint64_t> _max_ns;
+    std::array<std::atomic<uint64_t>, buckets> _histogram;
+
+    uint64_t _taken_count;
+    uint64_t _taken_sum_ns;
+};
+
+#endif // LATENCY_STATS_H
@@ -1,17 +1,27 @@
 #include "logger.h"
+#include "utils/telemetry/budget.h"
 #include <fstream>
+#include <iostream>
 
 namespace Log {
+std::atomic<bool> Logger::_destroyed(false);
+
 Logger::Logger()
     : Worker("logger", Worker::Continuous)
     , _log_to_file(true)
     , _log_to_mqtt(true)
 {
+    // The budget must outlive the logger
+    Telemetry::Budget::global();
     do_work();
 }
 
 Logger::~Logger()
 {
+    // Joins the worker before the members go away
+    stop();
+    std::lock_guard lock(_queue_mutex);
+    _destroyed = true;
 }
 
 Logger& Logger::instance()
@@ -49,8 +59,11 @@ void Logger::work()
         }
 
         if (_log_to_mqtt) {
+            // Warnings and above are never dropped, but still count against the telemetry budget
             std::string topic_name = "sam/log/" + type_str;
-            _mqtt.publish(topic_name, p.second);
+            if (Telemetry::Budget::global().try_consume(topic_name.size() + p.second.size(), p.first >= WARNING)) {
+                _mqtt.publish(topic_name, p.second);
+            }
         }
 
         queue_local.pop();
@@ -63,6 +76,10 @@ void Logger::work()
 void Logger::enqueue(MessageType t, std::string s)
 {
     std::lock_guard lock(_queue_mutex);
+    if (_destroyed) {
+        std::cerr << s << std::endl;
+        return;
+    }
     _queue.push(std::make_pair(t, s));
 }
 
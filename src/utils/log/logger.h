@@ -3,6 +3,7 @@
 
 #include "utils/interfaces/mqtt_user.h"
 #include "utils/worker.h"
+#include <atomic>
 #include <map>
 #include <memory>
 #include <queue>
@@ -21,6 +22,9 @@ public:
 
     void enqueue(MessageType t, std::string s);
 
+    // Threads of other singletons may still log while the process exits
+    static bool destroyed() { return _destroyed; }
+
 private:
     explicit Logger();
     ~Logger() override;
@@ -34,6 +38,8 @@ private:
 
     bool _log_to_file;
     bool _log_to_mqtt;
+
+    static std::atomic<bool> _destroyed;
 };
 }
 
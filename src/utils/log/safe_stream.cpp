@@ -1,4 +1,5 @@
 #include "safe_stream.h"
+#include <iostream>
 
 namespace Log {
 
@@ -15,6 +16,10 @@ SafeStream::SafeStream(const SafeStream&& ss)
 
 SafeStream::~SafeStream()
 {
+    if (Logger::destroyed()) {
+        std::cerr << str() << std::endl;
+        return;
+    }
     Logger::instance().enqueue(_t, str());
 }
 }
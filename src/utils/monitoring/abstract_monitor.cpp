@@ -10,4 +10,9 @@ AbstractMonitor::~AbstractMonitor()
 {
 }
 
+std::vector<double> AbstractMonitor::values()
+{
+    return std::vector<double>();
+}
+
 }
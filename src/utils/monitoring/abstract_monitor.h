@@ -2,6 +2,7 @@
 #define ABSTRACTMONITOR_H
 
 #include <string>
+#include <vector>
 
 namespace Monitoring {
 
@@ -13,6 +14,8 @@ public:
 
     virtual void update() = 0;
     virtual std::string formatted_output() = 0;
+    // Fixed layout, for monitors publishing a constant set of values
+    virtual std::vector<double> values();
 };
 
 }
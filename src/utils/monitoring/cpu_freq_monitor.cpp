@@ -4,7 +4,8 @@
 namespace Monitoring {
 
 CPUFreqMonitor::CPUFreqMonitor()
-    : _freq(0)
+    : _freq_file("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", 64)
+    , _freq(0)
 {
 }
 
@@ -14,9 +15,10 @@ CPUFreqMonitor::~CPUFreqMonitor()
 
 void CPUFreqMonitor::update()
 {
-    std::string buf = vc_send_receive("measure_clock arm");
-    unsigned int pos = buf.find('=') + 1;
-    _freq = std::stod(buf.substr(pos)) / 1000000.;
+    // kHz
+    if (_freq_file.read()) {
+        _freq = _freq_file.scanner().next_uint() / 1000.;
+    }
 }
 
 std::string CPUFreqMonitor::formatted_output()
@@ -27,4 +29,9 @@ std::string CPUFreqMonitor::formatted_output()
     return out.str();
 }
 
+std::vector<double> CPUFreqMonitor::values()
+{
+    return { _freq };
+}
+
 }
@@ -1,11 +1,12 @@
 #ifndef CPUFREQMONITOR_H
 #define CPUFREQMONITOR_H
 
-#include "vc_based_monitor.h"
+#include "abstract_monitor.h"
+#include "proc_file.h"
 
 namespace Monitoring {
 
-class CPUFreqMonitor : public VCBasedMonitor
+class CPUFreqMonitor : public AbstractMonitor
 {
 public:
     CPUFreqMonitor();
@@ -13,8 +14,10 @@ public:
 
     void update() override;
     std::string formatted_output() override;
+    std::vector<double> values() override;
 
 private:
+    ProcFile _freq_file;
     double _freq;
 };
 
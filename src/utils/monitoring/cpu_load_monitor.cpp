@@ -1,16 +1,11 @@
 #include "cpu_load_monitor.h"
-#include <fstream>
-#include <iterator>
-#include <sstream>
-#include <vector>
 
 namespace Monitoring {
 
 CPULoadMonitor::CPULoadMonitor()
+    : _stat("/proc/stat")
 {
-    _old_usr.fill(0);
-    _old_nice.fill(0);
-    _old_sys.fill(0);
+    _old_busy.fill(0);
     _old_idle.fill(0);
     _cpu_load.fill(0);
 }
@@ -21,25 +16,27 @@ CPULoadMonitor::~CPULoadMonitor()
 
 void CPULoadMonitor::update()
 {
-    std::ifstream stat_file("/proc/stat");
-    std::string buf;
-
-    for (unsigned int i = 0; i < _ncpus + 1; ++i) {
-        std::getline(stat_file, buf);
-        std::istringstream ss(buf);
-        std::vector<std::string> infos((std::istream_iterator<std::string>(ss)), std::istream_iterator<std::string>());
-
-        if (infos.size() > 5) {
-            int usr = std::stoi(infos[1]);
-            int nice = std::stoi(infos[2]);
-            int sys = std::stoi(infos[3]);
-            int idle = std::stoi(infos[4]);
-            _cpu_load[i] = 1. - static_cast<double>(idle - _old_idle[i]) / (usr + nice + sys + idle - _old_usr[i] - _old_nice[i] - _old_sys[i] - _old_idle[i]);
-            _old_usr[i] = usr;
-            _old_nice[i] = nice;
-            _old_sys[i] = sys;
-            _old_idle[i] = idle;
+    if (!_stat.read()) {
+        return;
+    }
+    Scanner scanner = _stat.scanner();
+
+    // "cpu" then "cpuN" lines: label usr nice sys idle ...
+    for (unsigned int i = 0; i < _ncpus + 1 && scanner.starts_with("cpu"); ++i) {
+        scanner.skip_field();
+        uint64_t usr = scanner.next_uint();
+        uint64_t nice = scanner.next_uint();
+        uint64_t sys = scanner.next_uint();
+        uint64_t idle = scanner.next_uint();
+        scanner.next_line();
+
+        uint64_t busy = usr + nice + sys;
+        uint64_t total = busy - _old_busy[i] + idle - _old_idle[i];
+        if (total > 0) {
+            _cpu_load[i] = static_cast<double>(busy - _old_busy[i]) / total;
         }
+        _old_busy[i] = busy;
+        _old_idle[i] = idle;
     }
 }
 
@@ -53,4 +50,9 @@ std::string CPULoadMonitor::formatted_output()
     return ret;
 }
 
+std::vector<double> CPULoadMonitor::values()
+{
+    return std::vector<double>(_cpu_load.begin(), _cpu_load.end());
+}
+
 }
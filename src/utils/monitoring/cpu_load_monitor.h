@@ -2,6 +2,7 @@
 #define CPULOADMONITOR_H
 
 #include "abstract_monitor.h"
+#include "proc_file.h"
 #include <array>
 
 namespace Monitoring {
@@ -13,13 +14,16 @@ public:
 
     void update() override;
     std::string formatted_output() override;
+    std::vector<double> values() override;
+
+    static int cpu_count() { return _ncpus; }
 
 private:
     static const int _ncpus = 4;
-    std::array<int, _ncpus + 1> _old_usr;
-    std::array<int, _ncpus + 1> _old_nice;
-    std::array<int, _ncpus + 1> _old_sys;
-    std::array<int, _ncpus + 1> _old_idle;
+
+    ProcFile _stat;
+    std::array<uint64_t, _ncpus + 1> _old_busy;
+    std::array<uint64_t, _ncpus + 1> _old_idle;
     std::array<double, _ncpus + 1> _cpu_load;
 };
 
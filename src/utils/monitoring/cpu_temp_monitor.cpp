@@ -4,6 +4,8 @@
 namespace Monitoring {
 
 CPUTempMonitor::CPUTempMonitor()
+    : _temp_file("/sys/class/thermal/thermal_zone0/temp", 64)
+    , _temp(0)
 {
 }
 
@@ -13,9 +15,9 @@ CPUTempMonitor::~CPUTempMonitor()
 
 void CPUTempMonitor::update()
 {
-    std::string buf = vc_send_receive("measure_temp");
-    unsigned int pos = buf.find('=') + 1;
-    _temp = std::stod(buf.substr(pos, buf.size() - pos - 2));
+    if (_temp_file.read()) {
+        _temp = _temp_file.scanner().next_int() / 1000.;
+    }
 }
 
 std::string CPUTempMonitor::formatted_output()
@@ -26,4 +28,9 @@ std::string CPUTempMonitor::formatted_output()
     return out.str();
 }
 
+std::vector<double> CPUTempMonitor::values()
+{
+    return { _temp };
+}
+
 }
@@ -1,11 +1,12 @@
 #ifndef CPUTEMPMONITOR_H
 #define CPUTEMPMONITOR_H
 
-#include "vc_based_monitor.h"
+#include "abstract_monitor.h"
+#include "proc_file.h"
 
 namespace Monitoring {
 
-class CPUTempMonitor : public VCBasedMonitor
+class CPUTempMonitor : public AbstractMonitor
 {
 public:
     CPUTempMonitor();
@@ -13,8 +14,10 @@ public:
 
     void update() override;
     std::string formatted_output() override;
+    std::vector<double> values() override;
 
 private:
+    ProcFile _temp_file;
     double _temp;
 };
 
@@ -0,0 +1,174 @@
+#include "latency_probe.h"
+#include "utils/log/log.h"
+#include "utils/threaded_loop.h"
+#include <iomanip>
+#include <sstream>
+#include <time.h>
+
+namespace Monitoring {
+
+LatencyProbe::LatencyProbe(const NamedObject* parent)
+    : NamedObject("latency", parent)
+    , _enabled("enabled", BaseParam::ReadWrite, this, false)
+    , _interval_us("interval_us", BaseParam::ReadWrite, this, 1000)
+    , _prio("prio", BaseParam::ReadWrite, this, 98)
+    , _spike_us("spike_us", BaseParam::ReadWrite, this, 200)
+    , _run(false)
+{
+}
+
+LatencyProbe::~LatencyProbe()
+{
+    stop();
+}
+
+int LatencyProbe::cpu_count()
+{
+    int n = static_cast<int>(std::thread::hardware_concurrency());
+    return n > 0 ? n : 1;
+}
+
+void LatencyProbe::start()
+{
+    if (running()) {
+        return;
+    }
+    _run = true;
+    for (int cpu = 0; cpu < cpu_count(); ++cpu) {
+        _cores.push_back(std::make_unique<Core>());
+        Core& core = *_cores.back();
+        core.window = {};
+        core.thread = std::thread(&LatencyProbe::run, this, cpu, std::ref(core));
+    }
+}
+
+void LatencyProbe::stop()
+{
+    _run = false;
+    for (auto& core : _cores) {
+        if (core->thread.joinable()) {
+            core->thread.join();
+        }
+    }
+    _cores.clear();
+}
+
+void LatencyProbe::run(int cpu, Core& core)
+{
+    pthread_setname_np(pthread_self(), ("latency_cpu" + std::to_string(cpu)).c_str());
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+
+    struct sched_param sp = {};
+    sp.sched_priority = _prio;
+    if (sched_setscheduler(0, SCHED_FIFO, &sp) != 0) {
+        warning() << "Latency probe on cpu " << cpu << " is not real-time";
+    }
+
+    const long interval_ns = _interval_us * 1000L;
+    struct timespec next, now;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (_run) {
+        next.tv_nsec += interval_ns;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            ++next.tv_sec;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        int64_t late_ns = (now.tv_sec - next.tv_sec) * 1000000000LL + (now.tv_nsec - next.tv_nsec);
+        core.stats.record(late_ns);
+
+        // Do not try to catch up after a stall, like cyclictest
+        if (late_ns > interval_ns) {
+            next = now;
+        }
+    }
+}
+
+void LatencyProbe::update()
+{
+    bool restart = _interval_us.changed() | _prio.changed();
+    if (_enabled.changed() || restart) {
+        stop();
+        if (_enabled) {
+            start();
+        }
+    }
+
+    for (auto& core : _cores) {
+        core->window = core->stats.take();
+    }
+
+    uint64_t spike_ns = static_cast<uint64_t>(_spike_us) * 1000;
+    ThreadedLoop::for_each([this, spike_ns](ThreadedLoop& loop) {
+        LatencyStats::Window window = loop.wake_latency().take();
+        if (window.count == 0) {
+            return;
+        }
+
+        LoopReport& report = _loops[loop.name()];
+        report.cpu = loop.current_cpu();
+        report.window = window;
+        report.max_ns = loop.wake_latency().max_ns();
+
+        if (window.max_ns < spike_ns) {
+            return;
+        }
+        bool kernel = report.cpu >= 0 && report.cpu < static_cast<int>(_cores.size()) && _cores[report.cpu]->window.max_ns >= spike_ns;
+        if (kernel) {
+            ++report.kernel_spikes;
+        } else {
+            ++report.loop_spikes;
+        }
+        debug() << loop.name() << " woke up " << window.max_us() << " us late (" << (kernel ? "kernel" : "own code") << ")";
+    });
+}
+
+std::vector<double> LatencyProbe::values()
+{
+    std::vector<double> values(2 * cpu_count(), 0.);
+    for (std::size_t i = 0; i < _cores.size(); ++i) {
+        values[i] = _cores[i]->window.max_us();
+        values[cpu_count() + i] = _cores[i]->window.avg_us();
+    }
+    return values;
+}
+
+std::string LatencyProbe::report()
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+
+    if (!running()) {
+        out << "Latency probe stopped\n";
+    }
+    for (std::size_t i = 0; i < _cores.size(); ++i) {
+        const LatencyStats& stats = _cores[i]->stats;
+        out << "cpu" << i << ": max " << _cores[i]->window.max_us() << " us, avg " << _cores[i]->window.avg_us()
+            << " us, overall max " << stats.max_ns() / 1000. << " us over " << stats.count() << " wake-ups\n    ";
+        for (int b = 0; b < LatencyStats::buckets; ++b) {
+            if (stats.histogram(b)) {
+                out << (b < LatencyStats::buckets - 1 ? "<" : ">=") << (1 << (b < LatencyStats::buckets - 1 ? b : b - 1)) << "us:" << stats.histogram(b) << ' ';
+            }
+        }
+        out << '\n';
+    }
+
+    out << std::left << std::setw(24) << "loop" << std::right << std::setw(5) << "cpu" << std::setw(10) << "max_us"
+        << std::setw(10) << "avg_us" << std::setw(12) << "overall_us" << std::setw(8) << "kernel" << std::setw(8) << "own";
+    for (const auto& entry : _loops) {
+        const LoopReport& r = entry.second;
+        out << '\n'
+            << std::left << std::setw(24) << entry.first << std::right << std::setw(5) << r.cpu << std::setw(10) << r.window.max_us()
+            << std::setw(10) << r.window.avg_us() << std::setw(12) << r.max_ns / 1000. << std::setw(8) << r.kernel_spikes << std::setw(8) << r.loop_spikes;
+    }
+    return out.str();
+}
+
+}
@@ -0,0 +1,74 @@
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+#include "utils/latency_stats.h"
+#include "utils/named_object.h"
+#include "utils/param.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Monitoring {
+
+/**
+ * \brief Timer wake-up latency of each core, as measured by cyclictest.
+ *
+ * One SCHED_FIFO thread per core sleeps until an absolute deadline and
+ * records how late it woke up. update() collects the last window of each
+ * core and of each ThreadedLoop. A loop that woke up late while the probe
+ * of its core was on time was delayed by our own code, an overrun of its
+ * previous tick or of a loop sharing the core; otherwise the kernel is to
+ * blame.
+ *
+ * The probe threads preempt everything else on their core, so the probe is
+ * off until its enabled parameter is set.
+ */
+class LatencyProbe : public NamedObject {
+public:
+    explicit LatencyProbe(const NamedObject* parent = nullptr);
+    ~LatencyProbe() override;
+
+    void start();
+    void stop();
+    bool running() const { return !_cores.empty(); }
+
+    void update();
+    std::string report();
+
+    static int cpu_count();
+
+    // Window max then average of each core, in us
+    std::vector<double> values();
+
+private:
+    struct Core {
+        std::thread thread;
+        LatencyStats stats;
+        LatencyStats::Window window;
+    };
+
+    struct LoopReport {
+        int cpu;
+        LatencyStats::Window window;
+        uint64_t max_ns;
+        uint64_t kernel_spikes;
+        uint64_t loop_spikes;
+    };
+
+    void run(int cpu, Core& core);
+
+    Param<bool> _enabled;
+    Param<int> _interval_us;
+    Param<int> _prio;
+    Param<int> _spike_us;
+
+    std::atomic<bool> _run;
+    std::vector<std::unique_ptr<Core>> _cores;
+    std::map<std::string, LoopReport> _loops;
+};
+
+}
+
+#endif // LATENCYPROBE_H
@@ -0,0 +1,138 @@
+#include "proc_file.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Monitoring {
+
+Scanner::Scanner(const char* begin, const char* end)
+    : _pos(begin)
+    , _end(end)
+{
+}
+
+bool Scanner::starts_with(const char* prefix) const
+{
+    std::size_t len = strlen(prefix);
+    return _pos + len <= _end && memcmp(_pos, prefix, len) == 0;
+}
+
+void Scanner::skip_spaces()
+{
+    while (_pos < _end && (*_pos == ' ' || *_pos == '\t')) {
+        ++_pos;
+    }
+}
+
+void Scanner::skip_field()
+{
+    skip_spaces();
+    while (_pos < _end && *_pos != ' ' && *_pos != '\t' && *_pos != '\n') {
+        ++_pos;
+    }
+}
+
+void Scanner::skip_fields(int n)
+{
+    for (int i = 0; i < n; ++i) {
+        skip_field();
+    }
+}
+
+void Scanner::next_line()
+{
+    while (_pos < _end && *_pos != '\n') {
+        ++_pos;
+    }
+    if (_pos < _end) {
+        ++_pos;
+    }
+}
+
+bool Scanner::find(const char* key)
+{
+    std::size_t len = strlen(key);
+    for (const char* p = _pos; p + len <= _end; ++p) {
+        if (memcmp(p, key, len) == 0) {
+            _pos = p + len;
+            return true;
+        }
+    }
+    _pos = _end;
+    return false;
+}
+
+bool Scanner::find_last(char c)
+{
+    for (const char* p = _end; p > _pos; --p) {
+        if (p[-1] == c) {
+            _pos = p;
+            return true;
+        }
+    }
+    _pos = _end;
+    return false;
+}
+
+uint64_t Scanner::next_uint()
+{
+    skip_spaces();
+    uint64_t value = 0;
+    while (_pos < _end && *_pos >= '0' && *_pos <= '9') {
+        value = value * 10 + static_cast<uint64_t>(*_pos - '0');
+        ++_pos;
+    }
+    return value;
+}
+
+int64_t Scanner::next_int()
+{
+    skip_spaces();
+    if (_pos < _end && *_pos == '-') {
+        ++_pos;
+        return -static_cast<int64_t>(next_uint());
+    }
+    return static_cast<int64_t>(next_uint());
+}
+
+ProcFile::ProcFile(std::string path, std::size_t capacity)
+    : _path(path)
+    , _fd(open(path.c_str(), O_RDONLY | O_CLOEXEC))
+    , _buffer(capacity)
+    , _size(0)
+{
+}
+
+ProcFile::~ProcFile()
+{
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+bool ProcFile::read()
+{
+    if (_fd < 0) {
+        return false;
+    }
+    while (true) {
+        ssize_t n = pread(_fd, _buffer.data(), _buffer.size(), 0);
+        if (n < 0) {
+            _size = 0;
+            return false;
+        }
+        _size = static_cast<std::size_t>(n);
+        if (_size < _buffer.size()) {
+            return true;
+        }
+        // Only the first read of a larger file gets here
+        _buffer.resize(_buffer.size() * 2);
+    }
+}
+
+Scanner ProcFile::scanner() const
+{
+    return Scanner(_buffer.data(), _buffer.data() + _size);
+}
+
+}
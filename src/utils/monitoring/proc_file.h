@@ -0,0 +1,72 @@
+#ifndef PROCFILE_H
+#define PROCFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Monitoring {
+
+/**
+ * \brief Forward-only parser over the text of a procfs or sysfs file.
+ *
+ * Numbers are scanned in place, nothing is allocated.
+ */
+class Scanner {
+public:
+    Scanner(const char* begin, const char* end);
+
+    bool at_end() const { return _pos >= _end; }
+    const char* position() const { return _pos; }
+
+    bool starts_with(const char* prefix) const;
+
+    void skip_spaces();
+    void skip_field();
+    void skip_fields(int n);
+    void next_line();
+
+    // Moves after the next occurrence of key, or to the end
+    bool find(const char* key);
+    // Moves after the last occurrence of c, or to the end
+    bool find_last(char c);
+
+    uint64_t next_uint();
+    int64_t next_int();
+
+private:
+    const char* _pos;
+    const char* _end;
+};
+
+/**
+ * \brief procfs or sysfs file kept open and reread from the start.
+ *
+ * The file is opened once; read() is a single pread, which regenerates the
+ * content for these pseudo files.
+ */
+class ProcFile {
+public:
+    explicit ProcFile(std::string path, std::size_t capacity = 4096);
+    ~ProcFile();
+
+    ProcFile(const ProcFile&) = delete;
+    ProcFile& operator=(const ProcFile&) = delete;
+
+    bool good() const { return _fd >= 0; }
+    const std::string& path() const { return _path; }
+
+    // Returns false if the file could not be read, e.g. the thread is gone
+    bool read();
+    Scanner scanner() const;
+
+private:
+    std::string _path;
+    int _fd;
+    std::vector<char> _buffer;
+    std::size_t _size;
+};
+
+}
+
+#endif // PROCFILE_H
@@ -0,0 +1,62 @@
+#include "process_monitor.h"
+#include <sstream>
+#include <unistd.h>
+
+namespace Monitoring {
+
+ProcessMonitor::ProcessMonitor()
+    : _statm("/proc/self/statm", 256)
+    , _page_kb(sysconf(_SC_PAGESIZE) / 1024)
+    , _last_update(clock::now())
+    , _rss_kb(0)
+    , _minor_faults(0)
+    , _major_faults(0)
+    , _voluntary_switches(0)
+    , _involuntary_switches(0)
+{
+    getrusage(RUSAGE_SELF, &_last_usage);
+}
+
+ProcessMonitor::~ProcessMonitor()
+{
+}
+
+void ProcessMonitor::update()
+{
+    // size resident shared text lib data dt, in pages
+    if (_statm.read()) {
+        Scanner scanner = _statm.scanner();
+        scanner.skip_field();
+        _rss_kb = scanner.next_uint() * _page_kb;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    clock::time_point now = clock::now();
+    double dt = std::chrono::duration<double>(now - _last_update).count();
+
+    if (dt > 0) {
+        _minor_faults = (usage.ru_minflt - _last_usage.ru_minflt) / dt;
+        _major_faults = (usage.ru_majflt - _last_usage.ru_majflt) / dt;
+        _voluntary_switches = (usage.ru_nvcsw - _last_usage.ru_nvcsw) / dt;
+        _involuntary_switches = (usage.ru_nivcsw - _last_usage.ru_nivcsw) / dt;
+    }
+    _last_usage = usage;
+    _last_update = now;
+}
+
+std::string ProcessMonitor::formatted_output()
+{
+    std::ostringstream out;
+    out.precision(4);
+    out << "rss " << _rss_kb << "kB, faults " << _minor_faults << "/s minor " << _major_faults << "/s major, switches "
+        << _voluntary_switches << "/s voluntary " << _involuntary_switches << "/s involuntary";
+    return out.str();
+}
+
+std::vector<double> ProcessMonitor::values()
+{
+    return { _rss_kb, _minor_faults, _major_faults, _voluntary_switches, _involuntary_switches };
+}
+
+}
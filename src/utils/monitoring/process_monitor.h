@@ -0,0 +1,44 @@
+#ifndef PROCESSMONITOR_H
+#define PROCESSMONITOR_H
+
+#include "abstract_monitor.h"
+#include "proc_file.h"
+#include <chrono>
+#include <sys/resource.h>
+
+namespace Monitoring {
+
+/**
+ * \brief Resident memory, page faults and context switches of the process.
+ *
+ * Values are the RSS in kB followed by per second rates of minor and major
+ * faults, voluntary and involuntary context switches.
+ */
+class ProcessMonitor : public AbstractMonitor {
+public:
+    ProcessMonitor();
+    ~ProcessMonitor() override;
+
+    void update() override;
+    std::string formatted_output() override;
+    std::vector<double> values() override;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    ProcFile _statm;
+    long _page_kb;
+
+    struct rusage _last_usage;
+    clock::time_point _last_update;
+
+    double _rss_kb;
+    double _minor_faults;
+    double _major_faults;
+    double _voluntary_switches;
+    double _involuntary_switches;
+};
+
+}
+
+#endif // PROCESSMONITOR_H
@@ -0,0 +1,153 @@
+#include "thread_monitor.h"
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+namespace Monitoring {
+
+static const double ticks_per_s = static_cast<double>(sysconf(_SC_CLK_TCK));
+
+ThreadMonitor::Entry::Entry(pid_t tid)
+    : stat("/proc/self/task/" + std::to_string(tid) + "/stat", 1024)
+    , status("/proc/self/task/" + std::to_string(tid) + "/status")
+    , fresh(true)
+    , seen(true)
+    , ticks(0)
+    , minflt(0)
+    , majflt(0)
+    , voluntary(0)
+    , involuntary(0)
+    , thread({ tid, std::string(), 0., 0., 0., 0., 0. })
+{
+}
+
+bool ThreadMonitor::Entry::read(double dt)
+{
+    if (!stat.read() || !status.read()) {
+        return false;
+    }
+
+    // tid (comm) state ppid pgrp session tty tpgid flags minflt cminflt majflt cmajflt utime stime
+    Scanner scanner = stat.scanner();
+    scanner.find("(");
+    const char* name_begin = scanner.position();
+    scanner.find_last(')');
+    if (scanner.at_end()) {
+        return false;
+    }
+    thread.name.assign(name_begin, scanner.position() - 1);
+    scanner.skip_fields(7);
+    uint64_t new_minflt = scanner.next_uint();
+    scanner.skip_field();
+    uint64_t new_majflt = scanner.next_uint();
+    scanner.skip_field();
+    uint64_t new_ticks = scanner.next_uint();
+    new_ticks += scanner.next_uint();
+
+    scanner = status.scanner();
+    scanner.find("\nvoluntary_ctxt_switches:");
+    uint64_t new_voluntary = scanner.next_uint();
+    scanner.find("\nnonvoluntary_ctxt_switches:");
+    uint64_t new_involuntary = scanner.next_uint();
+
+    if (!fresh && dt > 0) {
+        thread.cpu_load = (new_ticks - ticks) / ticks_per_s / dt;
+        thread.minor_faults = (new_minflt - minflt) / dt;
+        thread.major_faults = (new_majflt - majflt) / dt;
+        thread.voluntary_switches = (new_voluntary - voluntary) / dt;
+        thread.involuntary_switches = (new_involuntary - involuntary) / dt;
+    }
+    fresh = false;
+
+    ticks = new_ticks;
+    minflt = new_minflt;
+    majflt = new_majflt;
+    voluntary = new_voluntary;
+    involuntary = new_involuntary;
+    return true;
+}
+
+ThreadMonitor::ThreadMonitor()
+    : _last_update(clock::now())
+{
+}
+
+ThreadMonitor::~ThreadMonitor()
+{
+}
+
+void ThreadMonitor::scan_tasks()
+{
+    for (auto& entry : _entries) {
+        entry.second->seen = false;
+    }
+
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir) {
+        return;
+    }
+    while (struct dirent* d = readdir(dir)) {
+        if (d->d_name[0] < '0' || d->d_name[0] > '9') {
+            continue;
+        }
+        pid_t tid = static_cast<pid_t>(atoi(d->d_name));
+        auto it = _entries.find(tid);
+        if (it == _entries.end()) {
+            _entries.emplace(tid, std::make_unique<Entry>(tid));
+        } else {
+            it->second->seen = true;
+        }
+    }
+    closedir(dir);
+
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it->second->seen) {
+            ++it;
+        } else {
+            it = _entries.erase(it);
+        }
+    }
+}
+
+void ThreadMonitor::update()
+{
+    clock::time_point now = clock::now();
+    double dt = std::chrono::duration<double>(now - _last_update).count();
+    _last_update = now;
+
+    scan_tasks();
+
+    _threads.clear();
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it->second->read(dt)) {
+            _threads.push_back(it->second->thread);
+            ++it;
+        } else {
+            // Exited between the scan and the read
+            it = _entries.erase(it);
+        }
+    }
+
+    std::sort(_threads.begin(), _threads.end(), [](const Thread& a, const Thread& b) { return a.cpu_load > b.cpu_load; });
+}
+
+std::string ThreadMonitor::formatted_output()
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << std::left << std::setw(8) << "tid" << std::setw(17) << "name" << std::right
+        << std::setw(7) << "cpu%" << std::setw(9) << "minflt/s" << std::setw(9) << "majflt/s"
+        << std::setw(9) << "vcsw/s" << std::setw(9) << "ivcsw/s";
+    for (const Thread& t : _threads) {
+        out << '\n'
+            << std::left << std::setw(8) << t.tid << std::setw(17) << t.name << std::right
+            << std::setw(7) << t.cpu_load * 100. << std::setw(9) << t.minor_faults << std::setw(9) << t.major_faults
+            << std::setw(9) << t.voluntary_switches << std::setw(9) << t.involuntary_switches;
+    }
+    return out.str();
+}
+
+}
@@ -0,0 +1,69 @@
+#ifndef THREADMONITOR_H
+#define THREADMONITOR_H
+
+#include "abstract_monitor.h"
+#include "proc_file.h"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <sys/types.h>
+
+namespace Monitoring {
+
+/**
+ * \brief CPU usage, page faults and context switches of each of our threads.
+ *
+ * Threads are named after their ThreadedLoop or Worker, truncated to the 15
+ * characters the kernel keeps. Rates are computed between two updates.
+ */
+class ThreadMonitor : public AbstractMonitor {
+public:
+    struct Thread {
+        pid_t tid;
+        std::string name;
+        double cpu_load; // fraction of one core
+        double minor_faults; // per second
+        double major_faults;
+        double voluntary_switches;
+        double involuntary_switches;
+    };
+
+    ThreadMonitor();
+    ~ThreadMonitor() override;
+
+    void update() override;
+    std::string formatted_output() override;
+
+    // Sorted by decreasing CPU load
+    const std::vector<Thread>& threads() const { return _threads; }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct Entry {
+        explicit Entry(pid_t tid);
+
+        bool read(double dt);
+
+        ProcFile stat;
+        ProcFile status;
+        bool fresh;
+        bool seen;
+        uint64_t ticks;
+        uint64_t minflt;
+        uint64_t majflt;
+        uint64_t voluntary;
+        uint64_t involuntary;
+        Thread thread;
+    };
+
+    void scan_tasks();
+
+    std::map<pid_t, std::unique_ptr<Entry>> _entries;
+    std::vector<Thread> _threads;
+    clock::time_point _last_update;
+};
+
+}
+
+#endif // THREADMONITOR_H
@@ -31,16 +31,13 @@ BaseParam::BaseParam(std::string name, Mode mode, NamedObject* parent)
     }
 
     if (_mode & Read) {
-        auto cb = [this](Mosquittopp::Message msg) {
-            _assign_raw(msg.payload());
-        };
-        _mqtt.subscribe(_topic_name, Mosquittopp::Client::QoS1)->add_callback(this, cb);
+        _mqtt.subscribe(_topic_name, [this](std::string payload) { _assign_raw(payload); }, Mosquittopp::Client::QoS1);
     }
 }
 
 BaseParam::~BaseParam()
 {
-    _mqtt.subscribe(_topic_name)->remove_callbacks(this);
+    _mqtt.unsubscribe(_topic_name);
     std::lock_guard<std::mutex> lock(_param_list_mutex);
     for (auto it = _param_list.begin(); it < _param_list.end(); ++it) {
         if (*it == this) {
@@ -0,0 +1,129 @@
+#include "param_block.h"
+#include "utils/log/log.h"
+#include "utils/threaded_loop.h"
+#include <cstdlib>
+#include <sstream>
+
+BaseParamBlock::BaseParamBlock(std::string name, ThreadedLoop* owner)
+    : NamedObject(name, owner)
+    , _owner(owner)
+    , _started(false)
+{
+    std::string fn = full_name().erase(0, NamedObject::base_name.size() + 1);
+    _topic_name = NamedObject::base_name + "/param_block/" + fn;
+}
+
+BaseParamBlock::~BaseParamBlock()
+{
+    stop();
+}
+
+void BaseParamBlock::start()
+{
+    if (_started) {
+        return;
+    }
+    _started = true;
+
+    std::string fields;
+    for (const std::string& name : field_names()) {
+        fields += (fields.empty() ? "" : ",") + name;
+    }
+    _mqtt.publish(_topic_name + "/fields", fields, Mosquittopp::Client::QoS1, true);
+
+    auto cb = [this](std::string payload) {
+        if (!stage_raw(payload)) {
+            warning() << "Rejected parameter transaction on " << _topic_name << ": " << payload;
+        }
+    };
+    _mqtt.subscribe(_topic_name, cb, Mosquittopp::Client::QoS1);
+
+    if (_owner) {
+        _owner->add_param_block(this);
+    }
+}
+
+void BaseParamBlock::stop()
+{
+    if (!_started) {
+        return;
+    }
+    _started = false;
+
+    // Waits for a transaction being staged
+    _mqtt.unsubscribe(_topic_name);
+    if (_owner) {
+        _owner->remove_param_block(this);
+    }
+}
+
+std::vector<std::string> BaseParamBlock::field_names()
+{
+    std::lock_guard<std::mutex> lock(_fields_mutex);
+    return _field_names;
+}
+
+bool BaseParamBlock::stage_raw(std::string transaction)
+{
+    const std::vector<std::string> field_names = this->field_names();
+    std::vector<std::pair<std::size_t, double>> values;
+    std::istringstream stream(transaction);
+    std::string token;
+    bool named = false;
+
+    while (stream >> token) {
+        std::size_t sep = token.find('=');
+        std::string value_str = token;
+        std::size_t index = values.size();
+
+        if (sep != std::string::npos) {
+            named = true;
+            std::string field = token.substr(0, sep);
+            value_str = token.substr(sep + 1);
+            index = field_names.size();
+            for (std::size_t i = 0; i < field_names.size(); ++i) {
+                if (field_names[i] == field) {
+                    index = i;
+                    break;
+                }
+            }
+        } else if (named) {
+            return false;
+        }
+
+        if (index >= field_names.size()) {
+            return false;
+        }
+
+        char* end = nullptr;
+        double v = std::strtod(value_str.c_str(), &end);
+        if (end == value_str.c_str() || *end != '\0') {
+            return false;
+        }
+        values.emplace_back(index, v);
+    }
+
+    // Positional transactions must carry the whole set
+    if (values.empty() || (!named && values.size() != field_names.size())) {
+        return false;
+    }
+
+    stage_values(values);
+    return true;
+}
+
+void BaseParamBlock::add_field_name(std::string name)
+{
+    std::lock_guard<std::mutex> lock(_fields_mutex);
+    _field_names.push_back(name);
+}
+
+void BaseParamBlock::publish_staged()
+{
+    std::stringstream stream;
+    std::vector<double> values = staged_values();
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        stream << (i ? " " : "") << values[i];
+    }
+    _mqtt.publish(_topic_name + "/value", stream.str(), Mosquittopp::Client::QoS1, true);
+}
@@ -0,0 +1,153 @@
+#ifndef PARAM_BLOCK_H
+#define PARAM_BLOCK_H
+
+#include "utils/interfaces/mqtt_user.h"
+#include "utils/named_object.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ThreadedLoop;
+
+/**
+ * \brief Set of parameters updated as a whole.
+ *
+ * Updates are staged from any thread (MQTT, menu, remote control...) and only
+ * become visible to the owning ThreadedLoop at the start of its next tick, so
+ * the loop never observes a partially updated set.
+ *
+ * Text transactions are accepted on sam/param_block/<name>, either as a full
+ * whitespace separated list of values in field order, or as name=value pairs.
+ * The block is only subscribed and attached to its owner between start(),
+ * called once every field is added, and stop().
+ */
+class BaseParamBlock : public MqttUser, public NamedObject {
+public:
+    BaseParamBlock(std::string name, ThreadedLoop* owner);
+    virtual ~BaseParamBlock() override = 0;
+
+    // Publishes the field names, then accepts transactions
+    void start();
+    void stop();
+
+    virtual bool apply() = 0;
+    bool stage_raw(std::string transaction);
+
+    std::string topic_name() { return _topic_name; }
+    std::vector<std::string> field_names();
+
+protected:
+    virtual void stage_values(const std::vector<std::pair<std::size_t, double>>& values) = 0;
+    virtual std::vector<double> staged_values() = 0;
+
+    void add_field_name(std::string name);
+    void publish_staged();
+
+private:
+    ThreadedLoop* _owner;
+    std::string _topic_name;
+    std::vector<std::string> _field_names;
+    std::mutex _fields_mutex;
+    bool _started;
+};
+
+template <typename T>
+class ParamBlock : public BaseParamBlock {
+public:
+    ParamBlock(std::string name, ThreadedLoop* owner, T default_values = T())
+        : BaseParamBlock(name, owner)
+        , _staged(default_values)
+        , _active(default_values)
+        , _pending(false)
+    {
+    }
+
+    ~ParamBlock() override
+    {
+        // Before the setters and the staging mutex are destroyed
+        stop();
+    }
+
+    template <typename U>
+    void add_field(std::string name, U T::*member, double scale = 1.)
+    {
+        add_field_name(name);
+        _setters.push_back([member, scale](T& p, double v) { p.*member = static_cast<U>(v * scale); });
+        _getters.push_back([member, scale](const T& p) { return static_cast<double>(p.*member) / scale; });
+    }
+
+    // Atomically modifies the staged set, visible to the owner at its next tick
+    void update(std::function<void(T&)> f)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_staging_mutex);
+            f(_staged);
+            _pending = true;
+        }
+        publish_staged();
+    }
+
+    void commit(const T& values)
+    {
+        update([&values](T& p) { p = values; });
+    }
+
+    T staged()
+    {
+        std::lock_guard<std::mutex> lock(_staging_mutex);
+        return _staged;
+    }
+
+    // Only valid from the owner's thread
+    const T& get() const { return _active; }
+    const T& operator()() const { return _active; }
+
+    // Called by the owner at tick start; never blocks
+    bool apply() override
+    {
+        if (!_pending) {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(_staging_mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return false;
+        }
+        _active = _staged;
+        _pending = false;
+        return true;
+    }
+
+protected:
+    void stage_values(const std::vector<std::pair<std::size_t, double>>& values) override
+    {
+        update([this, &values](T& p) {
+            for (auto& v : values) {
+                _setters[v.first](p, v.second);
+            }
+        });
+    }
+
+    std::vector<double> staged_values() override
+    {
+        std::vector<double> ret;
+        std::lock_guard<std::mutex> lock(_staging_mutex);
+        for (auto& g : _getters) {
+            ret.push_back(g(_staged));
+        }
+        return ret;
+    }
+
+private:
+    std::vector<std::function<void(T&, double)>> _setters;
+    std::vector<std::function<double(const T&)>> _getters;
+
+    std::mutex _staging_mutex;
+    T _staged;
+    T _active;
+    std::atomic<bool> _pending;
+};
+
+#endif // PARAM_BLOCK_H
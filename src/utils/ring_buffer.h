@@ -0,0 +1,80 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * \brief Fixed size, single producer single consumer queue.
+ *
+ * Neither side ever waits or takes a lock. When the queue is full the new
+ * item is refused, so the consumer always reads a contiguous history.
+ */
+template <typename T, std::size_t N>
+class RingBuffer {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "RingBuffer capacity must be a power of two");
+
+public:
+    RingBuffer()
+        : _head(0)
+        , _tail(0)
+    {
+    }
+
+    // Producer side
+    bool push(const T& item)
+    {
+        std::size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        _items[head & (N - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& item)
+    {
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = _items[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t pop(T* items, std::size_t max)
+    {
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+        std::size_t available = _head.load(std::memory_order_acquire) - tail;
+        std::size_t n = available < max ? available : max;
+        for (std::size_t i = 0; i < n; ++i) {
+            items[i] = _items[(tail + i) & (N - 1)];
+        }
+        _tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    void clear()
+    {
+        _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    std::size_t size() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    static constexpr std::size_t capacity() { return N; }
+
+private:
+    alignas(64) std::atomic<std::size_t> _head;
+    alignas(64) std::atomic<std::size_t> _tail;
+    std::array<T, N> _items;
+};
+
+#endif // RING_BUFFER_H
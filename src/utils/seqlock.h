@@ -0,0 +1,52 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * \brief Single writer, multiple readers value.
+ *
+ * The writer never waits and readers never take a lock: they retry only if
+ * the value was being written while they copied it.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock(T value = T())
+        : _seq(0)
+        , _value(value)
+    {
+    }
+
+    void store(const T& value)
+    {
+        unsigned int seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&_value, &value, sizeof(T));
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    T load() const
+    {
+        T value;
+        unsigned int before, after;
+        do {
+            before = _seq.load(std::memory_order_acquire);
+            std::memcpy(&value, &_value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = _seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return value;
+    }
+
+private:
+    std::atomic<unsigned int> _seq;
+    T _value;
+};
+
+#endif // SEQLOCK_H
@@ -1,6 +1,7 @@
 #include "serial_port.h"
 #include <chrono>
 #include <fcntl.h>
+#include <poll.h>
 #include <string.h>
 #include <termios.h>
 #include <unistd.h>
@@ -130,6 +131,47 @@ std::vector<std::byte> SerialPort::read_all()
     }
 }
 
+bool SerialPort::wait_available(std::chrono::microseconds timeout)
+{
+    struct pollfd pfd = { _fd, POLLIN, 0 };
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000) * 1000;
+    return ppoll(&pfd, 1, &ts, nullptr) > 0 && (pfd.revents & POLLIN);
+}
+
+void SerialPort::drain(std::chrono::microseconds quiet)
+{
+    const int max_reads = 64;
+
+    tcflush(_fd, TCIFLUSH);
+    for (int i = 0; i < max_reads && wait_available(quiet); ++i) {
+        read_all();
+    }
+}
+
+unsigned int SerialPort::bits_per_second()
+{
+    switch (_baudrate) {
+    case B9600:
+        return 9600;
+    case B19200:
+        return 19200;
+    case B38400:
+        return 38400;
+    case B57600:
+        return 57600;
+    case B115200:
+        return 115200;
+    case B230400:
+        return 230400;
+    case B460800:
+        return 460800;
+    default:
+        return 0;
+    }
+}
+
 void SerialPort::write(std::vector<std::byte> data)
 {
     write(reinterpret_cast<const char*>(data.data()), data.size());
@@ -148,9 +190,12 @@ void SerialPort::write(const char* data, std::size_t n)
         throw std::runtime_error("SerialPort::write called from a thread that is not the current owner of this SerialPort");
     }
     ssize_t w = ::write(_fd, data, n);
-    if (w < 0 || static_cast<std::size_t>(w) < n) {
+    if (w < 0) {
         throw std::runtime_error(port_name() + "::write: " + strerror(errno));
     }
+    if (static_cast<std::size_t>(w) < n) {
+        throw std::runtime_error(port_name() + "::write: short write (" + std::to_string(w) + "/" + std::to_string(n) + " bytes)");
+    }
 }
 
 bool SerialPort::check_ownership()
@@ -1,6 +1,7 @@
 #ifndef SERIALPORT_H
 #define SERIALPORT_H
 
+#include <chrono>
 #include <cstddef>
 #include <mutex>
 #include <string>
@@ -22,6 +23,8 @@ public:
 
     std::string port_name() { return _port_name; }
     unsigned int baudrate() { return _baudrate; }
+    // The baudrate is a termios speed constant (B230400...)
+    unsigned int bits_per_second();
 
     void take_ownership();
     bool try_take_ownership();
@@ -29,8 +32,31 @@ public:
 
     std::thread::id owner() { return _owner; }
 
+    // Owns the port until it goes out of scope, even when a transfer throws
+    class OwnershipGuard {
+    public:
+        explicit OwnershipGuard(SerialPort& port)
+            : _port(port)
+        {
+            _port.take_ownership();
+        }
+        ~OwnershipGuard() { _port.release_ownership(); }
+
+        OwnershipGuard(const OwnershipGuard&) = delete;
+        OwnershipGuard& operator=(const OwnershipGuard&) = delete;
+
+    private:
+        SerialPort& _port;
+    };
+
+    // Held by bus clients for a whole request/answer exchange
+    std::mutex& transaction_mutex() { return _transaction_mutex; }
+
     std::vector<std::byte> read(std::size_t n);
     std::vector<std::byte> read_all();
+    bool wait_available(std::chrono::microseconds timeout);
+    // Discards the input until the line stayed quiet for the given time
+    void drain(std::chrono::microseconds quiet);
 
     void write(std::vector<std::byte> data);
     void write(std::string s);
@@ -44,6 +70,7 @@ private:
     unsigned int _baudrate;
 
     std::mutex _mutex;
+    std::mutex _transaction_mutex;
     std::thread::id _owner;
     unsigned int _timeout_ms;
 };
@@ -0,0 +1,90 @@
+#include "executor.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace Sim {
+
+Executor::Executor(clock::time_point start)
+    : _now(start)
+{
+}
+
+Executor::~Executor()
+{
+    for (Entry& entry : _entries) {
+        if (entry.begun) {
+            entry.loop->end();
+        }
+    }
+}
+
+void Executor::add(ThreadedLoop& loop)
+{
+    if (loop.period() <= 0) {
+        throw std::runtime_error("Cannot simulate " + loop.full_name() + " without a period");
+    }
+    // Some loops start their own thread on construction
+    loop.stop_and_join();
+    // The supervisor checks deadlines against wall time
+    loop.unsupervise();
+    _entries.push_back({ &loop, _now, false });
+}
+
+void Executor::remove(ThreadedLoop& loop)
+{
+    auto it = std::find_if(_entries.begin(), _entries.end(), [&loop](const Entry& entry) { return entry.loop == &loop; });
+    if (it == _entries.end()) {
+        return;
+    }
+    if (it->begun) {
+        it->loop->end();
+    }
+    _entries.erase(it);
+}
+
+bool Executor::begin(Entry& entry)
+{
+    entry.loop->arm();
+    if (!entry.loop->begin(_now)) {
+        return false;
+    }
+    entry.begun = true;
+    entry.next = _now + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(entry.loop->period()));
+    return true;
+}
+
+std::size_t Executor::run_until(clock::time_point until)
+{
+    std::size_t ticks = 0;
+
+    while (true) {
+        // First entry with the earliest deadline, so ties keep the insertion order
+        auto it = std::min_element(_entries.begin(), _entries.end(), [](const Entry& a, const Entry& b) { return a.next < b.next; });
+        if (it == _entries.end() || it->next > until) {
+            break;
+        }
+        _now = it->next;
+
+        if (!it->begun) {
+            if (!begin(*it)) {
+                _entries.erase(it);
+            }
+            continue;
+        }
+
+        it->loop->step(it->next, _now);
+        ++ticks;
+
+        if (!it->loop->running()) {
+            it->loop->end();
+            _entries.erase(it);
+            continue;
+        }
+        it->next += std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(it->loop->period()));
+    }
+
+    _now = std::max(_now, until);
+    return ticks;
+}
+
+}
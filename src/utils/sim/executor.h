@@ -0,0 +1,50 @@
+#ifndef SIM_EXECUTOR_H
+#define SIM_EXECUTOR_H
+
+#include "utils/threaded_loop.h"
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace Sim {
+
+/**
+ * \brief Runs ThreadedLoops on a simulated clock, in the calling thread.
+ *
+ * The loops are stepped in deadline order and time jumps straight to the
+ * next deadline, so a run is as fast as the CPU allows and gives the same
+ * sequence of ticks every time. Loops sharing a deadline run in the order
+ * they were added. Simulated sensors and plants are loops too. Loops must be
+ * removed before they are destroyed.
+ */
+class Executor {
+public:
+    using clock = ThreadedLoop::clock;
+
+    explicit Executor(clock::time_point start = clock::time_point());
+    ~Executor();
+
+    void add(ThreadedLoop& loop);
+    void remove(ThreadedLoop& loop);
+
+    std::size_t run_until(clock::time_point until);
+    std::size_t run_for(clock::duration duration) { return run_until(_now + duration); }
+
+    clock::time_point now() const { return _now; }
+
+private:
+    struct Entry {
+        ThreadedLoop* loop;
+        clock::time_point next;
+        bool begun;
+    };
+
+    bool begin(Entry& entry);
+
+    clock::time_point _now;
+    std::vector<Entry> _entries;
+};
+
+}
+
+#endif // SIM_EXECUTOR_H
@@ -0,0 +1,59 @@
+#include "imu.h"
+#include "components/external/ximu/ximu.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Sim {
+
+// Q15 fixed point, as decoded by XIMU::process_packet_quaternion_data()
+static int16_t q15(double value)
+{
+    return static_cast<int16_t>(std::clamp(std::lround(value * 32768.), -32768L, 32767L));
+}
+
+IMU::IMU(std::string name, std::array<double, 3> axis, double amplitude_deg, double frequency_hz, double period_s)
+    : ThreadedLoop(name, period_s)
+    , _axis(axis)
+    , _amplitude(amplitude_deg * M_PI / 180.)
+    , _frequency(frequency_hz)
+    , _q({ 1., 0., 0., 0. })
+{
+    double norm = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    for (double& a : _axis) {
+        a /= norm;
+    }
+}
+
+bool IMU::setup()
+{
+    _start = clock::time_point::min();
+    return true;
+}
+
+void IMU::loop(double, clock::time_point time)
+{
+    if (_start == clock::time_point::min()) {
+        _start = time;
+    }
+    double t = std::chrono::duration<double>(time - _start).count();
+    double angle = _amplitude * std::sin(2. * M_PI * _frequency * t);
+    _q = { std::cos(angle / 2.), std::sin(angle / 2.) * _axis[0], std::sin(angle / 2.) * _axis[1], std::sin(angle / 2.) * _axis[2] };
+
+    unsigned char packet[10];
+    packet[0] = XIMU::PACKET_HEADER_QUATERNIONDATA;
+    for (int i = 0; i < 4; ++i) {
+        uint16_t v = static_cast<uint16_t>(q15(_q[i]));
+        packet[1 + 2 * i] = static_cast<unsigned char>(v >> 8);
+        packet[2 + 2 * i] = static_cast<unsigned char>(v & 0xff);
+    }
+    packet[9] = 0;
+    for (int i = 0; i < 9; ++i) {
+        packet[9] += packet[i];
+    }
+
+    unsigned char encoded[100];
+    int len = XIMU::encode_packet(packet, 10, encoded);
+    send(encoded, static_cast<std::size_t>(len));
+}
+
+}
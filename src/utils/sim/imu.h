@@ -0,0 +1,37 @@
+#ifndef SIM_IMU_H
+#define SIM_IMU_H
+
+#include "serial_device.h"
+#include "utils/threaded_loop.h"
+#include <array>
+
+namespace Sim {
+
+/**
+ * \brief x-IMU streaming quaternion packets, to be read by the XIMU driver.
+ *
+ * The sensor swings about a fixed axis, a sine of the given amplitude and
+ * frequency on the simulated clock. One packet is sent per tick. Commands from
+ * the driver are ignored.
+ */
+class IMU : public ThreadedLoop, public SerialDevice {
+public:
+    IMU(std::string name, std::array<double, 3> axis, double amplitude_deg, double frequency_hz, double period_s = 0.01);
+
+    std::array<double, 4> quaternion() const { return _q; }
+
+protected:
+    bool setup() override;
+    void loop(double dt, clock::time_point time) override;
+
+private:
+    std::array<double, 3> _axis;
+    double _amplitude;
+    double _frequency;
+    clock::time_point _start;
+    std::array<double, 4> _q;
+};
+
+}
+
+#endif // SIM_IMU_H
@@ -0,0 +1,357 @@
+#include "roboclaw.h"
+#include "components/internal/actuators/roboclaw/factory.h"
+#include "components/internal/actuators/roboclaw/message.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Sim {
+
+// Bytes after the command code, CRC excluded. Writes carry a CRC, reads do not.
+static int payload_size(uint8_t command)
+{
+    switch (command) {
+    case 0: // forward M1
+    case 1: // backward M1
+    case 4: // forward M2
+    case 5: // backward M2
+        return 1;
+    case 22: // set encoder M1
+    case 23: // set encoder M2
+    case 35: // speed M1
+    case 36: // speed M2
+        return 4;
+    case 37: // mixed speed
+        return 8;
+    case 44: // speed, acceleration and distance M1
+    case 45: // M2
+        return 13;
+    case 28: // velocity PID M1
+    case 29: // velocity PID M2
+        return 16;
+    case 65: // position M1
+    case 66: // position M2
+        return 17;
+    case 61: // position PID M1
+    case 62: // position PID M2
+        return 28;
+    case 67: // mixed position
+        return 33;
+    case 16: // encoder M1
+    case 17: // encoder M2
+    case 21: // firmware version
+    case 24: // main battery
+    case 30: // speed M1
+    case 31: // speed M2
+    case 47: // buffer lengths
+    case 49: // currents
+    case 55: // velocity PID M1
+    case 56: // velocity PID M2
+    case 63: // position PID M1
+    case 64: // position PID M2
+    case 78: // encoders
+    case 79: // speeds
+    case 90: // status
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+template <typename T>
+static T get(const uint8_t* p)
+{
+    uint64_t ret = 0;
+    for (unsigned int i = 0; i < sizeof(T); ++i) {
+        ret = (ret << 8) | p[i];
+    }
+    return static_cast<T>(ret);
+}
+
+template <typename T>
+static void put(std::vector<uint8_t>& out, T value)
+{
+    for (int i = static_cast<int>(sizeof(T)) - 1; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+    }
+}
+
+static uint16_t crc16(const std::vector<uint8_t>& data)
+{
+    std::vector<std::byte> packet(data.size());
+    std::memcpy(packet.data(), data.data(), data.size());
+    return RC::Message::crc16(packet);
+}
+
+RoboClaw::RoboClaw(std::string replaces, unsigned int baudrate, double period_s)
+    : ThreadedLoop("sim_roboclaw", period_s)
+    , _replaces(replaces)
+    , _run(true)
+    , _requests(0)
+    , _bad_requests(0)
+{
+    auto port = std::make_shared<SerialPort>(port_name(), baudrate);
+    port->open();
+    RC::Factory::add(_replaces, port);
+
+    _responder = std::thread(&RoboClaw::serve, this);
+}
+
+RoboClaw::~RoboClaw()
+{
+    _run = false;
+    _responder.join();
+    RC::Factory::remove(_replaces);
+    stop_and_join();
+}
+
+int32_t RoboClaw::encoder(uint8_t address, int channel)
+{
+    std::lock_guard lock(_mutex);
+    return static_cast<int32_t>(std::lround(_boards[address].motors[channel - 1].position));
+}
+
+void RoboClaw::loop(double dt, clock::time_point)
+{
+    std::lock_guard lock(_mutex);
+    for (auto& board : _boards) {
+        for (Motor& motor : board.second.motors) {
+            motor.step(dt);
+        }
+    }
+}
+
+void RoboClaw::serve()
+{
+    pthread_setname_np(pthread_self(), "sim_roboclaw_rx");
+
+    std::vector<uint8_t> in;
+    while (_run) {
+        uint8_t buf[256];
+        std::size_t n = receive(buf, sizeof(buf), 20);
+        in.insert(in.end(), buf, buf + n);
+
+        while (in.size() >= 2) {
+            int payload = payload_size(in[1]);
+            if (payload < 0) {
+                // Unknown command, the client times out and resynchronizes
+                ++_bad_requests;
+                in.clear();
+                break;
+            }
+            std::size_t size = 2 + static_cast<std::size_t>(payload) + (payload > 0 ? 2 : 0);
+            if (in.size() < size) {
+                break;
+            }
+
+            std::vector<uint8_t> request(in.begin(), in.begin() + static_cast<long>(size));
+            in.erase(in.begin(), in.begin() + static_cast<long>(size));
+            if (payload > 0 && crc16(std::vector<uint8_t>(request.begin(), request.end() - 2)) != get<uint16_t>(&request[size - 2])) {
+                ++_bad_requests;
+                continue;
+            }
+
+            ++_requests;
+            std::vector<uint8_t> answer = execute(request[0], request[1], request.data() + 2);
+            send(answer.data(), answer.size());
+        }
+    }
+}
+
+std::vector<uint8_t> RoboClaw::execute(uint8_t address, uint8_t command, const uint8_t* payload)
+{
+    std::lock_guard lock(_mutex);
+    Board& board = _boards[address];
+    Motor* m = board.motors;
+
+    std::vector<uint8_t> data;
+    switch (command) {
+    case 0:
+    case 4:
+        m[command == 4].set_speed(payload[0] / 127. * m[command == 4].qpps());
+        break;
+    case 1:
+    case 5:
+        m[command == 5].set_speed(-payload[0] / 127. * m[command == 5].qpps());
+        break;
+    case 22:
+    case 23:
+        m[command - 22].position = get<int32_t>(payload);
+        break;
+    case 35:
+    case 36:
+        m[command - 35].set_speed(get<int32_t>(payload));
+        break;
+    case 37:
+        m[0].set_speed(get<int32_t>(payload));
+        m[1].set_speed(get<int32_t>(payload + 4));
+        break;
+    case 44:
+    case 45: {
+        Motor& motor = m[command - 44];
+        double accel = get<uint32_t>(payload);
+        int32_t speed = get<int32_t>(payload + 4);
+        double distance = get<uint32_t>(payload + 8);
+        bool buffered = payload[12] == 0;
+        double from = buffered ? motor.last_target() : motor.position;
+        motor.command({ accel, std::fabs(static_cast<double>(speed)), accel, from + (speed < 0 ? -distance : distance) }, buffered);
+        break;
+    }
+    case 28:
+    case 29:
+        m[command - 28].velocity_pid.assign(payload, payload + 16);
+        break;
+    case 65:
+    case 66:
+        m[command - 65].command({ static_cast<double>(get<uint32_t>(payload)), static_cast<double>(get<uint32_t>(payload + 4)), static_cast<double>(get<uint32_t>(payload + 8)), static_cast<double>(get<int32_t>(payload + 12)) }, payload[16] == 0);
+        break;
+    case 61:
+    case 62:
+        m[command - 61].position_pid.assign(payload, payload + 28);
+        break;
+    case 67:
+        for (int i = 0; i < 2; ++i) {
+            const uint8_t* p = payload + 16 * i;
+            m[i].command({ static_cast<double>(get<uint32_t>(p)), static_cast<double>(get<uint32_t>(p + 4)), static_cast<double>(get<uint32_t>(p + 8)), static_cast<double>(get<int32_t>(p + 12)) }, payload[32] == 0);
+        }
+        break;
+    case 16:
+    case 17:
+        put(data, static_cast<int32_t>(std::lround(m[command - 16].position)));
+        put<uint8_t>(data, 0);
+        break;
+    case 30:
+    case 31:
+        put(data, static_cast<int32_t>(std::lround(m[command - 30].speed)));
+        put<uint8_t>(data, m[command - 30].speed < 0 ? 1 : 0);
+        break;
+    case 21: {
+        const char version[] = "USB Roboclaw 2x7a v4.1.34\n";
+        data.assign(version, version + sizeof(version));
+        break;
+    }
+    case 24:
+        put<uint16_t>(data, 120);
+        break;
+    case 47:
+        put(data, m[0].buffer());
+        put(data, m[1].buffer());
+        break;
+    case 49:
+        // Current grows with the speed, 1 A at full speed
+        for (int i = 0; i < 2; ++i) {
+            put(data, static_cast<int16_t>(std::lround(100. * std::fabs(m[i].speed) / m[i].qpps())));
+        }
+        break;
+    case 55:
+    case 56:
+        data = m[command - 55].velocity_pid;
+        break;
+    case 63:
+    case 64:
+        data = m[command - 63].position_pid;
+        break;
+    case 78:
+        put(data, static_cast<int32_t>(std::lround(m[0].position)));
+        put(data, static_cast<int32_t>(std::lround(m[1].position)));
+        break;
+    case 79:
+        put(data, static_cast<int32_t>(std::lround(m[0].speed)));
+        put(data, static_cast<int32_t>(std::lround(m[1].speed)));
+        break;
+    case 90:
+        put<uint32_t>(data, 0);
+        break;
+    }
+
+    if (payload_size(command) > 0) {
+        return std::vector<uint8_t>(1, 0xff);
+    }
+    std::vector<uint8_t> crc_input = { address, command };
+    crc_input.insert(crc_input.end(), data.begin(), data.end());
+    put(data, crc16(crc_input));
+    return data;
+}
+
+double RoboClaw::Motor::qpps() const
+{
+    uint32_t qpps = get<uint32_t>(velocity_pid.data() + 12);
+    return qpps > 0 ? qpps : 10000.;
+}
+
+uint8_t RoboClaw::Motor::buffer() const
+{
+    if (!position_mode || (!move && queue.empty())) {
+        return 0x80;
+    }
+    return static_cast<uint8_t>(queue.size());
+}
+
+void RoboClaw::Motor::set_speed(double value)
+{
+    position_mode = false;
+    move.reset();
+    queue.clear();
+    speed = value;
+}
+
+double RoboClaw::Motor::last_target() const
+{
+    if (!queue.empty()) {
+        return queue.back().pos;
+    }
+    return move ? move->pos : position;
+}
+
+void RoboClaw::Motor::command(const Move& m, bool buffered)
+{
+    if (!position_mode) {
+        position_mode = true;
+        move.reset();
+        queue.clear();
+    }
+    if (buffered) {
+        queue.push_back(m);
+    } else {
+        queue.clear();
+        move = m;
+    }
+}
+
+void RoboClaw::Motor::step(double dt)
+{
+    if (!position_mode) {
+        position += speed * dt;
+        return;
+    }
+    if (!move) {
+        if (queue.empty()) {
+            speed = 0.;
+            return;
+        }
+        move = queue.front();
+        queue.pop_front();
+    }
+
+    // Trapezoidal profile: accelerate up to the move speed, then brake to stop on the target
+    double distance = move->pos - position;
+    double dir = distance < 0 ? -1. : 1.;
+    double v = speed * dir;
+    double v_target = std::min(move->speed, std::sqrt(2. * std::max(1., move->decel) * std::fabs(distance)));
+    if (v < v_target) {
+        v = std::min(v_target, v + std::max(1., move->accel) * dt);
+    } else {
+        v = std::max(v_target, v - std::max(1., move->decel) * dt);
+    }
+
+    if (v * dt >= std::fabs(distance)) {
+        position = move->pos;
+        speed = queue.empty() ? 0. : dir * v;
+        move.reset();
+    } else {
+        position += dir * v * dt;
+        speed = dir * v;
+    }
+}
+
+}
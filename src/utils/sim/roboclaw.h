@@ -0,0 +1,84 @@
+#ifndef SIM_ROBOCLAW_H
+#define SIM_ROBOCLAW_H
+
+#include "serial_device.h"
+#include "utils/threaded_loop.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <termios.h>
+#include <thread>
+#include <vector>
+
+namespace Sim {
+
+/**
+ * \brief RoboClaw boards on one serial line, driven by the actuators.
+ *
+ * Requests are answered from a thread of their own, so RC::RoboClaw blocks on
+ * the line as it does with the real boards. Every address answers and has two
+ * motors. The motors only move when the loop is stepped: velocity and duty
+ * commands apply at once, position commands follow a trapezoidal profile and
+ * queue up when buffered. While it exists, RC::Factory hands this line out
+ * instead of the device of the real boards.
+ */
+class RoboClaw : public ThreadedLoop, public SerialDevice {
+public:
+    explicit RoboClaw(std::string replaces = "/dev/ttyAMA0", unsigned int baudrate = B230400, double period_s = 0.001);
+    ~RoboClaw() override;
+
+    int32_t encoder(uint8_t address, int channel);
+    std::size_t requests() const { return _requests; }
+    std::size_t bad_requests() const { return _bad_requests; }
+
+protected:
+    void loop(double dt, clock::time_point time) override;
+
+private:
+    struct Move {
+        double accel;
+        double speed;
+        double decel;
+        double pos;
+    };
+
+    struct Motor {
+        bool position_mode = false;
+        double position = 0.;
+        double speed = 0.;
+        std::optional<Move> move;
+        std::deque<Move> queue;
+        std::vector<uint8_t> velocity_pid = std::vector<uint8_t>(16, 0);
+        std::vector<uint8_t> position_pid = std::vector<uint8_t>(28, 0);
+
+        void step(double dt);
+        void set_speed(double value);
+        void command(const Move& m, bool buffered);
+        double last_target() const;
+        double qpps() const;
+        uint8_t buffer() const;
+    };
+
+    struct Board {
+        Motor motors[2];
+    };
+
+    void serve();
+    std::vector<uint8_t> execute(uint8_t address, uint8_t command, const uint8_t* payload);
+
+    std::string _replaces;
+    std::map<uint8_t, Board> _boards;
+    std::mutex _mutex;
+
+    std::atomic<bool> _run;
+    std::thread _responder;
+    std::atomic<std::size_t> _requests;
+    std::atomic<std::size_t> _bad_requests;
+};
+
+}
+
+#endif // SIM_ROBOCLAW_H
@@ -0,0 +1,77 @@
+#include "serial_device.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace Sim {
+
+SerialDevice::SerialDevice()
+    : _master(-1)
+    , _slave(-1)
+{
+    _master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (_master < 0 || grantpt(_master) != 0 || unlockpt(_master) != 0) {
+        int err = errno;
+        if (_master >= 0) {
+            close(_master);
+        }
+        throw std::runtime_error(std::string("Failed to create a pseudo terminal: ") + strerror(err));
+    }
+
+    char name[64];
+    if (ptsname_r(_master, name, sizeof(name)) != 0) {
+        close(_master);
+        throw std::runtime_error("Failed to name the pseudo terminal");
+    }
+    _port_name = name;
+
+    _slave = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (_slave < 0) {
+        int err = errno;
+        close(_master);
+        throw std::runtime_error(_port_name + ": " + strerror(err));
+    }
+    struct termios tio;
+    tcgetattr(_slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(_slave, TCSANOW, &tio);
+}
+
+SerialDevice::~SerialDevice()
+{
+    close(_slave);
+    close(_master);
+}
+
+std::size_t SerialDevice::receive(void* data, std::size_t size, int timeout_ms)
+{
+    pollfd pfd = { _master, POLLIN, 0 };
+    if (poll(&pfd, 1, timeout_ms) <= 0 || !(pfd.revents & POLLIN)) {
+        return 0;
+    }
+    ssize_t n = read(_master, data, size);
+    return n > 0 ? static_cast<std::size_t>(n) : 0;
+}
+
+void SerialDevice::send(const void* data, std::size_t size)
+{
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = write(_master, p, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+}
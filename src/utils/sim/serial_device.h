@@ -0,0 +1,39 @@
+#ifndef SIM_SERIAL_DEVICE_H
+#define SIM_SERIAL_DEVICE_H
+
+#include <cstddef>
+#include <string>
+
+namespace Sim {
+
+/**
+ * \brief Device end of a pseudo terminal.
+ *
+ * The code under test opens port_name() with SerialPort as if it were the
+ * device node of the real peripheral. The slave side is kept open and raw so
+ * the line neither hangs up nor echoes before the client opens it.
+ */
+class SerialDevice {
+public:
+    SerialDevice();
+    virtual ~SerialDevice();
+
+    SerialDevice(const SerialDevice&) = delete;
+    SerialDevice& operator=(const SerialDevice&) = delete;
+
+    const std::string& port_name() const { return _port_name; }
+
+protected:
+    // Waits up to timeout_ms for data from the client, returns the number of bytes read
+    std::size_t receive(void* data, std::size_t size, int timeout_ms);
+    void send(const void* data, std::size_t size);
+
+private:
+    int _master;
+    int _slave;
+    std::string _port_name;
+};
+
+}
+
+#endif // SIM_SERIAL_DEVICE_H
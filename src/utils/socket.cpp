@@ -1,21 +1,30 @@
 #include "socket.h"
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <stdexcept>
 #include <sys/socket.h>
+#include <unistd.h>
 
 Socket::Socket()
     : _sock_fd(socket(AF_INET, SOCK_DGRAM, 0))
+    , _last_sender()
+    , _has_sender(false)
 {
     if (_sock_fd < 0) {
         throw std::runtime_error("Failed to create socket");
     }
 }
 
+Socket::~Socket()
+{
+    close(_sock_fd);
+}
+
 bool Socket::bind(std::string address, int port)
 {
     struct sockaddr_in s;
-    s.sin_addr.s_addr = htonl(inet_addr(address.c_str()));
+    s.sin_addr.s_addr = inet_addr(address.c_str());
     s.sin_family = AF_INET;
     s.sin_port = htons(static_cast<in_port_t>(port));
 
@@ -27,12 +36,28 @@ bool Socket::available()
     return recv(_sock_fd, _buf, _buf_sz, MSG_DONTWAIT | MSG_PEEK) > 0;
 }
 
+bool Socket::wait_available(int timeout_ms)
+{
+    struct pollfd pfd = { _sock_fd, POLLIN, 0 };
+    return poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN);
+}
+
 std::vector<std::byte> Socket::receive()
 {
-    ssize_t n = recv(_sock_fd, _buf, _buf_sz, MSG_DONTWAIT);
+    socklen_t len = sizeof(_last_sender);
+    ssize_t n = recvfrom(_sock_fd, _buf, _buf_sz, MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&_last_sender), &len);
     if (n > 0) {
+        _has_sender = true;
         return std::vector<std::byte>(_buf, _buf + n);
     } else {
         return std::vector<std::byte>();
     }
 }
+
+bool Socket::reply(const std::vector<std::byte>& data)
+{
+    if (!_has_sender) {
+        return false;
+    }
+    return sendto(_sock_fd, data.data(), data.size(), MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&_last_sender), sizeof(_last_sender)) == static_cast<ssize_t>(data.size());
+}
@@ -1,20 +1,29 @@
 #ifndef SOCKET_H
 #define SOCKET_H
 
+#include <netinet/in.h>
 #include <string>
 #include <vector>
 
 class Socket {
 public:
     Socket();
+    ~Socket();
+
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
 
     bool bind(std::string address, int port);
 
     bool available();
+    bool wait_available(int timeout_ms);
     std::vector<std::byte> receive();
+    bool reply(const std::vector<std::byte>& data);
 
 private:
     int _sock_fd;
+    struct sockaddr_in _last_sender;
+    bool _has_sender;
 
     static const std::size_t _buf_sz = 1024;
     std::byte _buf[_buf_sz];
@@ -0,0 +1,211 @@
+#include "supervisor.h"
+#include "utils/log/log.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/watchdog.h>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+
+Supervisor::Heartbeat::Heartbeat(std::string name, std::chrono::milliseconds deadline, Policy policy, bool critical, std::function<void()> restart)
+    : _name(name)
+    , _deadline(deadline)
+    , _policy(policy)
+    , _critical(critical)
+    , _restart(restart)
+    , _last_ns(0)
+    , _failed(false)
+    , _failures(0)
+{
+}
+
+Supervisor::Supervisor()
+    : Worker("supervisor", Worker::Continuous)
+    , NamedObject("supervisor")
+    , MenuUser("sup", "Loop supervisor")
+    , _period_ms("period_ms", BaseParam::ReadWrite, this, 10.)
+    , _hardware_watchdog("hardware_watchdog", BaseParam::ReadWrite, this, false)
+    , _hardware_timeout_s("hardware_timeout_s", BaseParam::ReadWrite, this, 10)
+    , _healthy(true)
+    , _next(clock::now())
+    , _watchdog_fd(-1)
+{
+    _menu->add_item("s", "Show heartbeats", [this](std::string) { show_status(); });
+
+    do_work();
+}
+
+Supervisor::~Supervisor()
+{
+    stop();
+    close_hardware_watchdog();
+}
+
+Supervisor& Supervisor::instance()
+{
+    static Supervisor s;
+    return s;
+}
+
+int64_t Supervisor::now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+}
+
+Supervisor::Heartbeat* Supervisor::add(std::string name, std::chrono::milliseconds deadline, Policy policy, bool critical, std::function<void()> restart)
+{
+    std::lock_guard lock(_heartbeats_mutex);
+    _heartbeats.push_back(std::unique_ptr<Heartbeat>(new Heartbeat(name, deadline, policy, critical, restart)));
+    return _heartbeats.back().get();
+}
+
+void Supervisor::remove(Heartbeat* heartbeat)
+{
+    std::lock_guard callbacks_lock(_callbacks_mutex);
+    std::lock_guard lock(_heartbeats_mutex);
+    _heartbeats.erase(std::remove_if(_heartbeats.begin(), _heartbeats.end(), [heartbeat](const auto& h) { return h.get() == heartbeat; }), _heartbeats.end());
+}
+
+void Supervisor::set_safe_stop(std::function<void()> safe_stop)
+{
+    std::lock_guard lock(_safe_stop_mutex);
+    _safe_stop = safe_stop;
+}
+
+void Supervisor::show_status()
+{
+    int64_t now = now_ns();
+    std::lock_guard lock(_heartbeats_mutex);
+    for (const auto& h : _heartbeats) {
+        int64_t last = h->_last_ns;
+        std::string state = last == 0 ? "idle" : std::to_string((now - last) / 1000000) + " ms ago";
+        info() << h->_name << (h->_critical ? " (critical)" : "") << ": " << state << ", deadline " << h->_deadline.count() << " ms, " << h->_failures << " failures";
+    }
+    info() << "Hardware watchdog " << (_watchdog_fd >= 0 ? "armed" : "off") << ", " << (_healthy ? "healthy" : "not kicked");
+}
+
+void Supervisor::work()
+{
+    _next += std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::milli>(_period_ms.to()));
+    std::this_thread::sleep_until(_next);
+    if (_next < clock::now()) {
+        _next = clock::now();
+    }
+
+    if (_hardware_watchdog.changed()) {
+        if (_hardware_watchdog) {
+            open_hardware_watchdog();
+        } else {
+            close_hardware_watchdog();
+        }
+    }
+
+    check();
+
+    if (_healthy) {
+        kick_hardware_watchdog();
+    }
+}
+
+void Supervisor::check()
+{
+    // Taken before the heartbeats, restart callbacks may remove their own entry
+    std::lock_guard callbacks_lock(_callbacks_mutex);
+
+    std::vector<std::function<void()>> restarts;
+    bool safe_stop = false;
+    bool healthy = true;
+    int64_t now = now_ns();
+
+    {
+        std::lock_guard lock(_heartbeats_mutex);
+        for (const auto& h : _heartbeats) {
+            int64_t last = h->_last_ns.load(std::memory_order_relaxed);
+            if (last == 0) {
+                h->_failed = false;
+                continue;
+            }
+
+            bool late = now - last > std::chrono::duration_cast<std::chrono::nanoseconds>(h->_deadline).count();
+            if (late && h->_critical) {
+                healthy = false;
+            }
+
+            if (late && !h->_failed) {
+                h->_failed = true;
+                ++h->_failures;
+                critical() << h->_name << " missed its " << h->_deadline.count() << " ms deadline";
+                if (h->_policy == Restart && h->_restart) {
+                    restarts.push_back(h->_restart);
+                } else if (h->_policy == SafeStop) {
+                    safe_stop = true;
+                }
+            } else if (!late && h->_failed) {
+                h->_failed = false;
+                info() << h->_name << " recovered";
+            }
+        }
+    }
+
+    _healthy = healthy;
+
+    // Outside of the heartbeats lock, components may add or remove heartbeats
+    if (safe_stop) {
+        std::lock_guard lock(_safe_stop_mutex);
+        if (_safe_stop) {
+            critical() << "Stopping the actuators";
+            try {
+                _safe_stop();
+            } catch (std::exception& e) {
+                critical() << "Safe stop failed: " << e.what();
+            }
+        }
+    }
+    for (auto& restart : restarts) {
+        try {
+            restart();
+        } catch (std::exception& e) {
+            critical() << "Restart failed: " << e.what();
+        }
+    }
+}
+
+void Supervisor::open_hardware_watchdog()
+{
+    if (_watchdog_fd >= 0) {
+        return;
+    }
+    _watchdog_fd = open("/dev/watchdog", O_WRONLY | O_CLOEXEC);
+    if (_watchdog_fd < 0) {
+        critical() << "Failed to open /dev/watchdog: " << strerror(errno);
+        return;
+    }
+    int timeout = _hardware_timeout_s;
+    ioctl(_watchdog_fd, WDIOC_SETTIMEOUT, &timeout);
+    _last_kick = clock::time_point();
+    info() << "Hardware watchdog armed, " << timeout << " s";
+}
+
+void Supervisor::close_hardware_watchdog()
+{
+    if (_watchdog_fd < 0) {
+        return;
+    }
+    // Magic close, the watchdog is disabled instead of resetting the board
+    if (write(_watchdog_fd, "V", 1) != 1) {
+        critical() << "Hardware watchdog magic close failed";
+    }
+    close(_watchdog_fd);
+    _watchdog_fd = -1;
+}
+
+void Supervisor::kick_hardware_watchdog()
+{
+    clock::time_point now = clock::now();
+    if (_watchdog_fd < 0 || now - _last_kick < std::chrono::seconds(1)) {
+        return;
+    }
+    ioctl(_watchdog_fd, WDIOC_KEEPALIVE, nullptr);
+    _last_kick = now;
+}
@@ -0,0 +1,105 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include "utils/interfaces/menu_user.h"
+#include "utils/named_object.h"
+#include "utils/param.h"
+#include "utils/worker.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * \brief Watches the heartbeats of the loops from a single thread.
+ *
+ * Each supervised loop owns a heartbeat it writes without locking. An entry
+ * is armed by its first beat and disarmed when its loop stops. When an armed
+ * entry misses its deadline the supervisor applies its policy once: log it,
+ * ask the component to restart, or stop every actuator.
+ *
+ * When hardware_watchdog is set, /dev/watchdog is kicked only while all the
+ * critical entries are healthy, so the board is reset if the motor path or
+ * the supervisor itself hangs. It is released with the magic close on exit.
+ */
+class Supervisor : public Worker, public NamedObject, public MenuUser {
+public:
+    enum Policy {
+        Log,
+        Restart,
+        SafeStop
+    };
+
+    class Heartbeat {
+    public:
+        void beat() { _last_ns.store(now_ns(), std::memory_order_relaxed); }
+        void disarm() { _last_ns.store(0, std::memory_order_relaxed); }
+
+        const std::string& name() const { return _name; }
+
+    private:
+        friend class Supervisor;
+
+        Heartbeat(std::string name, std::chrono::milliseconds deadline, Policy policy, bool critical, std::function<void()> restart);
+
+        std::string _name;
+        std::chrono::milliseconds _deadline;
+        Policy _policy;
+        bool _critical;
+        std::function<void()> _restart;
+
+        std::atomic<int64_t> _last_ns; // 0 when disarmed
+
+        // Supervisor thread only
+        bool _failed;
+        uint32_t _failures;
+    };
+
+    static Supervisor& instance();
+
+    Heartbeat* add(std::string name, std::chrono::milliseconds deadline, Policy policy = Log, bool critical = false, std::function<void()> restart = nullptr);
+    void remove(Heartbeat* heartbeat);
+
+    // Called from the supervisor thread when a SafeStop entry fails
+    void set_safe_stop(std::function<void()> safe_stop);
+
+    bool healthy() const { return _healthy; }
+    void show_status();
+
+    static int64_t now_ns();
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    Supervisor();
+    ~Supervisor() override;
+
+    void work() override;
+    void check();
+
+    void open_hardware_watchdog();
+    void close_hardware_watchdog();
+    void kick_hardware_watchdog();
+
+    Param<double> _period_ms;
+    Param<bool> _hardware_watchdog;
+    Param<int> _hardware_timeout_s;
+
+    std::vector<std::unique_ptr<Heartbeat>> _heartbeats;
+    std::mutex _heartbeats_mutex;
+    // Held while the restart callbacks run, so remove() returns once none can run anymore
+    std::recursive_mutex _callbacks_mutex;
+
+    std::function<void()> _safe_stop;
+    std::mutex _safe_stop_mutex;
+
+    std::atomic<bool> _healthy;
+    clock::time_point _next;
+
+    int _watchdog_fd;
+    clock::time_point _last_kick;
+};
+
+#endif // SUPERVISOR_H
@@ -0,0 +1,58 @@
+#include "budget.h"
+#include <algorithm>
+
+namespace Telemetry {
+
+Budget::Budget()
+    : _rate(64000.)
+    , _tokens(64000.)
+    , _last_refill(std::chrono::steady_clock::now())
+{
+}
+
+Budget& Budget::global()
+{
+    static Budget b;
+    return b;
+}
+
+void Budget::set_rate(double bytes_per_s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    refill();
+    _rate = std::max(0., bytes_per_s);
+    _tokens = std::min(_tokens, _rate);
+}
+
+double Budget::rate()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _rate;
+}
+
+bool Budget::try_consume(std::size_t bytes, bool force)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    refill();
+    if (!force && _tokens < static_cast<double>(bytes)) {
+        return false;
+    }
+    _tokens -= static_cast<double>(bytes);
+    return true;
+}
+
+double Budget::available()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    refill();
+    return _tokens;
+}
+
+void Budget::refill()
+{
+    auto now = std::chrono::steady_clock::now();
+    _tokens = std::min(_rate, _tokens + _rate * std::chrono::duration<double>(now - _last_refill).count());
+    _last_refill = now;
+}
+
+}
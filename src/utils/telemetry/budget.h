@@ -0,0 +1,43 @@
+#ifndef TELEMETRY_BUDGET_H
+#define TELEMETRY_BUDGET_H
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace Telemetry {
+
+enum Priority {
+    Low,
+    Normal,
+    High,
+    Critical
+};
+
+/**
+ * \brief Global MQTT bandwidth budget (token bucket, one second of burst).
+ */
+class Budget {
+public:
+    static Budget& global();
+
+    void set_rate(double bytes_per_s);
+    double rate();
+
+    // Forced consumptions always succeed but still drain the bucket
+    bool try_consume(std::size_t bytes, bool force = false);
+    double available();
+
+private:
+    Budget();
+    void refill();
+
+    std::mutex _mutex;
+    double _rate;
+    double _tokens;
+    std::chrono::steady_clock::time_point _last_refill;
+};
+
+}
+
+#endif // TELEMETRY_BUDGET_H
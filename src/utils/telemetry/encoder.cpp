@@ -0,0 +1,161 @@
+#include "encoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace Telemetry {
+
+Encoder::Encoder(Schema schema, unsigned int keyframe_interval)
+    : _schema(schema)
+    , _keyframe_interval(std::max(1u, keyframe_interval))
+    , _frames_since_keyframe(0)
+    , _previous_encoding(Text)
+    , _seq(0)
+    , _previous(schema.fields().size(), 0)
+{
+}
+
+std::string Encoder::encode(const std::vector<double>& values, Encoding encoding, uint32_t t_ms)
+{
+    std::string out;
+
+    if (encoding == Text) {
+        encode_text(values, out);
+        _previous_encoding = encoding;
+        return out;
+    }
+
+    bool keyframe = encoding != DeltaVarint || _previous_encoding != DeltaVarint || _frames_since_keyframe >= _keyframe_interval;
+    _previous_encoding = encoding;
+
+    out.reserve(_schema.packed_size());
+    put_le(out, static_cast<uint8_t>(encoding), 1);
+    put_le(out, keyframe ? keyframe_flag : 0, 1);
+    put_le(out, _seq++, 2);
+    put_le(out, t_ms, 4);
+
+    if (keyframe) {
+        encode_packed(values, out);
+        _frames_since_keyframe = 0;
+    } else {
+        encode_delta(values, out);
+    }
+    ++_frames_since_keyframe;
+
+    return out;
+}
+
+void Encoder::encode_text(const std::vector<double>& values, std::string& out)
+{
+    char buf[64];
+    const auto& fields = _schema.fields();
+
+    for (std::size_t i = 0; i < fields.size() && i < values.size(); ++i) {
+        const TextFormat& text = fields[i].text;
+        int len;
+        if (fields[i].is_integer()) {
+            len = std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(to_integer(values[i], fields[i].type)));
+        } else {
+            len = std::snprintf(buf, sizeof(buf), text.fixed ? "%.*f" : "%.*g", text.precision, values[i]);
+        }
+        if (i) {
+            out.push_back(' ');
+        }
+        out.append(buf, std::min(static_cast<std::size_t>(std::max(len, 0)), sizeof(buf) - 1));
+        out.append(text.unit);
+    }
+}
+
+void Encoder::encode_packed(const std::vector<double>& values, std::string& out)
+{
+    const auto& fields = _schema.fields();
+
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        double v = i < values.size() ? values[i] : 0.;
+        if (fields[i].is_integer()) {
+            _previous[i] = to_integer(v, fields[i].type);
+            put_le(out, static_cast<uint64_t>(_previous[i]), fields[i].size());
+        } else {
+            put_float(out, v);
+        }
+    }
+}
+
+void Encoder::encode_delta(const std::vector<double>& values, std::string& out)
+{
+    const auto& fields = _schema.fields();
+
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        double v = i < values.size() ? values[i] : 0.;
+        if (fields[i].is_integer()) {
+            int64_t current = to_integer(v, fields[i].type);
+            int64_t delta = current - _previous[i];
+            _previous[i] = current;
+            // zigzag so that small negative deltas stay small
+            put_varint(out, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+        } else {
+            put_float(out, v);
+        }
+    }
+}
+
+int64_t Encoder::to_integer(double v, Field::Type type)
+{
+    double lo = 0., hi = 0.;
+    switch (type) {
+    case Field::Int8:
+        lo = INT8_MIN;
+        hi = INT8_MAX;
+        break;
+    case Field::UInt8:
+        hi = UINT8_MAX;
+        break;
+    case Field::Int16:
+        lo = INT16_MIN;
+        hi = INT16_MAX;
+        break;
+    case Field::UInt16:
+        hi = UINT16_MAX;
+        break;
+    case Field::Int32:
+        lo = INT32_MIN;
+        hi = INT32_MAX;
+        break;
+    case Field::UInt32:
+        hi = UINT32_MAX;
+        break;
+    case Field::Float32:
+        break;
+    }
+    if (std::isnan(v)) {
+        return 0;
+    }
+    return static_cast<int64_t>(std::llround(std::clamp(v, lo, hi)));
+}
+
+void Encoder::put_le(std::string& out, uint64_t v, std::size_t bytes)
+{
+    for (std::size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+}
+
+void Encoder::put_float(std::string& out, double v)
+{
+    float f = static_cast<float>(v);
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    put_le(out, bits, 4);
+}
+
+void Encoder::put_varint(std::string& out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+}
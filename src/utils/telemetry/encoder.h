@@ -0,0 +1,42 @@
+#ifndef TELEMETRY_ENCODER_H
+#define TELEMETRY_ENCODER_H
+
+#include "schema.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Telemetry {
+
+class Encoder {
+public:
+    Encoder(Schema schema, unsigned int keyframe_interval = 50);
+
+    std::string encode(const std::vector<double>& values, Encoding encoding, uint32_t t_ms);
+
+    const Schema& schema() const { return _schema; }
+    unsigned int keyframe_interval() const { return _keyframe_interval; }
+
+    static constexpr uint8_t keyframe_flag = 0x01;
+
+private:
+    void encode_text(const std::vector<double>& values, std::string& out);
+    void encode_packed(const std::vector<double>& values, std::string& out);
+    void encode_delta(const std::vector<double>& values, std::string& out);
+
+    static int64_t to_integer(double v, Field::Type type);
+    static void put_le(std::string& out, uint64_t v, std::size_t bytes);
+    static void put_float(std::string& out, double v);
+    static void put_varint(std::string& out, uint64_t v);
+
+    Schema _schema;
+    unsigned int _keyframe_interval;
+    unsigned int _frames_since_keyframe;
+    Encoding _previous_encoding;
+    uint16_t _seq;
+    std::vector<int64_t> _previous;
+};
+
+}
+
+#endif // TELEMETRY_ENCODER_H
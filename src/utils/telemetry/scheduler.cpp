@@ -0,0 +1,83 @@
+#include "scheduler.h"
+#include "telemetry_stream.h"
+#include "utils/log/log.h"
+#include <algorithm>
+
+namespace Telemetry {
+
+std::atomic<bool> Scheduler::_destroyed(false);
+
+Scheduler::Scheduler()
+    : ThreadedLoop("telemetry_scheduler", 0.01)
+    , _budget_bytes_per_s("budget_bytes_per_s", BaseParam::ReadWrite, this, 64000)
+    , _max_frames_per_tick("max_frames_per_tick", BaseParam::ReadWrite, this, 16)
+{
+    _menu->set_description("Telemetry scheduler");
+    _menu->set_code("telemetry");
+    _menu->add_item("stats", "Show stream statistics", [this](std::string) { show_stats(); });
+
+    set_prio(1);
+    Budget::global().set_rate(_budget_bytes_per_s);
+    start();
+}
+
+Scheduler::~Scheduler()
+{
+    stop_and_join();
+    _destroyed = true;
+}
+
+Scheduler& Scheduler::instance()
+{
+    static Scheduler s;
+    return s;
+}
+
+void Scheduler::add_stream(Stream* stream)
+{
+    std::lock_guard<std::mutex> lock(_streams_mutex);
+    auto it = std::find_if(_streams.begin(), _streams.end(), [stream](Stream* s) { return s->priority() < stream->priority(); });
+    _streams.insert(it, stream);
+}
+
+void Scheduler::remove_stream(Stream* stream)
+{
+    std::lock_guard<std::mutex> lock(_streams_mutex);
+    _streams.erase(std::remove(_streams.begin(), _streams.end(), stream), _streams.end());
+}
+
+void Scheduler::show_stats()
+{
+    std::lock_guard<std::mutex> lock(_streams_mutex);
+    info() << "Telemetry budget: " << Budget::global().rate() << " B/s (" << Budget::global().available() << " B available)";
+    for (Stream* s : _streams) {
+        info() << s->topic() << ": " << s->sent_count() << " sent / " << s->update_count() << " updates, " << s->deferred_count() << " deferred";
+    }
+}
+
+void Scheduler::loop(double, clock::time_point time)
+{
+    if (_budget_bytes_per_s.changed()) {
+        Budget::global().set_rate(_budget_bytes_per_s);
+    }
+    int max_frames = _max_frames_per_tick;
+    int frames = 0;
+
+    std::lock_guard<std::mutex> lock(_streams_mutex);
+    for (Stream* s : _streams) {
+        if (!s->due(time)) {
+            continue;
+        }
+
+        bool critical = s->priority() == Critical;
+        if ((!critical && frames >= max_frames) || !Budget::global().try_consume(s->estimated_size(), critical)) {
+            s->defer();
+            continue;
+        }
+
+        s->publish_pending(time);
+        ++frames;
+    }
+}
+
+}
@@ -0,0 +1,50 @@
+#ifndef TELEMETRY_SCHEDULER_H
+#define TELEMETRY_SCHEDULER_H
+
+#include "budget.h"
+#include "utils/threaded_loop.h"
+#include <atomic>
+#include <vector>
+
+namespace Telemetry {
+
+class Stream;
+
+/**
+ * \brief Publishes every telemetry stream from a single low priority thread.
+ *
+ * Streams are served by decreasing priority, at most at their target rate,
+ * as long as the global byte budget and the per-tick frame budget allow it.
+ * Streams that miss their slot keep only their latest value, which
+ * downsamples them under load. Critical streams bypass both budgets.
+ * Streams outliving the scheduler at exit no longer reach it.
+ */
+class Scheduler : public ThreadedLoop {
+public:
+    static Scheduler& instance();
+
+    void add_stream(Stream* stream);
+    void remove_stream(Stream* stream);
+
+    static bool destroyed() { return _destroyed; }
+
+    void show_stats();
+
+private:
+    Scheduler();
+    ~Scheduler() override;
+
+    void loop(double dt, clock::time_point time) override;
+
+    std::vector<Stream*> _streams;
+    std::mutex _streams_mutex;
+
+    Param<int> _budget_bytes_per_s;
+    Param<int> _max_frames_per_tick;
+
+    static std::atomic<bool> _destroyed;
+};
+
+}
+
+#endif // TELEMETRY_SCHEDULER_H
@@ -0,0 +1,90 @@
+#include "schema.h"
+
+namespace Telemetry {
+
+std::size_t Field::size() const
+{
+    switch (type) {
+    case Int8:
+    case UInt8:
+        return 1;
+    case Int16:
+    case UInt16:
+        return 2;
+    case Int32:
+    case UInt32:
+    case Float32:
+        return 4;
+    }
+    return 0;
+}
+
+std::string Field::type_name() const
+{
+    switch (type) {
+    case Int8:
+        return "i8";
+    case UInt8:
+        return "u8";
+    case Int16:
+        return "i16";
+    case UInt16:
+        return "u16";
+    case Int32:
+        return "i32";
+    case UInt32:
+        return "u32";
+    case Float32:
+        return "f32";
+    }
+    return "";
+}
+
+Schema::Schema(std::vector<Field> fields)
+    : _fields(fields)
+{
+}
+
+Schema& Schema::add(std::string name, Field::Type type, TextFormat text)
+{
+    _fields.push_back({ name, type, text });
+    return *this;
+}
+
+Schema& Schema::add_array(std::string prefix, std::size_t count, Field::Type type, TextFormat text)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        add(prefix + std::to_string(i), type, text);
+    }
+    return *this;
+}
+
+std::size_t Schema::packed_size() const
+{
+    std::size_t sz = header_size;
+    for (auto& f : _fields) {
+        sz += f.size();
+    }
+    return sz;
+}
+
+std::string Schema::descriptor(unsigned int keyframe_interval) const
+{
+    std::string ret = "{\"version\":1,";
+    ret += "\"header\":[{\"name\":\"encoding\",\"type\":\"u8\"},{\"name\":\"flags\",\"type\":\"u8\"},{\"name\":\"seq\",\"type\":\"u16\"},{\"name\":\"t_ms\",\"type\":\"u32\"}],";
+    ret += "\"encodings\":{\"0\":\"text\",\"1\":\"packed\",\"2\":\"delta_zigzag_varint\"},";
+    ret += "\"keyframe_flag\":1,\"keyframe_interval\":" + std::to_string(keyframe_interval) + ",";
+    ret += "\"fields\":[";
+    for (std::size_t i = 0; i < _fields.size(); ++i) {
+        ret += (i ? ",{" : "{");
+        ret += "\"name\":\"" + _fields[i].name + "\",\"type\":\"" + _fields[i].type_name() + "\"";
+        if (!_fields[i].text.unit.empty()) {
+            ret += ",\"unit\":\"" + _fields[i].text.unit + "\"";
+        }
+        ret += "}";
+    }
+    ret += "]}";
+    return ret;
+}
+
+}
@@ -0,0 +1,71 @@
+#ifndef TELEMETRY_SCHEMA_H
+#define TELEMETRY_SCHEMA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Telemetry {
+
+enum Encoding {
+    Text = 0,
+    Packed = 1,
+    DeltaVarint = 2
+};
+
+// How a value is written by the text encoding
+struct TextFormat {
+    int precision = 6; // significant digits, or decimals when fixed
+    bool fixed = false;
+    std::string unit; // appended to the value, e.g. "°C"
+};
+
+struct Field {
+    enum Type {
+        Int8,
+        UInt8,
+        Int16,
+        UInt16,
+        Int32,
+        UInt32,
+        Float32
+    };
+
+    std::string name;
+    Type type;
+    TextFormat text;
+
+    std::size_t size() const;
+    bool is_integer() const { return type != Float32; }
+    std::string type_name() const;
+};
+
+/**
+ * \brief Layout of the numeric frames published by a telemetry stream.
+ *
+ * Binary frames start with a fixed little-endian header
+ * (u8 encoding, u8 flags, u16 sequence, u32 timestamp in ms), followed by
+ * the fields in declaration order. The JSON descriptor published alongside
+ * the stream lets dashboards decode them.
+ */
+class Schema {
+public:
+    Schema() = default;
+    Schema(std::vector<Field> fields);
+
+    Schema& add(std::string name, Field::Type type, TextFormat text = TextFormat());
+    Schema& add_array(std::string prefix, std::size_t count, Field::Type type, TextFormat text = TextFormat());
+
+    const std::vector<Field>& fields() const { return _fields; }
+    std::size_t packed_size() const;
+    std::string descriptor(unsigned int keyframe_interval) const;
+
+    static constexpr std::size_t header_size = 8;
+
+private:
+    std::vector<Field> _fields;
+};
+
+}
+
+#endif // TELEMETRY_SCHEMA_H
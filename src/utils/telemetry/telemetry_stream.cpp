@@ -0,0 +1,85 @@
+#include "telemetry_stream.h"
+#include "scheduler.h"
+
+namespace Telemetry {
+
+Stream::Stream(std::string name, NamedObject* parent, Schema schema, double rate_hz, Priority priority, std::string topic, Encoding default_encoding)
+    : NamedObject(name, parent)
+    , _topic(topic.empty() ? full_name() : topic)
+    , _priority(priority)
+    , _encoder(schema)
+    , _t0(clock::now())
+    , _has_pending(false)
+    , _next_due(_t0)
+    , _period(clock::duration::zero())
+    , _last_size(schema.packed_size())
+    , _updates(0)
+    , _sent(0)
+    , _deferred(0)
+    , _encoding("encoding", BaseParam::ReadWrite, this, default_encoding)
+    , _rate_hz("rate_hz", BaseParam::ReadWrite, this, rate_hz)
+    , _current_encoding(default_encoding)
+{
+    _mqtt.publish(_topic + "/schema", schema.descriptor(_encoder.keyframe_interval()), Mosquittopp::Client::QoS1, true);
+    Scheduler::instance().add_stream(this);
+}
+
+Stream::~Stream()
+{
+    // Static owners may be destroyed after the scheduler
+    if (!Scheduler::destroyed()) {
+        Scheduler::instance().remove_stream(this);
+    }
+}
+
+void Stream::update(const std::vector<double>& values)
+{
+    std::lock_guard<std::mutex> lock(_pending_mutex);
+    _pending = values;
+    _has_pending = true;
+    ++_updates;
+}
+
+bool Stream::due(clock::time_point now)
+{
+    if (_rate_hz.changed()) {
+        double rate = _rate_hz;
+        _period = rate > 0. ? std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1. / rate)) : clock::duration::max();
+    }
+
+    if (_period == clock::duration::max() || now < _next_due) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_pending_mutex);
+    return _has_pending;
+}
+
+void Stream::publish_pending(clock::time_point now)
+{
+    std::vector<double> values;
+    {
+        std::lock_guard<std::mutex> lock(_pending_mutex);
+        values.swap(_pending);
+        _has_pending = false;
+    }
+
+    if (_encoding.changed()) {
+        int encoding = _encoding;
+        _current_encoding = (encoding >= Text && encoding <= DeltaVarint) ? static_cast<Encoding>(encoding) : Packed;
+    }
+
+    uint32_t t_ms = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - _t0).count());
+    std::string payload = _encoder.encode(values, _current_encoding, t_ms);
+    _last_size = payload.size();
+    _mqtt.publish(_topic, payload);
+
+    // Late streams restart from now rather than bursting to catch up
+    _next_due += _period;
+    if (_next_due <= now) {
+        _next_due = now + _period;
+    }
+    ++_sent;
+}
+
+}
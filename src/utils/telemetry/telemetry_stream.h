@@ -0,0 +1,71 @@
+#ifndef TELEMETRY_STREAM_H
+#define TELEMETRY_STREAM_H
+
+#include "budget.h"
+#include "encoder.h"
+#include "utils/interfaces/mqtt_user.h"
+#include "utils/named_object.h"
+#include "utils/param.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace Telemetry {
+
+/**
+ * \brief Numeric stream published on MQTT by the telemetry Scheduler.
+ *
+ * Producers only store their latest values; the scheduler publishes them at
+ * most at the "rate_hz" parameter. The encoding is selected at runtime
+ * through the "encoding" parameter (0: text, 1: packed, 2: delta/varint).
+ * Streams start as text, so consumers of the existing topics keep working;
+ * new topics opt in to a binary encoding.
+ * The schema descriptor is retained on <topic>/schema.
+ */
+class Stream : public NamedObject, public MqttUser {
+public:
+    using clock = std::chrono::steady_clock;
+
+    Stream(std::string name, NamedObject* parent, Schema schema, double rate_hz, Priority priority = Normal, std::string topic = std::string(), Encoding default_encoding = Text);
+    ~Stream() override;
+
+    void update(const std::vector<double>& values);
+
+    std::string topic() { return _topic; }
+    Priority priority() const { return _priority; }
+
+    bool due(clock::time_point now);
+    std::size_t estimated_size() { return _last_size; }
+    void publish_pending(clock::time_point now);
+    void defer() { ++_deferred; }
+
+    std::size_t update_count() { return _updates; }
+    std::size_t sent_count() { return _sent; }
+    std::size_t deferred_count() { return _deferred; }
+
+private:
+    std::string _topic;
+    Priority _priority;
+    Encoder _encoder;
+    clock::time_point _t0;
+
+    std::vector<double> _pending;
+    bool _has_pending;
+    std::mutex _pending_mutex;
+
+    clock::time_point _next_due;
+    clock::duration _period;
+    std::size_t _last_size;
+
+    std::atomic<std::size_t> _updates;
+    std::atomic<std::size_t> _sent;
+    std::atomic<std::size_t> _deferred;
+
+    Param<int> _encoding;
+    Param<double> _rate_hz;
+    Encoding _current_encoding;
+};
+
+}
+
+#endif // TELEMETRY_STREAM_H
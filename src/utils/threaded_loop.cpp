@@ -1,20 +1,45 @@
 #include "threaded_loop.h"
+#include "utils/param_block.h"
+#include "utils/trace/trace.h"
+#include <algorithm>
 #include <cmath>
+#include <sched.h>
+
+std::vector<ThreadedLoop*> ThreadedLoop::_instances;
+std::mutex ThreadedLoop::_instances_mutex;
 
 ThreadedLoop::ThreadedLoop(std::string name, double period_s)
     : NamedObject(name)
     , MenuUser("", "", [this] { stop(); })
+    , _loop_condition(false)
     , _period_s("period_ms", BaseParam::ReadWrite, this, period_s)
     , _pref_cpu("pref_cpu", BaseParam::ReadWrite, this, DEFAULT_CPU_CORE)
     , _prio("prio", BaseParam::ReadWrite, this, DEFAULT_THREAD_PRIO)
+    , _heartbeat(nullptr)
+    , _cpu(-1)
 {
     _menu->add_item("start", "Start loop", [this](std::string) { start(); });
     _menu->add_item("stop", "Stop loop", [this](std::string) { stop_and_join(); });
+
+    std::lock_guard lock(_instances_mutex);
+    _instances.push_back(this);
 }
 
 ThreadedLoop::~ThreadedLoop()
 {
     stop_and_join();
+    unsupervise();
+
+    std::lock_guard lock(_instances_mutex);
+    _instances.erase(std::remove(_instances.begin(), _instances.end(), this), _instances.end());
+}
+
+void ThreadedLoop::for_each(const std::function<void(ThreadedLoop&)>& f)
+{
+    std::lock_guard lock(_instances_mutex);
+    for (ThreadedLoop* loop : _instances) {
+        f(*loop);
+    }
 }
 
 void ThreadedLoop::set_period(double seconds)
@@ -37,8 +62,11 @@ void ThreadedLoop::set_prio(int prio)
 
 void ThreadedLoop::start()
 {
-    if (!_thread.joinable())
+    if (!_thread.joinable()) {
+        // Set before the thread exists, so a stop() issued meanwhile is not lost
+        _loop_condition = true;
         _thread = std::thread(&ThreadedLoop::run, this);
+    }
 }
 
 void ThreadedLoop::stop()
@@ -54,6 +82,45 @@ void ThreadedLoop::stop_and_join()
     }
 }
 
+void ThreadedLoop::supervise(std::chrono::milliseconds deadline, Supervisor::Policy policy, bool critical, std::function<void()> restart)
+{
+    if (_heartbeat) {
+        Supervisor::instance().remove(_heartbeat);
+    }
+    _heartbeat = Supervisor::instance().add(_name, deadline, policy, critical, restart);
+}
+
+void ThreadedLoop::unsupervise()
+{
+    if (_heartbeat) {
+        Supervisor::instance().remove(_heartbeat);
+        _heartbeat = nullptr;
+    }
+}
+
+void ThreadedLoop::add_param_block(BaseParamBlock* block)
+{
+    std::lock_guard<std::mutex> lock(_param_blocks_mutex);
+    _param_blocks.push_back(block);
+}
+
+void ThreadedLoop::remove_param_block(BaseParamBlock* block)
+{
+    std::lock_guard<std::mutex> lock(_param_blocks_mutex);
+    _param_blocks.erase(std::remove(_param_blocks.begin(), _param_blocks.end(), block), _param_blocks.end());
+}
+
+void ThreadedLoop::apply_param_blocks()
+{
+    std::unique_lock<std::mutex> lock(_param_blocks_mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+    for (BaseParamBlock* block : _param_blocks) {
+        block->apply();
+    }
+}
+
 bool ThreadedLoop::setup()
 {
     return true;
@@ -78,32 +145,68 @@ void ThreadedLoop::_set_preferred_cpu_internal(int cpu)
     pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
 }
 
-void ThreadedLoop::run()
+bool ThreadedLoop::begin(clock::time_point start)
 {
-    pthread_setname_np(pthread_self(), _name.c_str());
+    if (!_loop_condition) {
+        return false;
+    }
+    _prev_period = start;
 
-    std::chrono::microseconds dt;
+    apply_param_blocks();
+    if (!setup()) {
+        _loop_condition = false;
+        return false;
+    }
+    if (_heartbeat) {
+        _heartbeat->beat();
+    }
+    return true;
+}
 
-    _loop_condition = true;
+void ThreadedLoop::step(clock::time_point scheduled, clock::time_point now)
+{
+    std::chrono::microseconds dt = std::chrono::duration_cast<std::chrono::microseconds>(scheduled - _prev_period);
+    _prev_period = scheduled;
 
-    if (!setup()) {
+    {
+        TRACE_SCOPE("ThreadedLoop::loop");
+        apply_param_blocks();
+        loop(dt.count() / 1000000., now);
+    }
+    if (_heartbeat) {
+        _heartbeat->beat();
+    }
+}
+
+void ThreadedLoop::end()
+{
+    if (_heartbeat) {
+        _heartbeat->disarm();
+    }
+    cleanup();
+}
+
+void ThreadedLoop::run()
+{
+    pthread_setname_np(pthread_self(), _name.substr(0, 15).c_str());
+
+    if (!begin(clock::now())) {
         return;
     }
 
     _set_preferred_cpu_internal(_pref_cpu);
     _set_prio_internal(_prio);
 
-    clock::time_point prev_period, next_period;
-    prev_period = std::chrono::steady_clock::now();
-    next_period = prev_period;
+    clock::time_point next_period = clock::now();
+    _prev_period = next_period;
 
     while (true) {
         next_period += std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(_period_s.to()));
         std::this_thread::sleep_until(next_period);
+        _wake_latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - next_period).count());
+        _cpu = sched_getcpu();
 
-        dt = std::chrono::duration_cast<std::chrono::microseconds>(next_period - prev_period);
-
-        loop(dt.count() / 1000000., clock::now());
+        step(next_period, clock::now());
 
         if (_pref_cpu.changed()) {
             _set_preferred_cpu_internal(_pref_cpu);
@@ -116,5 +219,5 @@ void ThreadedLoop::run()
         if (!_loop_condition)
             break;
     }
-    cleanup();
+    end();
 }
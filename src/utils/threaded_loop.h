@@ -2,16 +2,24 @@
 #define THREADED_LOOP_H
 
 #include "utils/interfaces/menu_user.h"
+#include "utils/latency_stats.h"
 #include "utils/named_object.h"
 #include "utils/param.h"
+#include "utils/supervisor.h"
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
+
+class BaseParamBlock;
 
 class ThreadedLoop : public NamedObject, public MenuUser {
 public:
+    using clock = std::chrono::steady_clock;
+
     ThreadedLoop(std::string name, double period_s = 1);
     virtual ~ThreadedLoop();
 
@@ -19,14 +27,39 @@ public:
     void set_preferred_cpu(int cpu);
     void set_prio(int prio);
     double period() { return _period_s; }
+    int preferred_cpu() { return _pref_cpu; }
+    // Core the loop thread last woke up on, -1 before the first tick
+    int current_cpu() { return _cpu; }
+
+    // Delay between the scheduled start of a tick and the actual wake-up
+    LatencyStats& wake_latency() { return _wake_latency; }
+    // Loops are visited under a lock, they cannot be destroyed meanwhile
+    static void for_each(const std::function<void(ThreadedLoop&)>& f);
 
     void start();
     void stop();
     void stop_and_join();
+    bool running() { return _loop_condition; }
 
-protected:
-    using clock = std::chrono::steady_clock;
+    // The loop thread runs begin(), step() every period and end(). Sim::Executor
+    // calls them instead, from its own thread and with simulated time.
+    // begin() fails when the loop was stopped since start() or arm().
+    void arm() { _loop_condition = true; }
+    bool begin(clock::time_point start);
+    void step(clock::time_point scheduled, clock::time_point now);
+    void end();
 
+    // Blocks are applied at the start of every tick, before loop() is called
+    void add_param_block(BaseParamBlock* block);
+    void remove_param_block(BaseParamBlock* block);
+
+    // The loop beats after setup() and after every loop(), and is idle while stopped.
+    // A restart callback using members of a derived class must be unsupervised
+    // in that class' destructor, unsupervise() waits for a restart in progress.
+    void supervise(std::chrono::milliseconds deadline, Supervisor::Policy policy = Supervisor::Log, bool critical = false, std::function<void()> restart = nullptr);
+    void unsupervise();
+
+protected:
     virtual bool setup();
     virtual void loop(double dt, clock::time_point time) = 0;
     virtual void cleanup();
@@ -40,10 +73,22 @@ protected:
 
 private:
     void run();
+    void apply_param_blocks();
+
+    std::vector<BaseParamBlock*> _param_blocks;
+    std::mutex _param_blocks_mutex;
 
     Param<double> _period_s;
     Param<int> _pref_cpu;
     Param<int> _prio;
+
+    Supervisor::Heartbeat* _heartbeat;
+    clock::time_point _prev_period;
+    LatencyStats _wake_latency;
+    std::atomic<int> _cpu;
+
+    static std::vector<ThreadedLoop*> _instances;
+    static std::mutex _instances_mutex;
 };
 
 #endif // THREADED_LOOP_H
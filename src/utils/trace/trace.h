@@ -0,0 +1,65 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <time.h>
+
+/**
+ * \brief Scoped spans recorded into per-thread buffers.
+ *
+ *     void RoboClaw::send() { TRACE_SCOPE("RoboClaw::send"); ... }
+ *
+ * Names must be string literals: only the pointer is stored. When tracing
+ * is off a span costs one relaxed load and a branch. Tracing is turned on,
+ * off and dumped from the Tracer menu.
+ */
+namespace Trace {
+
+inline std::atomic<bool> enabled_flag(false);
+
+inline bool enabled()
+{
+    return enabled_flag.load(std::memory_order_relaxed);
+}
+
+inline uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Appends a complete span to the buffer of the calling thread
+void record(const char* name, uint64_t start_ns, uint64_t end_ns);
+
+class Scope {
+public:
+    explicit Scope(const char* name)
+        : _name(name)
+        , _start(enabled() ? now_ns() : 0)
+    {
+    }
+
+    ~Scope()
+    {
+        if (_start) {
+            record(_name, _start, now_ns());
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* _name;
+    uint64_t _start;
+};
+
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(_trace_scope_, __LINE__)(name)
+
+#endif // TRACE_H
@@ -0,0 +1,179 @@
+#include "tracer.h"
+#include "utils/log/log.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Trace {
+
+thread_local Tracer::ThreadSlot Tracer::_thread_slot;
+
+void record(const char* name, uint64_t start_ns, uint64_t end_ns)
+{
+    Tracer::ThreadBuffer*& buffer = Tracer::_thread_slot.buffer;
+    if (!buffer) {
+        buffer = Tracer::instance().register_thread();
+    }
+    std::size_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->claimed.store(head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    buffer->events[head % Tracer::ThreadBuffer::size] = { name, start_ns, end_ns };
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+Tracer::ThreadSlot::~ThreadSlot()
+{
+    if (buffer) {
+        Tracer::instance().release_thread(buffer);
+    }
+}
+
+Tracer::Tracer()
+    : NamedObject("trace")
+    , MenuUser("trace", "Tracing")
+{
+    _menu->add_item("on", "Start tracing", [this](std::string) { start(); });
+    _menu->add_item("off", "Stop tracing", [this](std::string) { stop(); });
+    _menu->add_item("dump", "Dump trace (+ filename)", [this](std::string args) {
+        if (args.empty()) {
+            int cnt = 0;
+            do {
+                ++cnt;
+                args = "trace_" + std::to_string(cnt) + ".json";
+            } while (std::filesystem::exists(args));
+        }
+        dump(args);
+    });
+}
+
+Tracer::~Tracer()
+{
+    stop();
+}
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::ThreadBuffer* Tracer::register_thread()
+{
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    char name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+
+    std::lock_guard lock(_buffers_mutex);
+    auto it = std::find_if(_buffers.begin(), _buffers.end(), [](auto& buffer) { return !buffer->in_use; });
+    ThreadBuffer* buffer;
+    if (it != _buffers.end()) {
+        // Spans of the previous thread are not attributed to this one
+        buffer = it->get();
+        buffer->first = buffer->head.load(std::memory_order_relaxed);
+    } else {
+        _buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = _buffers.back().get();
+        buffer->claimed = 0;
+        buffer->head = 0;
+        buffer->first = 0;
+    }
+    buffer->tid = tid;
+    buffer->thread_name = name;
+    buffer->in_use = true;
+    return buffer;
+}
+
+void Tracer::release_thread(ThreadBuffer* buffer)
+{
+    std::lock_guard lock(_buffers_mutex);
+    buffer->in_use = false;
+}
+
+void Tracer::start()
+{
+    {
+        std::lock_guard lock(_buffers_mutex);
+        for (auto& buffer : _buffers) {
+            buffer->first = buffer->head.load(std::memory_order_acquire);
+        }
+    }
+    enabled_flag = true;
+    info() << "Tracing started";
+}
+
+void Tracer::stop()
+{
+    enabled_flag = false;
+}
+
+static void write_escaped(std::ostream& out, const std::string& s)
+{
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+}
+
+bool Tracer::dump(std::string filename)
+{
+    std::ofstream out(filename);
+    if (!out.good()) {
+        critical() << "Failed to open " << filename;
+        return false;
+    }
+
+    pid_t pid = getpid();
+    std::size_t count = 0;
+    bool first_entry = true;
+    auto separator = [&out, &first_entry] {
+        out << (first_entry ? "\n" : ",\n");
+        first_entry = false;
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    {
+        std::lock_guard lock(_buffers_mutex);
+        std::vector<Event> events;
+        events.reserve(ThreadBuffer::size);
+        for (auto& buffer : _buffers) {
+            separator();
+            out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << buffer->tid << ",\"args\":{\"name\":\"";
+            write_escaped(out, buffer->thread_name);
+            out << "\"}}";
+
+            // Copy first, then keep only the events no writer has reclaimed
+            // meanwhile: claiming index n overwrites n - size
+            std::size_t head = buffer->head.load(std::memory_order_acquire);
+            std::size_t begin = std::max(head > ThreadBuffer::size ? head - ThreadBuffer::size : 0, buffer->first);
+            events.clear();
+            for (std::size_t i = begin; i < head; ++i) {
+                events.push_back(buffer->events[i % ThreadBuffer::size]);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::size_t claimed = buffer->claimed.load(std::memory_order_relaxed);
+            std::size_t valid = claimed > ThreadBuffer::size ? claimed - ThreadBuffer::size : 0;
+            std::size_t skip = valid > begin ? std::min(valid - begin, events.size()) : 0;
+
+            for (auto e = events.begin() + static_cast<std::ptrdiff_t>(skip); e != events.end(); ++e) {
+                separator();
+                out << "{\"ph\":\"X\",\"name\":\"";
+                write_escaped(out, e->name);
+                out << "\",\"pid\":" << pid << ",\"tid\":" << buffer->tid
+                    << ",\"ts\":" << e->start_ns / 1000 << '.' << e->start_ns % 1000 / 100
+                    << ",\"dur\":" << (e->end_ns - e->start_ns) / 1000 << '.' << (e->end_ns - e->start_ns) % 1000 / 100 << '}';
+                ++count;
+            }
+        }
+    }
+    out << "\n]}\n";
+
+    info() << "Wrote " << count << " spans to " << filename;
+    return true;
+}
+
+}
@@ -0,0 +1,75 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include "trace.h"
+#include "utils/interfaces/menu_user.h"
+#include "utils/named_object.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace Trace {
+
+/**
+ * \brief Owns the trace buffers and exports them as Chrome trace JSON.
+ *
+ * Each thread gets a fixed size buffer on its first span; only that thread
+ * writes to it and the oldest spans are overwritten. The buffer of an exited
+ * thread keeps its spans until a new thread reuses it. The JSON file opens in
+ * chrome://tracing and in the Perfetto UI.
+ */
+class Tracer : public NamedObject, public MenuUser {
+public:
+    static Tracer& instance();
+
+    void start();
+    void stop();
+    bool dump(std::string filename);
+
+private:
+    friend void record(const char* name, uint64_t start_ns, uint64_t end_ns);
+
+    struct Event {
+        const char* name;
+        uint64_t start_ns;
+        uint64_t end_ns;
+    };
+
+    // Seqlock over the ring: an event is claimed before it is written and
+    // published after, so a reader drops whatever a writer may have overwritten
+    struct ThreadBuffer {
+        static const std::size_t size = 4096;
+
+        pid_t tid;
+        std::string thread_name;
+        bool in_use;
+        std::atomic<std::size_t> claimed;
+        std::atomic<std::size_t> head;
+        std::size_t first; // first event of the current session
+        std::array<Event, size> events;
+    };
+
+    // Hands the buffer back when its thread exits
+    struct ThreadSlot {
+        ThreadBuffer* buffer = nullptr;
+        ~ThreadSlot();
+    };
+
+    Tracer();
+    ~Tracer() override;
+
+    ThreadBuffer* register_thread();
+    void release_thread(ThreadBuffer* buffer);
+
+    static thread_local ThreadSlot _thread_slot;
+
+    std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+    std::mutex _buffers_mutex;
+};
+
+}
+
+#endif // TRACER_H
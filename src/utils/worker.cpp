@@ -6,7 +6,7 @@ Worker::Worker(std::string thread_name, RunType rt)
     , _worker_runtype(rt)
 {
     auto f = [this, thread_name] {
-        pthread_setname_np(pthread_self(), thread_name.c_str());
+        pthread_setname_np(pthread_self(), thread_name.substr(0, 15).c_str());
 
         std::unique_lock lock(_worker_mutex);
 